@@ -37,6 +37,13 @@
 #include "ObjectMgr.h"
 #include "ObjectGuid.h"
 #include "SpellMgr.h"
+#include "GridNotifiers.h"
+#include "CellImpl.h"
+#include "World.h"
+#include "MovementCoalescer.h"
+#include "OpcodeThrottle.h"
+
+#include <ace/OS_NS_sys_time.h>
 
 /**********************************************************************
      CommandTable : debugCommandTable
@@ -382,6 +389,206 @@ bool ChatHandler::HandleDebugUpdateWorldStateCommand(char* args)
     return true;
 }
 
+// range check over the linked grid containers, the way the grid notifiers walk a cell
+struct CellBenchVisitor
+{
+    CellBenchVisitor(float x, float y, float radius) : i_x(x), i_y(y), i_radiusSq(radius * radius), i_found(0) {}
+
+    template<class T> void Visit(GridRefManager<T>& m)
+    {
+        for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+        {
+            WorldObject* obj = itr->getSource();
+            float dx = obj->GetPositionX() - i_x;
+            float dy = obj->GetPositionY() - i_y;
+            if (dx * dx + dy * dy <= i_radiusSq)
+            {
+                ++i_found;
+            }
+        }
+    }
+
+    void Visit(CameraMapType&) {}
+
+    float i_x;
+    float i_y;
+    float i_radiusSq;
+    uint32 i_found;
+};
+
+/// .debug cellbench [#radius [#iterations]] - compares range checks over the grid lists and the cell object index of the current cell
+bool ChatHandler::HandleDebugCellBenchCommand(char* args)
+{
+    float radius = 20.0f;
+    uint32 iterations = 10000;
+
+    if (*args && !ExtractFloat(&args, radius))
+    {
+        return false;
+    }
+
+    if (*args && !ExtractUInt32(&args, iterations))
+    {
+        return false;
+    }
+
+    if (radius <= 0.0f || !iterations)
+    {
+        return false;
+    }
+
+    Player* player = m_session->GetPlayer();
+    Cell cell(MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY()));
+    GridType* cellObjects = player->GetMap()->GetLoadedCell(cell);
+    if (!cellObjects)
+    {
+        SendSysMessage("The grid of the current cell is not loaded.");
+        SetSentErrorMessage(true);
+        return false;
+    }
+
+    float x = player->GetPositionX();
+    float y = player->GetPositionY();
+    float z = player->GetPositionZ();
+
+    // linked lists, every object is touched to read its position
+    uint32 listFound = 0;
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < iterations; ++i)
+    {
+        CellBenchVisitor benchVisitor(x, y, radius);
+        TypeContainerVisitor<CellBenchVisitor, GridTypeMapContainer> gridVisitor(benchVisitor);
+        TypeContainerVisitor<CellBenchVisitor, WorldTypeMapContainer> worldVisitor(benchVisitor);
+        cellObjects->Visit(gridVisitor);
+        cellObjects->Visit(worldVisitor);
+        listFound = benchVisitor.i_found;
+    }
+    ACE_UINT64 listTime;
+    (ACE_OS::gettimeofday() - start).to_usec(listTime);
+
+    // structure-of-arrays prefilter, only the objects in range are touched
+    CellObjectIndex const& index = cellObjects->GetIndex();
+    std::vector<WorldObject*> found;
+    found.reserve(index.Size());
+    start = ACE_OS::gettimeofday();
+    for (uint32 i = 0; i < iterations; ++i)
+    {
+        found.clear();
+        index.FindInRange(x, y, z, radius, TYPEMASK_WORLDOBJECT, found);
+    }
+    ACE_UINT64 indexTime;
+    (ACE_OS::gettimeofday() - start).to_usec(indexTime);
+
+    PSendSysMessage("Cell [%u,%u]: %u objects, %u within %.1f yards, %u iterations", cell.CellX(), cell.CellY(),
+                    uint32(index.Size()), listFound, radius, iterations);
+    PSendSysMessage("Grid lists:  %.3f us per cell", double(listTime) / iterations);
+    PSendSysMessage("Cell index:  %.3f us per cell (%u found)", double(indexTime) / iterations, uint32(found.size()));
+    return true;
+}
+
+/// .debug movecoalesce [reset] - shows how many packets and bytes the movement coalescing saved since the last reset
+bool ChatHandler::HandleDebugMoveCoalesceCommand(char* args)
+{
+    MovementCoalescer::Stats& stats = MovementCoalescer::GetStats();
+
+    if (*args)
+    {
+        if (strncmp(args, "reset", strlen(args)) != 0)
+        {
+            return false;
+        }
+
+        stats.Reset();
+        SendSysMessage("Movement coalescing counters reset.");
+        return true;
+    }
+
+    // every packet on its own carries a 4 byte server header
+    uint64 moves = stats.moves.value();
+    uint64 packets = stats.packets.value();
+    uint64 rawBytes = stats.rawBytes.value() + 4 * moves;
+    uint64 sentBytes = stats.sentBytes.value() + 4 * packets;
+
+    double seconds = std::max(getMSTimeDiff(stats.since, getMSTime()), uint32(1)) / 1000.0;
+    uint32 clients = std::max(sWorld.GetActiveSessionCount(), uint32(1));
+
+    PSendSysMessage("Movement coalescing window: %u ms, %u clients, %.1f s measured",
+                    sWorld.getConfig(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW), clients, seconds);
+    PSendSysMessage("Moves:   " UI64FMTD " packets, " UI64FMTD " bytes, %.1f packets/s and %.1f bytes/s per client",
+                    moves, rawBytes, moves / seconds / clients, rawBytes / seconds / clients);
+    PSendSysMessage("Sent:    " UI64FMTD " packets, " UI64FMTD " bytes, %.1f packets/s and %.1f bytes/s per client",
+                    packets, sentBytes, packets / seconds / clients, sentBytes / seconds / clients);
+    return true;
+}
+
+bool ChatHandler::HandleDebugThrottleCommand(char* args)
+{
+    if (*args)
+    {
+        if (strncmp(args, "reset", strlen(args)) != 0)
+        {
+            return false;
+        }
+
+        OpcodeThrottle::ResetCounters();
+        SendSysMessage("Opcode throttle counters reset.");
+        return true;
+    }
+
+    PSendSysMessage("Opcode throttle %s, packets over the rate limits:",
+                    sWorld.getConfig(CONFIG_BOOL_OPCODE_THROTTLE) ? "enabled" : "disabled");
+
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        OpcodeHandler const& handler = opcodeTable[opcode];
+        if (!handler.rateLimit)
+        {
+            continue;
+        }
+
+        if (handler.rateAction == THROTTLE_DROP)
+        {
+            PSendSysMessage("%s: %u/s, burst %u, %u dropped", handler.name, handler.rateLimit, handler.rateBurst,
+                            OpcodeThrottle::GetOverLimit(opcode));
+        }
+        else
+        {
+            PSendSysMessage("%s: %u/s, burst %u, %u handled over the limit, %u kicks", handler.name, handler.rateLimit,
+                            handler.rateBurst, OpcodeThrottle::GetOverLimit(opcode), OpcodeThrottle::GetKicks(opcode));
+        }
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugByteBufferCommand(char* args)
+{
+    if (*args)
+    {
+        if (strncmp(args, "reset", strlen(args)) != 0)
+        {
+            return false;
+        }
+
+        ByteBufferPool::ResetStats();
+        SendSysMessage("Packet storage counters reset.");
+        return true;
+    }
+
+    ByteBufferPool::Stats stats = ByteBufferPool::GetStats();
+
+    double seconds = std::max(getMSTimeDiff(stats.since, getMSTime()), uint32(1)) / 1000.0;
+    double ticks = double(std::max(stats.ticks, uint64(1)));
+    double pooled = stats.allocations ? 100.0 * (stats.allocations - std::min(stats.mallocs, stats.allocations)) / stats.allocations : 0.0;
+
+    PSendSysMessage("Packet storage over %.1f s, " UI64FMTD " world ticks", seconds, stats.ticks);
+    PSendSysMessage("Requests: " UI64FMTD ", %.1f per tick, %.1f%% served from the pools",
+                    stats.allocations, stats.allocations / ticks, pooled);
+    PSendSysMessage("Mallocs:  " UI64FMTD ", %.1f per tick, %.1f/s", stats.mallocs, stats.mallocs / ticks, stats.mallocs / seconds);
+    PSendSysMessage("Frees:    " UI64FMTD ", %.1f per tick, %.1f/s", stats.frees, stats.frees / ticks, stats.frees / seconds);
+    return true;
+}
+
 bool ChatHandler::HandleDebugPlayCinematicCommand(char* args)
 {
     // USAGE: .debug play cinematic #cinematicid
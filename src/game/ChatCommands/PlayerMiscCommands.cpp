@@ -72,6 +72,7 @@ static bool HandleResetStatsOrLevelHelper(Player* player)
     }
 
     player->SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, DEFAULT_WORLD_OBJECT_SIZE);
+    player->UpdateCellIndexBoundingRadius();
     player->SetFloatValue(UNIT_FIELD_COMBATREACH, 1.5f);
 
     player->setFactionForRace(player->getRace());
@@ -29,6 +29,9 @@
 #include "GitRevision.h"
 #include "SystemConfig.h"
 #include "UpdateTime.h"
+#include "TickProfiler.h"
+#include "OpcodeProfiler.h"
+#include "PacketCapture.h"
 #include "revision_data.h"
 
  /**********************************************************************
@@ -77,6 +80,181 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
     return true;
 }
 
+/// Display the tick profiler histograms of World::Update and the slowest maps, or of all instances of one map
+bool ChatHandler::HandleServerPerfCommand(char* args)
+{
+    if (!sTickProfiler.IsEnabled())
+    {
+        SendSysMessage("Tick profiler is disabled (PerfProfiler.Enable)."); // ToDo: move to language string
+        return true;
+    }
+
+    uint32 mapId;
+    bool singleMap = *args != '\0';
+    if (singleMap && !ExtractUInt32(&args, mapId))
+    {
+        return false;
+    }
+
+    if (!singleMap)
+    {
+        std::vector<PerfHistogram> phases;
+        sTickProfiler.GetWorldReport(phases);
+
+        SendSysMessage("World update (us): phase count p50 p95 p99 max");
+        for (uint32 i = 0; i < phases.size(); ++i)
+        {
+            PSendSysMessage("  %s %u %u %u %u %u", TickProfiler::GetWorldPhaseName(i), phases[i].GetCount(),
+                            phases[i].GetPercentile(50), phases[i].GetPercentile(95), phases[i].GetPercentile(99), phases[i].GetMax());
+        }
+    }
+
+    std::vector<TickProfiler::MapReport> reports;
+    sTickProfiler.GetMapReports(reports, singleMap ? int32(mapId) : -1);
+
+    if (reports.empty())
+    {
+        SendSysMessage("No map update was profiled yet.");
+        return true;
+    }
+
+    // slowest maps first, by p95 of the whole update
+    std::vector<std::pair<uint32, size_t> > order;
+    for (size_t i = 0; i < reports.size(); ++i)
+    {
+        order.push_back(std::make_pair(reports[i].phases[MAP_PERF_TOTAL].GetPercentile(95), i));
+    }
+    std::sort(order.rbegin(), order.rend());
+
+    // without a map id only the summary of the slowest maps, with one every phase of all its instances
+    size_t shown = singleMap ? order.size() : std::min(order.size(), size_t(5));
+    for (size_t i = 0; i < shown; ++i)
+    {
+        TickProfiler::MapReport const& report = reports[order[i].second];
+        PSendSysMessage("Map %u (%s) instance %u (us): phase count p50 p95 p99 max", report.mapId, report.name.c_str(), report.instanceId);
+
+        for (uint32 phase = 0; phase < report.phases.size(); ++phase)
+        {
+            PerfHistogram const& histogram = report.phases[phase];
+            if (!histogram.GetCount() || (!singleMap && phase != MAP_PERF_TOTAL && phase != MAP_PERF_REGION))
+            {
+                continue;
+            }
+
+            PSendSysMessage("  %s %u %u %u %u %u", TickProfiler::GetMapPhaseName(phase), histogram.GetCount(),
+                            histogram.GetPercentile(50), histogram.GetPercentile(95), histogram.GetPercentile(99), histogram.GetMax());
+        }
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerOpcodesCommand(char* args)
+{
+    if (*args)
+    {
+        if (strncmp(args, "reset", strlen(args)) != 0)
+        {
+            return false;
+        }
+
+        sOpcodeProfiler.Reset();
+        SendSysMessage("Opcode statistics reset.");
+        return true;
+    }
+
+    uint32 seconds = sOpcodeProfiler.GetSeconds();
+
+    // received opcodes by the handler time they cost in total
+    std::vector<OpcodeProfiler::InboundReport> inbound;
+    sOpcodeProfiler.GetInboundReport(inbound);
+
+    std::vector<std::pair<uint64, size_t> > order;
+    for (size_t i = 0; i < inbound.size(); ++i)
+    {
+        order.push_back(std::make_pair(inbound[i].usec, i));
+    }
+    std::sort(order.rbegin(), order.rend());
+
+    PSendSysMessage("Received over %u s (us): opcode place calls/s bytes/s total p50 p95 p99 max", seconds);
+    for (size_t i = 0; i < std::min(order.size(), size_t(15)); ++i)
+    {
+        OpcodeProfiler::InboundReport const& entry = inbound[order[i].second];
+        PSendSysMessage("  %s %s %.1f %.1f " UI64FMTD " %u %u %u %u", LookupOpcodeName(entry.opcode),
+                        OpcodeProfiler::GetPlaceName(entry.place), double(entry.calls) / seconds, double(entry.bytes) / seconds,
+                        entry.usec, entry.time.GetPercentile(50), entry.time.GetPercentile(95), entry.time.GetPercentile(99),
+                        entry.time.GetMax());
+    }
+
+    // sent opcodes by volume
+    std::vector<OpcodeProfiler::OutboundReport> outbound;
+    sOpcodeProfiler.GetOutboundReport(outbound);
+
+    order.clear();
+    for (size_t i = 0; i < outbound.size(); ++i)
+    {
+        order.push_back(std::make_pair(outbound[i].bytes, i));
+    }
+    std::sort(order.rbegin(), order.rend());
+
+    PSendSysMessage("Sent over %u s: opcode packets/s bytes/s", seconds);
+    for (size_t i = 0; i < std::min(order.size(), size_t(10)); ++i)
+    {
+        OpcodeProfiler::OutboundReport const& entry = outbound[order[i].second];
+        PSendSysMessage("  %s %.1f %.1f", LookupOpcodeName(entry.opcode), double(entry.packets) / seconds,
+                        double(entry.bytes) / seconds);
+    }
+
+    return true;
+}
+
+bool ChatHandler::HandleServerCaptureCommand(char* args)
+{
+    if (ExtractLiteralArg(&args, "start"))
+    {
+        char* fileName = ExtractQuotedOrLiteralArg(&args);
+        if (!fileName)
+        {
+            return false;
+        }
+
+        if (!PacketCapture::IsValidFileName(fileName))
+        {
+            PSendSysMessage("%s is not a plain file name, captures are only written to the logs directory.", fileName);
+            SetSentErrorMessage(true);
+            return false;
+        }
+
+        if (!sPacketCapture.Start(fileName))
+        {
+            PSendSysMessage("Can't open %s in the logs directory.", fileName);
+            SetSentErrorMessage(true);
+            return false;
+        }
+    }
+    else if (ExtractLiteralArg(&args, "stop"))
+    {
+        sPacketCapture.Stop();
+        SendSysMessage("Packet capture stopped.");
+        return true;
+    }
+    else if (*args)
+    {
+        return false;
+    }
+
+    PacketCapture::Stats stats;
+    if (!sPacketCapture.GetStats(stats))
+    {
+        SendSysMessage("No packet capture is running.");
+        return true;
+    }
+
+    PSendSysMessage("Capturing to %s for %u s: " UI64FMTD " records, " UI64FMTD " bytes, " UI64FMTD " dropped",
+                    stats.fileName.c_str(), stats.seconds, stats.records, stats.bytes, stats.dropped);
+    return true;
+}
+
 /// Display the 'Message of the day' for the realm
 bool ChatHandler::HandleServerMotdCommand(char* /*args*/)
 {
@@ -0,0 +1,169 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "CellObjectIndex.h"
+#include "Object.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CELL_INDEX_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CELL_INDEX_SSE2
+#endif
+
+CellObjectIndex::~CellObjectIndex()
+{
+    // cells going away with objects still linked, e.g. on map unload
+    for (std::vector<WorldObject*>::const_iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr)
+    {
+        (*itr)->m_cellIndex = NULL;
+    }
+}
+
+void CellObjectIndex::Insert(WorldObject* obj)
+{
+    if (obj->m_cellIndex)
+    {
+        obj->m_cellIndex->Remove(obj);
+    }
+
+    obj->m_cellIndex = this;
+    obj->m_cellIndexSlot = uint32(m_objects.size());
+
+    m_x.push_back(obj->GetPositionX());
+    m_y.push_back(obj->GetPositionY());
+    m_z.push_back(obj->GetPositionZ());
+    m_sizes.push_back(obj->GetObjectBoundingRadius());
+    m_typeMasks.push_back(obj->m_objectType);
+    m_guids.push_back(obj->GetObjectGuid().GetRawValue());
+    m_objects.push_back(obj);
+}
+
+void CellObjectIndex::Remove(WorldObject* obj)
+{
+    if (obj->m_cellIndex != this)
+    {
+        return;
+    }
+
+    // move the last entry into the hole
+    uint32 slot = obj->m_cellIndexSlot;
+    uint32 last = uint32(m_objects.size() - 1);
+    if (slot != last)
+    {
+        m_x[slot] = m_x[last];
+        m_y[slot] = m_y[last];
+        m_z[slot] = m_z[last];
+        m_sizes[slot] = m_sizes[last];
+        m_typeMasks[slot] = m_typeMasks[last];
+        m_guids[slot] = m_guids[last];
+        m_objects[slot] = m_objects[last];
+        m_objects[slot]->m_cellIndexSlot = slot;
+    }
+
+    m_x.pop_back();
+    m_y.pop_back();
+    m_z.pop_back();
+    m_sizes.pop_back();
+    m_typeMasks.pop_back();
+    m_guids.pop_back();
+    m_objects.pop_back();
+
+    obj->m_cellIndex = NULL;
+}
+
+void CellObjectIndex::FindInRange(float x, float y, float z, float radius, uint16 typeMask, std::vector<WorldObject*>& result, bool is3D) const
+{
+    const uint32 count = uint32(m_objects.size());
+    uint32 i = 0;
+
+#ifdef CELL_INDEX_AVX
+    const __m256 cx8 = _mm256_set1_ps(x);
+    const __m256 cy8 = _mm256_set1_ps(y);
+    const __m256 cz8 = _mm256_set1_ps(z);
+    const __m256 r8 = _mm256_set1_ps(radius);
+    const __m256 zero8 = _mm256_setzero_ps();
+
+    // eight objects per step
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&m_x[i]), cx8);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&m_y[i]), cy8);
+        __m256 dz = is3D ? _mm256_sub_ps(_mm256_loadu_ps(&m_z[i]), cz8) : zero8;
+        __m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+        __m256 reach = _mm256_add_ps(_mm256_loadu_ps(&m_sizes[i]), r8);
+
+        int inRange = _mm256_movemask_ps(_mm256_cmp_ps(distSq, _mm256_mul_ps(reach, reach), _CMP_LE_OQ));
+        for (uint32 j = 0; inRange; ++j, inRange >>= 1)
+        {
+            if (inRange & 1)
+            {
+                AddIfMatches(i + j, typeMask, result);
+            }
+        }
+    }
+#endif
+
+#ifdef CELL_INDEX_SSE2
+    const __m128 cx = _mm_set1_ps(x);
+    const __m128 cy = _mm_set1_ps(y);
+    const __m128 cz = _mm_set1_ps(z);
+    const __m128 r = _mm_set1_ps(radius);
+    const __m128 zero = _mm_setzero_ps();
+
+    // four objects per step, only the objects that passed are looked at one by one
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&m_x[i]), cx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&m_y[i]), cy);
+        __m128 dz = is3D ? _mm_sub_ps(_mm_loadu_ps(&m_z[i]), cz) : zero;
+        __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 reach = _mm_add_ps(_mm_loadu_ps(&m_sizes[i]), r);
+
+        int inRange = _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_mul_ps(reach, reach)));
+        for (uint32 j = 0; inRange; ++j, inRange >>= 1)
+        {
+            if (inRange & 1)
+            {
+                AddIfMatches(i + j, typeMask, result);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        float dx = m_x[i] - x;
+        float dy = m_y[i] - y;
+        float dz = is3D ? m_z[i] - z : 0.0f;
+        float reach = radius + m_sizes[i];
+        if (dx * dx + dy * dy + dz * dz <= reach * reach)
+        {
+            AddIfMatches(i, typeMask, result);
+        }
+    }
+}
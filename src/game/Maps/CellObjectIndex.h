@@ -0,0 +1,105 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_CELL_OBJECT_INDEX_H
+#define MANGOS_CELL_OBJECT_INDEX_H
+
+#include "Common.h"
+
+#include <vector>
+
+class WorldObject;
+class Camera;
+
+/**
+ * @brief Dense structure-of-arrays copy of the positions of the objects in one cell.
+ *
+ * The grid containers are linked lists of objects spread over the heap, so a range check
+ * touches one cache line per object. The index keeps guid, position, bounding radius and
+ * type mask of all world objects of a cell in parallel arrays, so visitors can find the
+ * objects within a distance by scanning a few contiguous arrays and only touch the objects
+ * that passed.
+ *
+ * Maintained by the cell on add/remove, by WorldObject::Relocate() and on model changes.
+ */
+class CellObjectIndex
+{
+    public:
+        CellObjectIndex() {}
+        ~CellObjectIndex();
+
+        void Insert(WorldObject* obj);
+        void Insert(Camera* /*camera*/) {}
+        void Remove(WorldObject* obj);
+        void Remove(Camera* /*camera*/) {}
+
+        void Relocate(uint32 slot, float x, float y, float z)
+        {
+            m_x[slot] = x;
+            m_y[slot] = y;
+            m_z[slot] = z;
+        }
+
+        void SetBoundingRadius(uint32 slot, float radius) { m_sizes[slot] = radius; }
+
+        size_t Size() const { return m_objects.size(); }
+        WorldObject* GetObject(uint32 slot) const { return m_objects[slot]; }
+        uint64 GetGuid(uint32 slot) const { return m_guids[slot]; }
+
+        /**
+         * @brief Appends the objects matching the type mask that are within the radius.
+         *
+         * Like WorldObject::IsWithinDist() the bounding radius of the found objects counts towards
+         * the distance, callers add the size of the searching object to the radius themselves.
+         *
+         * @param x, y, z Center of the search.
+         * @param radius Search radius.
+         * @param typeMask TYPEMASK_* flags of the wanted objects.
+         * @param result Receives the objects that passed.
+         * @param is3D Whether the height is checked as well.
+         */
+        void FindInRange(float x, float y, float z, float radius, uint16 typeMask, std::vector<WorldObject*>& result, bool is3D = false) const;
+
+    private:
+        CellObjectIndex(CellObjectIndex const&);
+        CellObjectIndex& operator=(CellObjectIndex const&);
+
+        void AddIfMatches(uint32 slot, uint16 typeMask, std::vector<WorldObject*>& result) const
+        {
+            if (m_typeMasks[slot] & typeMask)
+            {
+                result.push_back(m_objects[slot]);
+            }
+        }
+
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        std::vector<float> m_sizes;
+        std::vector<uint16> m_typeMasks;
+        std::vector<uint64> m_guids;
+        std::vector<WorldObject*> m_objects;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "DynamicTick.h"
+#include "Map.h"
+#include "MapRefManager.h"
+#include "Player.h"
+#include "World.h"
+
+MapTickClass DynamicTick::GetTickClass(Map const& map)
+{
+    if (map.IsBattleGround())
+    {
+        return MAP_TICK_BATTLEGROUND;
+    }
+
+    if (map.IsDungeon())
+    {
+        return MAP_TICK_DUNGEON;
+    }
+
+    return MAP_TICK_CONTINENT;
+}
+
+uint32 DynamicTick::GetUpdateInterval(Map const& map)
+{
+    uint32 idleInterval = 0;
+    switch (GetTickClass(map))
+    {
+        case MAP_TICK_CONTINENT:
+            idleInterval = sWorld.getConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_CONTINENT);
+            break;
+        case MAP_TICK_DUNGEON:
+            idleInterval = sWorld.getConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_DUNGEON);
+            break;
+        case MAP_TICK_BATTLEGROUND:
+            idleInterval = sWorld.getConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_BATTLEGROUND);
+            break;
+        default:
+            break;
+    }
+
+    if (!idleInterval)
+    {
+        return 0;
+    }
+
+    uint32 crowded = sWorld.getConfig(CONFIG_UINT32_MAP_CROWDED_PLAYERS);
+    uint32 players = 0;
+
+    Map::PlayerList const& playerList = map.GetPlayers();
+    for (Map::PlayerList::const_iterator itr = playerList.begin(); itr != playerList.end(); ++itr)
+    {
+        Player const* player = itr->getSource();
+        if (!player)
+        {
+            continue;
+        }
+
+        if (!player->isAFK() || (crowded && ++players >= crowded))
+        {
+            return 0;
+        }
+    }
+
+    return idleInterval;
+}
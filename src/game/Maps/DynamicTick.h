@@ -0,0 +1,66 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_DYNAMICTICK
+#define MANGOS_H_DYNAMICTICK
+
+#include "Common.h"
+
+class Map;
+
+/// Map kinds with their own idle update interval
+enum MapTickClass
+{
+    MAP_TICK_CONTINENT,
+    MAP_TICK_DUNGEON,
+    MAP_TICK_BATTLEGROUND,
+    MAP_TICK_CLASS_COUNT
+};
+
+/**
+ * @brief Decides how often a map has to be updated.
+ *
+ * Maps with at least one player who is not AFK, or with at least MapUpdate.CrowdedPlayers
+ * players, are updated every map update tick. All other maps are updated at the idle
+ * interval configured for their map kind and get the time skipped in between as diff.
+ */
+class DynamicTick
+{
+    public:
+        /**
+         * @brief Gets the kind of a map.
+         * @param map The map.
+         * @return The tick class of the map.
+         */
+        static MapTickClass GetTickClass(Map const& map);
+
+        /**
+         * @brief Gets the minimal time between two updates of a map.
+         * @param map The map.
+         * @return The interval in milliseconds, 0 to update it every tick.
+         */
+        static uint32 GetUpdateInterval(Map const& map);
+};
+
+#endif
@@ -0,0 +1,181 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "GridPreloader.h"
+#include "GridMap.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(GridPreloader);
+
+GridPreloader::GridPreloader() : m_activated(false), m_shutdown(false), m_mutex(), m_requestAvailable(m_mutex)
+{
+}
+
+GridPreloader::~GridPreloader()
+{
+    deactivate();
+}
+
+/**
+ * @brief Queues a grid to be prefetched, grids already queued are ignored.
+ * @param terrain The terrain of the map, referenced until the request is done.
+ * @param gx Terrain grid X coordinate.
+ * @param gy Terrain grid Y coordinate.
+ */
+void GridPreloader::Prefetch(TerrainInfo* terrain, uint32 gx, uint32 gy)
+{
+    if (!m_activated || terrain->IsPrefetched(gx, gy))
+    {
+        return;
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    if (!m_queued.insert(MakeKey(terrain->GetMapId(), gx, gy)).second)
+    {
+        return;
+    }
+
+    // keep the terrain alive while the request is queued
+    terrain->AddRef();
+
+    Request request;
+    request.terrain = terrain;
+    request.gx = gx;
+    request.gy = gy;
+    m_requests.push_back(request);
+
+    m_requestAvailable.signal();
+}
+
+/**
+ * @brief Releases the terrain references of finished requests, called from the world thread.
+ */
+void GridPreloader::Update()
+{
+    std::vector<TerrainInfo*> finished;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+        finished.swap(m_finished);
+    }
+
+    for (std::vector<TerrainInfo*>::const_iterator itr = finished.begin(); itr != finished.end(); ++itr)
+    {
+        if ((*itr)->Release())
+        {
+            sTerrainMgr.UnloadTerrain((*itr)->GetMapId());
+        }
+    }
+}
+
+/**
+ * @brief Starts the preloader threads.
+ * @param num_threads Number of threads to start.
+ * @return Result of the activation.
+ */
+int GridPreloader::activate(size_t num_threads)
+{
+    if (m_activated || num_threads < 1)
+    {
+        return -1;
+    }
+
+    m_shutdown = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(num_threads)) == -1)
+    {
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
+}
+
+/**
+ * @brief Stops the preloader threads, queued requests are dropped.
+ * @return Result of the deactivation.
+ */
+int GridPreloader::deactivate()
+{
+    if (!m_activated)
+    {
+        return -1;
+    }
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_shutdown = true;
+
+        for (std::deque<Request>::const_iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr)
+        {
+            m_finished.push_back(itr->terrain);
+        }
+        m_requests.clear();
+        m_queued.clear();
+
+        m_requestAvailable.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    m_activated = false;
+
+    Update();
+    return 0;
+}
+
+/**
+ * @brief Thread function of the preloader threads.
+ * @return Always returns 0.
+ */
+int GridPreloader::svc()
+{
+    for (;;)
+    {
+        Request request;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+
+            while (m_requests.empty() && !m_shutdown)
+                m_requestAvailable.wait();
+
+            if (m_shutdown)
+            {
+                break;
+            }
+
+            request = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        request.terrain->Prefetch(request.gx, request.gy);
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_queued.erase(MakeKey(request.terrain->GetMapId(), request.gx, request.gy));
+        m_finished.push_back(request.terrain);
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef _GRID_PRELOADER_H_INCLUDED
+#define _GRID_PRELOADER_H_INCLUDED
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+#include <set>
+#include <vector>
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+class TerrainInfo;
+
+/**
+ * @brief Background threads reading the terrain of grids before a map loads them.
+ *
+ * Maps queue the grids their players are heading to. The threads read the .map file of
+ * each grid and pull its vmap and mmap tiles into the file cache, so the terrain load on
+ * the map thread no longer waits for the disk.
+ */
+class GridPreloader : protected ACE_Task_Base
+{
+    public:
+        /**
+         * @brief Constructor for GridPreloader.
+         */
+        GridPreloader();
+
+        /**
+         * @brief Destructor for GridPreloader.
+         */
+        virtual ~GridPreloader();
+
+        /**
+         * @brief Queues a grid to be prefetched, grids already queued are ignored.
+         * @param terrain The terrain of the map, referenced until the request is done.
+         * @param gx Terrain grid X coordinate.
+         * @param gy Terrain grid Y coordinate.
+         */
+        void Prefetch(TerrainInfo* terrain, uint32 gx, uint32 gy);
+
+        /**
+         * @brief Releases the terrain references of finished requests, called from the world thread.
+         */
+        void Update();
+
+        /**
+         * @brief Starts the preloader threads.
+         * @param num_threads Number of threads to start.
+         * @return Result of the activation.
+         */
+        int activate(size_t num_threads);
+
+        /**
+         * @brief Stops the preloader threads, queued requests are dropped.
+         * @return Result of the deactivation.
+         */
+        int deactivate();
+
+        /**
+         * @brief Checks if the preloader is activated.
+         * @return True if activated, false otherwise.
+         */
+        bool activated() const { return m_activated; }
+
+    protected:
+        /**
+         * @brief Thread function of the preloader threads.
+         * @return Always returns 0.
+         */
+        virtual int svc();
+
+    private:
+        /**
+         * @brief A grid waiting to be prefetched.
+         */
+        struct Request
+        {
+            TerrainInfo* terrain; ///< The terrain of the map.
+            uint32 gx; ///< Terrain grid X coordinate.
+            uint32 gy; ///< Terrain grid Y coordinate.
+        };
+
+        /**
+         * @brief Builds the key of a grid in the queued set.
+         */
+        static uint32 MakeKey(uint32 mapId, uint32 gx, uint32 gy) { return (mapId << 12) | (gx << 6) | gy; }
+
+        std::deque<Request> m_requests; ///< Grids waiting to be prefetched.
+        std::set<uint32> m_queued; ///< Keys of the queued and running requests.
+        std::vector<TerrainInfo*> m_finished; ///< Terrains of the finished requests, released by Update().
+        bool m_activated; ///< Whether the preloader threads are running.
+        bool m_shutdown; ///< Tells the preloader threads to exit.
+
+        ACE_Thread_Mutex m_mutex; ///< Protects the queues.
+        ACE_Condition_Thread_Mutex m_requestAvailable; ///< Condition variable for waking idle preloader threads.
+};
+
+#define sGridPreloader MaNGOS::Singleton<GridPreloader>::Instance()
+
+#endif //_GRID_PRELOADER_H_INCLUDED
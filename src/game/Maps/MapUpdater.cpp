@@ -23,12 +23,47 @@
  */
 
 #include "MapUpdater.h"
-#include "DelayExecutor.h"
 #include "Map.h"
 #include "DatabaseEnv.h"
 
 #include <ace/Guard_T.h>
-#include <ace/Method_Request.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_Thread.h>
+
+#include <algorithm>
+
+/// updater and queue index of the current thread, set for the map update threads only
+static thread_local MapUpdater* t_updater = NULL;
+static thread_local size_t t_queueIndex = 0;
+
+/**
+ * @brief Measures the time a request spends on a map.
+ */
+class MapUpdateCostTimer
+{
+    public:
+        /**
+         * @brief Starts measuring.
+         * @param m Reference to the map the time is accounted to.
+         */
+        explicit MapUpdateCostTimer(Map& m) : m_map(m), m_start(ACE_OS::gettimeofday())
+        {
+        }
+
+        /**
+         * @brief Accounts the elapsed time to the map.
+         */
+        ~MapUpdateCostTimer()
+        {
+            ACE_UINT64 elapsed;
+            (ACE_OS::gettimeofday() - m_start).to_usec(elapsed);
+            m_map.AddUpdateCost(uint32(elapsed));
+        }
+
+    private:
+        Map& m_map; ///< Reference to the map.
+        ACE_Time_Value m_start; ///< Start of the measurement.
+};
 
 /**
  * @brief A request to update a map.
@@ -37,18 +72,16 @@ class MapUpdateRequest : public ACE_Method_Request
 {
     private:
         Map& m_map; ///< Reference to the map to be updated.
-        MapUpdater& m_updater; ///< Reference to the map updater.
         ACE_UINT32 m_diff; ///< Time difference for the update.
 
     public:
         /**
          * @brief Constructor for MapUpdateRequest.
          * @param m Reference to the map.
-         * @param u Reference to the map updater.
          * @param d Time difference for the update.
          */
-        MapUpdateRequest(Map& m, MapUpdater& u, ACE_UINT32 d)
-            : m_map(m), m_updater(u), m_diff(d)
+        MapUpdateRequest(Map& m, ACE_UINT32 d)
+            : m_map(m), m_diff(d)
         {
         }
 
@@ -58,8 +91,8 @@ class MapUpdateRequest : public ACE_Method_Request
          */
         virtual int call()
         {
+            MapUpdateCostTimer timer(m_map);
             m_map.Update(m_diff);
-            m_updater.update_finished();
             return 0;
         }
 };
@@ -68,7 +101,8 @@ class MapUpdateRequest : public ACE_Method_Request
  * @brief Constructor for MapUpdater.
  */
 MapUpdater::MapUpdater():
-m_executor(), m_mutex(), m_condition(m_mutex), pending_requests(0)
+m_threadIndex(0), m_queued(0), m_activated(false), m_shutdown(false),
+m_mutex(), m_condition(m_mutex), m_workAvailable(m_mutex), pending_requests(0)
 {
 }
 
@@ -87,7 +121,31 @@ MapUpdater::~MapUpdater()
  */
 int MapUpdater::activate(size_t num_threads)
 {
-    return m_executor._activate((int)num_threads);
+    if (m_activated || num_threads < 1)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        m_queues.push_back(new WorkQueue);
+    }
+
+    m_threadIndex = 0;
+    m_shutdown = false;
+
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, int(num_threads)) == -1)
+    {
+        for (size_t i = 0; i < m_queues.size(); ++i)
+        {
+            delete m_queues[i];
+        }
+        m_queues.clear();
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
 }
 
 /**
@@ -96,16 +154,39 @@ int MapUpdater::activate(size_t num_threads)
  */
 int MapUpdater::deactivate()
 {
+    if (!m_activated)
+    {
+        return -1;
+    }
+
     wait();
-    return m_executor.deactivate();
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_shutdown = true;
+        m_workAvailable.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        delete m_queues[i];
+    }
+    m_queues.clear();
+
+    m_activated = false;
+    return 0;
 }
 
 /**
- * @brief Waits for all pending requests to be processed.
+ * @brief Starts the scheduled requests and waits for all of them to be processed.
  * @return Always returns 0.
  */
 int MapUpdater::wait()
 {
+    dispatch();
+
     ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
 
     while (pending_requests > 0)
@@ -122,18 +203,261 @@ int MapUpdater::wait()
  */
 int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
 {
-    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
-
-    ++pending_requests;
+    return schedule(new MapUpdateRequest(map, diff), map.GetUpdateCost());
+}
 
-    if (m_executor.execute(new MapUpdateRequest(map, *this, diff)) == -1)
+/**
+ * @brief Adds a request to the current batch.
+ * @param request The request to be executed.
+ * @param cost Estimated execution time in microseconds.
+ * @return Result of the scheduling.
+ */
+int MapUpdater::schedule(ACE_Method_Request* request, uint32 cost)
+{
+    if (!m_activated)
     {
+        delete request;
         ACE_DEBUG((LM_ERROR, ACE_TEXT("(%t) \n"), ACE_TEXT("Failed to schedule Map Update")));
-
-        --pending_requests;
         return -1;
     }
 
+    m_batch.push_back(Task(request, cost));
+    return 0;
+}
+
+/**
+ * @brief Spreads the current batch over the thread queues, most expensive first.
+ *
+ * Every request goes to the queue with the lowest estimated load so far, which keeps
+ * the most expensive maps on different threads and starts them at the beginning of the tick.
+ */
+void MapUpdater::dispatch()
+{
+    if (m_batch.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(m_batch.begin(), m_batch.end());
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+        pending_requests += m_batch.size();
+    }
+
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        m_queues[i]->load = 0;
+    }
+
+    for (std::vector<Task>::const_iterator itr = m_batch.begin(); itr != m_batch.end(); ++itr)
+    {
+        size_t target = 0;
+        for (size_t i = 1; i < m_queues.size(); ++i)
+        {
+            if (m_queues[i]->load < m_queues[target]->load)
+            {
+                target = i;
+            }
+        }
+
+        // unmeasured maps still count a little, so they don't all pile up on the same thread
+        m_queues[target]->load += std::max(itr->cost, uint32(1));
+        push(target, *itr, false);
+    }
+
+    m_batch.clear();
+}
+
+/**
+ * @brief Pushes a task to a thread queue and wakes an idle thread.
+ * @param index Index of the queue.
+ * @param task The task to be queued.
+ * @param front Queue at the front, to be taken next by the owning thread.
+ */
+void MapUpdater::push(size_t index, Task const& task, bool front)
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_queues[index]->lock);
+        if (front)
+        {
+            m_queues[index]->tasks.push_front(task);
+        }
+        else
+        {
+            m_queues[index]->tasks.push_back(task);
+        }
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+    ++m_queued;
+    m_workAvailable.signal();
+}
+
+/**
+ * @brief Takes the next task of a thread, stealing from the other queues if its own is empty.
+ * @param index Index of the thread queue.
+ * @param task Receives the task.
+ * @return True if a task was taken.
+ */
+bool MapUpdater::pop(size_t index, Task& task)
+{
+    if (m_queued.value() <= 0)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_queues.size(); ++i)
+    {
+        size_t victim = (index + i) % m_queues.size();
+        WorkQueue& queue = *m_queues[victim];
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, queue.lock, false);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        // own work in planned order, stolen work from the cheap end
+        if (victim == index)
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        else
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+
+        --m_queued;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Takes the next task of the given sub-task group from the front of a thread queue.
+ * @param index Index of the thread queue.
+ * @param group The sub-task group.
+ * @param task Receives the task.
+ * @return True if a task was taken.
+ */
+bool MapUpdater::pop_group(size_t index, SubtaskGroup* group, Task& task)
+{
+    WorkQueue& queue = *m_queues[index];
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, queue.lock, false);
+    if (queue.tasks.empty() || queue.tasks.front().group != group)
+    {
+        return false;
+    }
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    --m_queued;
+    return true;
+}
+
+/**
+ * @brief Executes a task taken from a queue.
+ * @param task The task to be executed.
+ */
+void MapUpdater::run(Task const& task)
+{
+    task.request->call();
+    delete task.request;
+
+    if (task.group)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, task.group->lock);
+        if (--task.group->remaining == 0)
+        {
+            task.group->done.signal();
+        }
+    }
+    else
+    {
+        update_finished();
+    }
+}
+
+/**
+ * @brief Runs independent parts of the current map update and deletes them.
+ * @param requests The requests to be executed, the vector is cleared.
+ */
+void MapUpdater::execute_subtasks(std::vector<ACE_Method_Request*>& requests)
+{
+    MapUpdater* updater = t_updater;
+
+    if (!updater || requests.size() < 2)
+    {
+        for (std::vector<ACE_Method_Request*>::const_iterator itr = requests.begin(); itr != requests.end(); ++itr)
+        {
+            (*itr)->call();
+            delete *itr;
+        }
+
+        requests.clear();
+        return;
+    }
+
+    SubtaskGroup group(long(requests.size()));
+
+    // queued in reverse at the front, so this thread runs them in order while others steal from the back
+    for (std::vector<ACE_Method_Request*>::const_reverse_iterator itr = requests.rbegin(); itr != requests.rend(); ++itr)
+    {
+        updater->push(t_queueIndex, Task(*itr, 0, &group), true);
+    }
+
+    requests.clear();
+
+    // only sub-tasks of this group are run here, anything else could re-enter a map update
+    Task task;
+    while (updater->pop_group(t_queueIndex, &group, task))
+    {
+        updater->run(task);
+    }
+
+    // the group sits at the front of the own queue, so the rest was stolen and runs on other threads
+    ACE_GUARD(ACE_Thread_Mutex, guard, group.lock);
+    while (group.remaining > 0)
+    {
+        group.done.wait();
+    }
+}
+
+/**
+ * @brief Thread function of the update threads.
+ * @return Always returns 0.
+ */
+int MapUpdater::svc()
+{
+    t_updater = this;
+    t_queueIndex = size_t(m_threadIndex++) % m_queues.size();
+
+    Task task;
+    for (;;)
+    {
+        if (pop(t_queueIndex, task))
+        {
+            run(task);
+            continue;
+        }
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+
+        while (m_queued.value() <= 0 && !m_shutdown)
+            m_workAvailable.wait();
+
+        if (m_shutdown && m_queued.value() <= 0)
+        {
+            break;
+        }
+    }
+
+    t_updater = NULL;
     return 0;
 }
 
@@ -143,7 +467,7 @@ int MapUpdater::schedule_update(Map& map, ACE_UINT32 diff)
  */
 bool MapUpdater::activated()
 {
-    return m_executor.activated();
+    return m_activated;
 }
 
 /**
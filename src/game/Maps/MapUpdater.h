@@ -25,17 +25,28 @@
 #ifndef _MAP_UPDATER_H_INCLUDED
 #define _MAP_UPDATER_H_INCLUDED
 
+#include <ace/Task.h>
 #include <ace/Thread_Mutex.h>
 #include <ace/Condition_Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Method_Request.h>
 
-#include "DelayExecutor.h"
+#include <deque>
+#include <vector>
+
+#include "Common.h"
 
 class Map;
 
 /**
  * @brief The MapUpdater class is responsible for managing map update requests.
+ *
+ * Requests scheduled between two wait() calls form a batch. The batch is ordered by the
+ * update time the maps needed during the previous ticks and spread over per-thread queues
+ * so the most expensive maps start first. A thread running out of work steals from the
+ * queues of the other threads, including sub-tasks queued by a running map update.
  */
-class MapUpdater
+class MapUpdater : protected ACE_Task_Base
 {
     public:
         /**
@@ -48,8 +59,6 @@ class MapUpdater
          */
         virtual ~MapUpdater();
 
-        friend class MapUpdateRequest;
-
         /**
          * @brief Schedules a map update.
          * @param map Reference to the map to be updated.
@@ -59,7 +68,7 @@ class MapUpdater
         int schedule_update(Map& map, ACE_UINT32 diff);
 
         /**
-         * @brief Waits for all pending requests to be processed.
+         * @brief Starts the scheduled requests and waits for all of them to be processed.
          * @return Always returns 0.
          */
         int wait();
@@ -83,12 +92,122 @@ class MapUpdater
          */
         bool activated();
 
+        /**
+         * @brief Runs independent parts of the current map update and deletes them.
+         *
+         * Called from a map update thread, the requests are queued on that thread so idle
+         * threads can steal them, and the call returns once all of them are done.
+         * Called from any other thread, the requests are executed in place.
+         *
+         * @param requests The requests to be executed, the vector is cleared.
+         */
+        static void execute_subtasks(std::vector<ACE_Method_Request*>& requests);
+
+    protected:
+        /**
+         * @brief Thread function of the update threads.
+         * @return Always returns 0.
+         */
+        virtual int svc();
+
     private:
-        DelayExecutor m_executor; ///< Executor for handling delayed tasks.
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> AtomicCounter;
+
+        /**
+         * @brief The sub-tasks of one execute_subtasks() call, its thread waits until all of them are done.
+         */
+        struct SubtaskGroup
+        {
+            explicit SubtaskGroup(long count) : done(lock), remaining(count) {}
+
+            ACE_Thread_Mutex lock; ///< Protects remaining.
+            ACE_Condition_Thread_Mutex done; ///< Signaled when the last sub-task finished.
+            long remaining; ///< Sub-tasks not finished yet.
+        };
+
+        /**
+         * @brief A request waiting in one of the thread queues.
+         */
+        struct Task
+        {
+            Task() : request(NULL), cost(0), group(NULL) {}
+            Task(ACE_Method_Request* r, uint32 c, SubtaskGroup* g = NULL) : request(r), cost(c), group(g) {}
+
+            bool operator<(Task const& other) const { return cost > other.cost; } ///< Sorts the most expensive first.
+
+            ACE_Method_Request* request; ///< The request to be executed.
+            uint32 cost; ///< Estimated execution time in microseconds.
+            SubtaskGroup* group; ///< Outstanding sub-tasks of the parent request, NULL for batch requests.
+        };
+
+        /**
+         * @brief The queue of one update thread, the owner takes from the front, thieves from the back.
+         */
+        struct WorkQueue
+        {
+            WorkQueue() : load(0) {}
+
+            ACE_Thread_Mutex lock; ///< Protects the tasks.
+            std::deque<Task> tasks; ///< Queued tasks.
+            uint64 load; ///< Estimated cost assigned during the current dispatch.
+        };
+
+        std::vector<Task> m_batch; ///< Requests scheduled since the last wait().
+        std::vector<WorkQueue*> m_queues; ///< One queue per update thread.
+        AtomicCounter m_threadIndex; ///< Hands out queue indexes to starting threads.
+        AtomicCounter m_queued; ///< Tasks waiting in any queue.
+        bool m_activated; ///< Whether the update threads are running.
+        bool m_shutdown; ///< Tells the update threads to exit.
+
         ACE_Thread_Mutex m_mutex; ///< Mutex for synchronizing access to pending requests.
         ACE_Condition_Thread_Mutex m_condition; ///< Condition variable for signaling when requests are processed.
+        ACE_Condition_Thread_Mutex m_workAvailable; ///< Condition variable for waking idle update threads.
         size_t pending_requests; ///< Number of pending update requests.
 
+        /**
+         * @brief Adds a request to the current batch.
+         * @param request The request to be executed, owned by the updater afterwards.
+         * @param cost Estimated execution time in microseconds.
+         * @return Result of the scheduling.
+         */
+        int schedule(ACE_Method_Request* request, uint32 cost);
+
+        /**
+         * @brief Spreads the current batch over the thread queues, most expensive first.
+         */
+        void dispatch();
+
+        /**
+         * @brief Pushes a task to a thread queue and wakes an idle thread.
+         * @param index Index of the queue.
+         * @param task The task to be queued.
+         * @param front Queue at the front, to be taken next by the owning thread.
+         */
+        void push(size_t index, Task const& task, bool front);
+
+        /**
+         * @brief Takes the next task of a thread, stealing from the other queues if its own is empty.
+         * @param index Index of the thread queue.
+         * @param task Receives the task.
+         * @return True if a task was taken.
+         */
+        bool pop(size_t index, Task& task);
+
+        /**
+         * @brief Takes the next task of the given sub-task group from the front of a thread queue.
+         * @param index Index of the thread queue.
+         * @param group The sub-task group.
+         * @param task Receives the task.
+         * @return True if a task was taken.
+         */
+        bool pop_group(size_t index, SubtaskGroup* group, Task& task);
+
+        /**
+         * @brief Executes a task taken from a queue.
+         * @param task The task to be executed.
+         */
+        void run(Task const& task);
+
         /**
          * @brief Called when a map update is finished.
          */
@@ -28,6 +28,7 @@
 #include "Log.h"
 #include "Errors.h"
 #include "Player.h"
+#include "World.h"
 
 Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl)
 {
@@ -156,8 +157,28 @@ void Camera::UpdateVisibilityOf(WorldObject* target, UpdateData& data, std::set<
 
 void Camera::UpdateVisibilityForOwner()
 {
+    Map* map = m_source->GetMap();
     MaNGOS::VisibleNotifier notifier(*this);
-    Cell::VisitAllObjects(m_source, notifier, m_source->GetMap()->GetVisibilityDistance(), false);
+
+    // game objects and dynamic objects can be visible beyond the visibility distance (transports, own objects),
+    // walk their containers; this also loads the grids around the view point
+    MaNGOS::VisibleObjectsNotifier objectNotifier(notifier);
+    Cell::VisitAllObjects(m_source, objectNotifier, map->GetVisibilityDistance(), false);
+
+    // units and corpses never are, only the ones passing the range prefilter are checked
+    float reach = std::max(map->GetVisibilityDistance(), World::GetMaxVisibleDistanceInFlight()) +
+                  std::max(World::GetVisibleUnitGreyDistance(), World::GetVisibleObjectGreyDistance()) +
+                  m_source->GetObjectBoundingRadius();
+
+    std::vector<WorldObject*> candidates;
+    map->FindObjectsInRange(m_source->GetPositionX(), m_source->GetPositionY(), m_source->GetPositionZ(), reach,
+                            TYPEMASK_UNIT | TYPEMASK_CORPSE, candidates);
+
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+    {
+        notifier.VisitObject(*itr);
+    }
+
     notifier.Notify();
 }
 
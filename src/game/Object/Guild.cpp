@@ -707,12 +707,13 @@ void Guild::BroadcastToOfficers(WorldSession* session, const std::string& msg, u
 
 void Guild::BroadcastPacket(WorldPacket* packet)
 {
+    SharedPacketSender sender(packet);
     for (MemberList::const_iterator itr = members.begin(); itr != members.end(); ++itr)
     {
         Player* player = sObjectAccessor.FindPlayer(ObjectGuid(HIGHGUID_PLAYER, itr->first));
         if (player)
         {
-            player->GetSession()->SendPacket(packet);
+            sender.SendTo(player->GetSession());
         }
     }
 }
@@ -62,6 +62,7 @@ Object::Object()
 
     m_inWorld           = false;
     m_objectUpdated     = false;
+    m_objectUpdateDeferred = false;
 }
 
 Object::~Object()
@@ -188,17 +189,16 @@ void Object::BuildCreateUpdateBlockForPlayer(UpdateData* data, Player* target) c
     _SetCreateBits(&updateMask, target);
     BuildValuesUpdate(updatetype, &buf, &updateMask, target);
     data->AddUpdateBlock();
+    data->AddCreatedGUID(GetObjectGuid());
 }
 
 void Object::SendCreateUpdateToPlayer(Player* player)
 {
     // send create update to player
     UpdateData upd;
-    WorldPacket packet;
 
     BuildCreateUpdateBlockForPlayer(&upd, player);
-    upd.BuildPacket(&packet);
-    player->GetSession()->SendPacket(&packet);
+    player->GetSession()->SendUpdateData(upd);
 }
 
 void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
@@ -217,6 +217,109 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) c
     data->AddUpdateBlock();
 }
 
+/// viewers of the same class get identical values update blocks of an object
+enum ValuesUpdateViewerClass
+{
+    VIEWER_CLASS_PUBLIC             = 0x00,
+    VIEWER_CLASS_GAMEMASTER         = 0x01,                 // sees non selectable units as selectable
+    VIEWER_CLASS_TRAINER_STUDENT    = 0x02,                 // may learn at the trainer
+    VIEWER_CLASS_HUNTER             = 0x04,                 // sees stable masters
+    VIEWER_CLASS_QUEST_ACTIVE       = 0x08,                 // gameobject is active for the viewer's quests
+    VIEWER_CLASS_SELF               = 0x10,                 // the object itself, all fields are visible
+    VIEWER_CLASS_UNIQUE             = 0xFFFFFFFF            // block depends on too much viewer state, not shared
+};
+
+/**
+ * Classifies a viewer by everything BuildValuesUpdate() looks at for the currently changed fields.
+ * Party and owner-only fields are not implemented (see Player::InitVisibleBits), so besides the
+ * object itself all viewers see the same fields.
+ */
+uint32 Object::GetValuesUpdateViewerClass(Player* target) const
+{
+    if (target == this)
+    {
+        return VIEWER_CLASS_SELF;
+    }
+
+    uint32 viewerClass = VIEWER_CLASS_PUBLIC;
+
+    if (isType(TYPEMASK_UNIT))
+    {
+        if (GetTypeId() == TYPEID_UNIT && m_changedValues[UNIT_DYNAMIC_FLAGS])
+        {
+            // loot, tap and empathy state differ per viewer
+            return VIEWER_CLASS_UNIQUE;
+        }
+
+        if (m_changedValues[UNIT_FIELD_FLAGS] && target->isGameMaster())
+        {
+            viewerClass |= VIEWER_CLASS_GAMEMASTER;
+        }
+
+        if (GetTypeId() == TYPEID_UNIT && m_changedValues[UNIT_NPC_FLAGS])
+        {
+            uint32 npcFlags = m_uint32Values[UNIT_NPC_FLAGS];
+            if ((npcFlags & UNIT_NPC_FLAG_TRAINER) && ((Creature*)this)->IsTrainerOf(target, false))
+            {
+                viewerClass |= VIEWER_CLASS_TRAINER_STUDENT;
+            }
+
+            if ((npcFlags & UNIT_NPC_FLAG_STABLEMASTER) && target->getClass() == CLASS_HUNTER)
+            {
+                viewerClass |= VIEWER_CLASS_HUNTER;
+            }
+        }
+    }
+    else if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
+    {
+        // dynamic flags are sent with every gameobject update
+        if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
+        {
+            viewerClass |= VIEWER_CLASS_QUEST_ACTIVE;
+        }
+    }
+
+    return viewerClass;
+}
+
+/**
+ * Appends the values update block for the target, encoding it only once per viewer class.
+ */
+void Object::BuildSharedValuesUpdateBlockForPlayer(UpdateData* data, Player* target, SharedValuesBlocks& sharedBlocks) const
+{
+    uint32 viewerClass = GetValuesUpdateViewerClass(target);
+    if (viewerClass == VIEWER_CLASS_UNIQUE)
+    {
+        BuildValuesUpdateBlockForPlayer(data, target);
+        return;
+    }
+
+    for (SharedValuesBlocks::const_iterator itr = sharedBlocks.begin(); itr != sharedBlocks.end(); ++itr)
+    {
+        if (itr->first == viewerClass)
+        {
+            data->GetBuffer().append(itr->second);
+            data->AddUpdateBlock();
+            return;
+        }
+    }
+
+    sharedBlocks.push_back(SharedValuesBlocks::value_type(viewerClass, ByteBuffer()));
+    ByteBuffer& buf = sharedBlocks.back().second;
+
+    buf << uint8(UPDATETYPE_VALUES);
+    buf << GetPackGUID();
+
+    UpdateMask updateMask;
+    updateMask.SetCount(m_valuesCount);
+
+    _SetUpdateBits(&updateMask, target);
+    BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
+
+    data->GetBuffer().append(buf);
+    data->AddUpdateBlock();
+}
+
 void Object::BuildOutOfRangeUpdateBlock(UpdateData* data) const
 {
     data->AddOutOfRangeGUID(GetObjectGuid());
@@ -538,11 +641,12 @@ void Object::ClearUpdateMask(bool remove)
         }
     }
 
-    if (m_objectUpdated)
+    if (m_objectUpdated || m_objectUpdateDeferred)
     {
         if (remove)
         {
             RemoveFromClientUpdateList();
+            m_objectUpdateDeferred = false;
         }
         m_objectUpdated = false;
     }
@@ -863,7 +967,7 @@ bool Object::PrintEntryError(char const* descr) const
     return false;
 }
 
-void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players)
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, SharedValuesBlocks* sharedBlocks /*= NULL*/)
 {
     UpdateDataMapType::iterator iter = update_players.find(pl);
 
@@ -874,7 +978,21 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    size_t pos = iter->second.GetBuffer().wpos();
+
+    if (sharedBlocks)
+    {
+        BuildSharedValuesUpdateBlockForPlayer(&iter->second, iter->first, *sharedBlocks);
+    }
+    else
+    {
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    }
+
+    if (pl == this)
+    {
+        iter->second.MarkSelfBlock(pos);
+    }
 }
 
 void Object::AddToClientUpdateList()
@@ -913,12 +1031,19 @@ WorldObject::WorldObject() :
 #endif /* ENABLE_ELUNA */
     m_currMap(NULL),
     m_mapId(0), m_InstanceId(0),
-    m_isActiveObject(false)
+    m_isActiveObject(false),
+    m_cellIndex(NULL), m_cellIndexSlot(0)
 {
 }
 
 WorldObject::~WorldObject()
 {
+    // objects deleted while still linked to a cell, e.g. at grid unload
+    if (m_cellIndex)
+    {
+        m_cellIndex->Remove(this);
+    }
+
 #ifdef ENABLE_ELUNA
     delete elunaEvents;
     elunaEvents = nullptr;
@@ -952,6 +1077,11 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
     m_position.z = z;
     m_position.o = MapManager::NormalizeOrientation(orientation);
 
+    if (m_cellIndex)
+    {
+        m_cellIndex->Relocate(m_cellIndexSlot, x, y, z);
+    }
+
     if (isType(TYPEMASK_UNIT))
     {
         ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, orientation);
@@ -964,12 +1094,25 @@ void WorldObject::Relocate(float x, float y, float z)
     m_position.y = y;
     m_position.z = z;
 
+    if (m_cellIndex)
+    {
+        m_cellIndex->Relocate(m_cellIndexSlot, x, y, z);
+    }
+
     if (isType(TYPEMASK_UNIT))
     {
         ((Unit*)this)->m_movementInfo.ChangePosition(x, y, z, GetOrientation());
     }
 }
 
+void WorldObject::UpdateCellIndexBoundingRadius()
+{
+    if (m_cellIndex)
+    {
+        m_cellIndex->SetBoundingRadius(m_cellIndexSlot, GetObjectBoundingRadius());
+    }
+}
+
 void WorldObject::SetOrientation(float orientation)
 {
     m_position.o = MapManager::NormalizeOrientation(orientation);
@@ -1529,11 +1672,12 @@ void WorldObject::MonsterText(MangosStringLocale const* textData, Unit const* ta
             MaNGOS::MonsterChatBuilder say_build(*this, CHAT_MSG_MONSTER_YELL, textData, textData->LanguageId, target);
             MaNGOS::LocalizedPacketDo<MaNGOS::MonsterChatBuilder> say_do(say_build);
             uint32 zoneid = GetZoneId();
-            Map::PlayerList const& pList = GetMap()->GetPlayers();
-            for (Map::PlayerList::const_iterator itr = pList.begin(); itr != pList.end(); ++itr)
-                if (itr->getSource()->GetZoneId() == zoneid)
+            std::vector<Player*> players;
+            GetMap()->GetPlayersSnapshot(players);
+            for (std::vector<Player*>::const_iterator itr = players.begin(); itr != players.end(); ++itr)
+                if ((*itr)->GetZoneId() == zoneid)
                 {
-                    say_do(itr->getSource());
+                    say_do(*itr);
                 }
             break;
         }
@@ -1563,7 +1707,7 @@ void WorldObject::SendMessageToSetExcept(WorldPacket* data, Player const* skippe
     // if object is in world, map for it already created!
     if (IsInWorld())
     {
-        MaNGOS::MessageDelivererExcept notifier(data, skipped_receiver);
+        MaNGOS::MessageDelivererExcept notifier(this, data, skipped_receiver);
         Cell::VisitWorldObjects(this, notifier, GetMap()->GetVisibilityDistance());
     }
 }
@@ -1999,7 +2143,11 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
-    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
+    SharedValuesBlocks i_sharedBlocks;                      // the changed fields encoded once per viewer class
+    float i_farDistSq;                                      // viewers beyond are skipped, 0 to update all
+    bool i_skippedFar;
+    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d, float farDist) : i_updateDatas(d), i_object(obj),
+        i_farDistSq(farDist * farDist), i_skippedFar(false)
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
@@ -2016,7 +2164,13 @@ struct WorldObjectChangeAccumulator
             Player* owner = iter->getSource()->GetOwner();
             if (owner != &i_object && owner->HaveAtClient(&i_object))
             {
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                if (i_farDistSq > 0.0f && MaNGOS::IsFarViewer(iter->getSource(), &i_object, i_farDistSq))
+                {
+                    i_skippedFar = true;
+                    continue;
+                }
+
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_sharedBlocks);
             }
         }
     }
@@ -2026,9 +2180,42 @@ struct WorldObjectChangeAccumulator
 
 void WorldObject::BuildUpdateData(UpdateDataMapType& update_players)
 {
-    WorldObjectChangeAccumulator notifier(*this, update_players);
+    float farDist = sWorld.getConfig(CONFIG_FLOAT_VISIBILITY_LOD_DISTANCE);
+    if (farDist > 0.0f && GetMap()->IsFarUpdateTick(this))
+    {
+        // everything held back goes out now, near viewers just get some fields twice
+        if (m_objectUpdateDeferred)
+        {
+            for (uint16 index = 0; index < m_valuesCount; ++index)
+            {
+                m_changedValues[index] = m_changedValues[index] || m_farChangedValues[index];
+            }
+            m_objectUpdateDeferred = false;
+        }
+
+        farDist = 0.0f;
+    }
+
+    WorldObjectChangeAccumulator notifier(*this, update_players, farDist);
     Cell::VisitWorldObjects(this, notifier, GetMap()->GetVisibilityDistance());
 
+    if (notifier.i_skippedFar)
+    {
+        if (!m_objectUpdateDeferred)
+        {
+            m_farChangedValues = m_changedValues;
+            m_objectUpdateDeferred = true;
+            GetMap()->DeferUpdateObject(this);
+        }
+        else
+        {
+            for (uint16 index = 0; index < m_valuesCount; ++index)
+            {
+                m_farChangedValues[index] = m_farChangedValues[index] || m_changedValues[index];
+            }
+        }
+    }
+
     ClearUpdateMask(false);
 }
 
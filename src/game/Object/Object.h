@@ -80,6 +80,7 @@ class Map;
 class UpdateMask;
 class InstanceData;
 class TerrainInfo;
+class CellObjectIndex;
 #ifdef ENABLE_ELUNA
 class Eluna;
 class ElunaEventProcessor;
@@ -89,6 +90,9 @@ struct MangosStringLocale;
 
 typedef UNORDERED_MAP<Player*, UpdateData> UpdateDataMapType;
 
+// values update blocks of one object encoded during one update, keyed by the viewer class they were built for
+typedef std::vector<std::pair<uint32, ByteBuffer> > SharedValuesBlocks;
+
 struct Position
 {
     Position() : x(0.0f), y(0.0f), z(0.0f), o(0.0f) {}
@@ -453,7 +457,9 @@ class Object
 
         void BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const;
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, SharedValuesBlocks* sharedBlocks = NULL);
+        void BuildSharedValuesUpdateBlockForPlayer(UpdateData* data, Player* target, SharedValuesBlocks& sharedBlocks) const;
+        uint32 GetValuesUpdateViewerClass(Player* target) const;
 
         uint16 m_objectType;
 
@@ -473,6 +479,8 @@ class Object
         uint16 m_valuesCount;
 
         bool m_objectUpdated;
+        bool m_objectUpdateDeferred;                        // changes held back for far viewers, see Visibility.LodDistance
+        std::vector<bool> m_farChangedValues;               // fields changed since far viewers were updated last
 
     private:
         bool m_inWorld;
@@ -494,6 +502,7 @@ struct WorldObjectChangeAccumulator;
 class WorldObject : public Object
 {
         friend struct WorldObjectChangeAccumulator;
+        friend class CellObjectIndex;
 
     public:
 
@@ -576,6 +585,7 @@ class WorldObject : public Object
         }
 
         virtual float GetObjectBoundingRadius() const { return DEFAULT_WORLD_OBJECT_SIZE; }
+        void UpdateCellIndexBoundingRadius();               // call after the bounding radius changed
 
         bool IsPositionValid() const;
         void UpdateGroundPositionZ(float x, float y, float& z) const;
@@ -724,6 +734,9 @@ class WorldObject : public Object
         ViewPoint m_viewPoint;
         WorldUpdateCounter m_updateTracker;
         bool m_isActiveObject;
+
+        CellObjectIndex* m_cellIndex;                       // index of the cell the object is in, kept in sync by Relocate()
+        uint32 m_cellIndexSlot;
 };
 
 // Helper functions to cast between different Object pointers. Useful when unsure that your object* is valid at all.
@@ -29,6 +29,8 @@
 
 #include <sstream>
 
+#include <ace/Guard_T.h>
+
 char const* ObjectGuid::GetTypeName(HighGuid high)
 {
     switch (high)
@@ -73,6 +75,8 @@ std::string ObjectGuid::GetString() const
 template<HighGuid high>
 uint32 ObjectGuidGenerator<high>::Generate()
 {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+
     if (m_nextGuid >= ObjectGuid::GetMaxCounter(high) - 1)
     {
         sLog.outError("%s guid overflow!! Can't continue, shutting down server. ", ObjectGuid::GetTypeName(high));
@@ -28,6 +28,10 @@
 #include "Common.h"
 #include "ByteBuffer.h"
 
+#include <ace/Thread_Mutex.h>
+
+#include <iterator>
+
 enum TypeID
 {
     TYPEID_OBJECT        = 0,
@@ -200,6 +204,81 @@ typedef std::set<ObjectGuid> GuidSet;
 typedef std::list<ObjectGuid> GuidList;
 typedef std::vector<ObjectGuid> GuidVector;
 
+/**
+ * Set of guids kept as a sorted vector.
+ *
+ * Membership tests are a binary search over contiguous memory, and differences against
+ * other sorted guid ranges are a single linear sweep. Meant for sets that are tested far
+ * more often than they change, like the objects a client knows about.
+ */
+class GuidFlatSet
+{
+    public:
+        typedef GuidVector::const_iterator const_iterator;
+
+        const_iterator begin() const { return m_guids.begin(); }
+        const_iterator end() const { return m_guids.end(); }
+        bool empty() const { return m_guids.empty(); }
+        size_t size() const { return m_guids.size(); }
+        void clear() { m_guids.clear(); }
+
+        bool contains(ObjectGuid const& guid) const { return std::binary_search(m_guids.begin(), m_guids.end(), guid); }
+
+        bool insert(ObjectGuid const& guid)
+        {
+            GuidVector::iterator itr = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+            if (itr != m_guids.end() && *itr == guid)
+            {
+                return false;
+            }
+
+            m_guids.insert(itr, guid);
+            return true;
+        }
+
+        bool erase(ObjectGuid const& guid)
+        {
+            GuidVector::iterator itr = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+            if (itr == m_guids.end() || *itr != guid)
+            {
+                return false;
+            }
+
+            m_guids.erase(itr);
+            return true;
+        }
+
+        // removes all guids of the sorted range, in place in one sweep
+        void erase(GuidVector const& sorted)
+        {
+            GuidVector::const_iterator removed = sorted.begin();
+            GuidVector::iterator last = m_guids.begin();
+            for (GuidVector::iterator itr = m_guids.begin(); itr != m_guids.end(); ++itr)
+            {
+                while (removed != sorted.end() && *removed < *itr)
+                {
+                    ++removed;
+                }
+
+                if (removed == sorted.end() || *itr < *removed)
+                {
+                    *last++ = *itr;
+                }
+            }
+
+            m_guids.erase(last, m_guids.end());
+        }
+
+        // appends the guids that are in the set but not in the sorted range to result, in order
+        void Difference(GuidVector const& sorted, GuidVector& result) const
+        {
+            std::set_difference(m_guids.begin(), m_guids.end(), sorted.begin(), sorted.end(), std::back_inserter(result));
+        }
+
+    private:
+        GuidVector m_guids;
+};
+
 // minimum buffer size for packed guid is 9 bytes
 #define PACKED_GUID_MIN_BUFFER_SIZE 9
 
@@ -238,6 +317,7 @@ class ObjectGuidGenerator
 
     private:                                                // fields
         uint32 m_nextGuid;
+        ACE_Thread_Mutex m_lock;                            // maps updated on different threads generate concurrently
 };
 
 ByteBuffer& operator<< (ByteBuffer& buf, ObjectGuid const& guid);
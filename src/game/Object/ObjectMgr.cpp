@@ -55,6 +55,8 @@
 #include "ItemEnchantmentMgr.h"
 #include <limits>
 
+#include <ace/Guard_T.h>
+
 INSTANTIATE_SINGLETON_1(ObjectMgr);
 
 bool normalizePlayerName(std::string& name)
@@ -149,6 +151,8 @@ bool SpellClickInfo::IsFitToRequirements(Player const* player, Creature const* c
 template<typename T>
 T IdGenerator<T>::Generate()
 {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+
     if (m_nextGuid >= std::numeric_limits<T>::max() - 1)
     {
         sLog.outError("%s guid overflow!! Can't continue, shutting down server. ", m_name);
@@ -508,6 +508,7 @@ class IdGenerator
     private:                                                // fields
         char const* m_name;
         T m_nextGuid;
+        ACE_Thread_Mutex m_lock;                            // maps updated on different threads generate concurrently
 };
 
 class ObjectMgr
@@ -3041,6 +3041,9 @@ bool Player::TeleportTo(uint32 mapid, float x, float y, float z, float orientati
                 oldmap->Remove(this, false);
             }
 
+            // moves and held back packets about objects of the old map must not reach the client on the new one
+            GetSession()->ClearObjectPackets();
+
             // new final coordinates
             float final_x = x;
             float final_y = y;
@@ -22767,7 +22770,7 @@ void Player::UpdateForQuestWorldObjects()
         return;
     }
 
-    for (GuidSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
+    for (GuidFlatSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
     {
         if (itr->IsGameObject())
         {
@@ -3386,10 +3386,10 @@ class Player : public Unit
         Object* GetObjectByTypeMask(ObjectGuid guid, TypeMask typemask);
 
         // Currently visible objects at the player's client
-        GuidSet m_clientGUIDs;
+        GuidFlatSet m_clientGUIDs;
 
         // Check if an object is visible to the client
-        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.find(u->GetObjectGuid()) != m_clientGUIDs.end(); }
+        bool HaveAtClient(WorldObject const* u) { return u == this || m_clientGUIDs.contains(u->GetObjectGuid()); }
 
         // Check if the player is visible in the grid for another player
         bool IsVisibleInGridForPlayer(Player* pl) const override;
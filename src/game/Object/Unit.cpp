@@ -10393,6 +10393,7 @@ void Unit::UpdateModelData()
     {
         // we expect values in database to be relative to scale = 1.0
         SetFloatValue(UNIT_FIELD_BOUNDINGRADIUS, GetObjectScale() * modelInfo->bounding_radius);
+        UpdateCellIndexBoundingRadius();
 
         // never actually update combat_reach for player, it's always the same. Below player case is for initialization
         if (GetTypeId() == TYPEID_PLAYER)
@@ -11045,15 +11046,27 @@ class RelocationNotifyEvent : public BasicEvent
         bool Execute(uint64 /*e_time*/, uint32 /*p_time*/)
         {
             float radius = MAX_CREATURE_ATTACK_RADIUS * sWorld.getConfig(CONFIG_FLOAT_RATE_CREATURE_AGGRO);
+
+            // only the units passing the range prefilter of the cell indexes get notified
+            std::vector<WorldObject*> candidates;
+            m_owner.GetMap()->FindObjectsInRange(m_owner.GetPositionX(), m_owner.GetPositionY(), m_owner.GetPositionZ(),
+                                                 radius + m_owner.GetObjectBoundingRadius(), TYPEMASK_UNIT, candidates);
+
             if (m_owner.GetTypeId() == TYPEID_PLAYER)
             {
                 MaNGOS::PlayerRelocationNotifier notify((Player&)m_owner);
-                Cell::VisitAllObjects(&m_owner, notify, radius);
+                for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+                {
+                    notify.VisitObject((Unit*)(*itr));
+                }
             }
             else // if(m_owner.GetTypeId() == TYPEID_UNIT)
             {
                 MaNGOS::CreatureRelocationNotifier notify((Creature&)m_owner);
-                Cell::VisitAllObjects(&m_owner, notify, radius);
+                for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+                {
+                    notify.VisitObject((Unit*)(*itr));
+                }
             }
             m_owner._SetAINotifyScheduled(false);
             return true;
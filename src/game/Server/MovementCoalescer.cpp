@@ -0,0 +1,147 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "MovementCoalescer.h"
+#include "WorldPacket.h"
+#include "Opcodes.h"
+#include "UpdateData.h"
+#include "Timer.h"
+
+#include <zlib.h>
+
+bool MovementCoalescer::IsCoalescable(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case SMSG_MONSTER_MOVE:
+        case MSG_MOVE_START_FORWARD:
+        case MSG_MOVE_START_BACKWARD:
+        case MSG_MOVE_STOP:
+        case MSG_MOVE_START_STRAFE_LEFT:
+        case MSG_MOVE_START_STRAFE_RIGHT:
+        case MSG_MOVE_STOP_STRAFE:
+        case MSG_MOVE_JUMP:
+        case MSG_MOVE_START_TURN_LEFT:
+        case MSG_MOVE_START_TURN_RIGHT:
+        case MSG_MOVE_STOP_TURN:
+        case MSG_MOVE_START_PITCH_UP:
+        case MSG_MOVE_START_PITCH_DOWN:
+        case MSG_MOVE_STOP_PITCH:
+        case MSG_MOVE_SET_RUN_MODE:
+        case MSG_MOVE_SET_WALK_MODE:
+        case MSG_MOVE_FALL_LAND:
+        case MSG_MOVE_START_SWIM:
+        case MSG_MOVE_STOP_SWIM:
+        case MSG_MOVE_SET_FACING:
+        case MSG_MOVE_SET_PITCH:
+        case MSG_MOVE_HEARTBEAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void MovementCoalescer::Add(WorldPacket const& packet, uint32 now)
+{
+    MANGOS_ASSERT(packet.size() <= MOVEMENT_COALESCE_MAX_PAYLOAD);
+
+    if (m_count == 0)
+    {
+        m_firstTime = now;
+    }
+
+    m_buffer << uint8(packet.size() + sizeof(uint16));
+    m_buffer << uint16(packet.GetOpcode());
+    if (!packet.empty())
+    {
+        m_buffer.append(packet.contents(), packet.size());
+    }
+
+    ++m_count;
+    ++GetStats().moves;
+    GetStats().rawBytes += packet.size();
+}
+
+bool MovementCoalescer::IsDue(uint32 now, uint32 window) const
+{
+    return m_count != 0 && getMSTimeDiff(m_firstTime, now) >= window;
+}
+
+bool MovementCoalescer::Flush(WorldPacket& packet)
+{
+    if (m_count == 0)
+    {
+        return false;
+    }
+
+    if (m_count == 1)
+    {
+        // nothing to gain, send the move as it came
+        uint16 opcode = m_buffer.read<uint16>(sizeof(uint8));
+        packet.Initialize(opcode, m_buffer.size() - sizeof(uint8) - sizeof(uint16));
+        packet.append(m_buffer.contents() + sizeof(uint8) + sizeof(uint16), m_buffer.size() - sizeof(uint8) - sizeof(uint16));
+    }
+    else
+    {
+        uint32 destsize = compressBound(m_buffer.size());
+        packet.Initialize(SMSG_COMPRESSED_MOVES, destsize + sizeof(uint32));
+        packet.resize(destsize + sizeof(uint32));
+        packet.put<uint32>(0, m_buffer.size());
+        UpdateData::Compress(const_cast<uint8*>(packet.contents()) + sizeof(uint32), &destsize, (void*)m_buffer.contents(), m_buffer.size());
+        if (destsize == 0)
+        {
+            Clear();
+            return false;
+        }
+
+        packet.resize(destsize + sizeof(uint32));
+    }
+
+    ++GetStats().packets;
+    GetStats().sentBytes += packet.size();
+
+    Clear();
+    return true;
+}
+
+void MovementCoalescer::Clear()
+{
+    m_buffer.clear();
+    m_count = 0;
+}
+
+void MovementCoalescer::Stats::Reset()
+{
+    moves = 0;
+    packets = 0;
+    rawBytes = 0;
+    sentBytes = 0;
+    since = getMSTime();
+}
+
+MovementCoalescer::Stats& MovementCoalescer::GetStats()
+{
+    static Stats stats;
+    return stats;
+}
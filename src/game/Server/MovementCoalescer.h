@@ -0,0 +1,94 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/** \addtogroup u2w User to World Communication
+ *  @{
+ *  \file MovementCoalescer.h
+ */
+
+#ifndef MANGOS_H_MOVEMENTCOALESCER
+#define MANGOS_H_MOVEMENTCOALESCER
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include "Common.h"
+#include "ByteBuffer.h"
+
+class WorldPacket;
+
+/// Largest payload that fits in one SMSG_COMPRESSED_MOVES entry, the entry size byte also counts the opcode.
+#define MOVEMENT_COALESCE_MAX_PAYLOAD   (0xFF - sizeof(uint16))
+/// Uncompressed size at which the collected moves are sent without waiting for the flush window.
+#define MOVEMENT_COALESCE_MAX_SIZE      4096
+
+/// Collects the movement packets of other units sent to one client.
+///
+/// Each packet is stored as a SMSG_COMPRESSED_MOVES entry: the uint8 size of opcode and payload,
+/// the uint16 opcode and the payload. When flushed, a single entry is sent as the original
+/// packet, more entries are deflated into one SMSG_COMPRESSED_MOVES.
+class MovementCoalescer
+{
+    public:
+        MovementCoalescer() : m_count(0), m_firstTime(0) {}
+
+        /// Movement relay opcodes the client accepts inside SMSG_COMPRESSED_MOVES.
+        static bool IsCoalescable(uint16 opcode);
+
+        /// Append a packet, its payload must not exceed MOVEMENT_COALESCE_MAX_PAYLOAD.
+        void Add(WorldPacket const& packet, uint32 now);
+
+        bool IsEmpty() const { return m_count == 0; }
+        bool IsFull() const { return m_buffer.size() >= MOVEMENT_COALESCE_MAX_SIZE; }
+        /// True when the oldest collected packet waited at least window milliseconds.
+        bool IsDue(uint32 now, uint32 window) const;
+
+        /// Build the packet to send for the collected moves and clear them.
+        /// @return false when nothing was collected or compression failed
+        bool Flush(WorldPacket& packet);
+
+        /// Drop the collected moves, used when the client changes map or logs out.
+        void Clear();
+
+        /// Counters over all sessions, for the .debug movecoalesce command.
+        struct Stats
+        {
+            ACE_Atomic_Op<ACE_Thread_Mutex, uint64> moves;       ///< movement packets collected
+            ACE_Atomic_Op<ACE_Thread_Mutex, uint64> packets;     ///< packets sent for them
+            ACE_Atomic_Op<ACE_Thread_Mutex, uint64> rawBytes;    ///< payload bytes the moves had on their own
+            ACE_Atomic_Op<ACE_Thread_Mutex, uint64> sentBytes;   ///< payload bytes actually sent
+            uint32 since;                                        ///< getMSTime() of the last reset
+
+            void Reset();
+        };
+
+        static Stats& GetStats();
+
+    private:
+        ByteBuffer m_buffer;
+        uint32 m_count;
+        uint32 m_firstTime;
+};
+#endif
+/// @}
@@ -0,0 +1,114 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "OpcodeThrottle.h"
+#include "Opcodes.h"
+#include "Timer.h"
+
+#include <atomic>
+
+/// packets over the limit per opcode over all clients
+static std::atomic<uint32> s_overLimit[NUM_MSG_TYPES];
+/// clients disconnected per opcode
+static std::atomic<uint32> s_kicks[NUM_MSG_TYPES];
+
+OpcodeThrottleResult OpcodeThrottle::Check(uint16 opcode, uint32 now)
+{
+    OpcodeHandler const& handler = opcodeTable[opcode];
+    if (!handler.rateLimit)
+    {
+        return THROTTLE_RESULT_PASS;
+    }
+
+    int32 capacity = int32(handler.rateBurst) * 1000;
+
+    if (m_buckets.empty())
+    {
+        m_buckets.resize(GetRateLimitedOpcodeCount());
+        for (std::vector<Bucket>::iterator itr = m_buckets.begin(); itr != m_buckets.end(); ++itr)
+        {
+            itr->tokens = 0;
+            itr->lastRefill = now;
+            itr->filled = false;
+        }
+    }
+
+    Bucket& bucket = m_buckets[handler.rateSlot];
+
+    if (!bucket.filled)
+    {
+        bucket.tokens = capacity;
+        bucket.filled = true;
+    }
+    else
+    {
+        // one token per second and packet of the limit is one thousandth per millisecond
+        int64 tokens = bucket.tokens + int64(getMSTimeDiff(bucket.lastRefill, now)) * handler.rateLimit;
+        bucket.tokens = int32(std::min(tokens, int64(capacity)));
+    }
+
+    bucket.lastRefill = now;
+
+    if (bucket.tokens >= 1000)
+    {
+        bucket.tokens -= 1000;
+        return THROTTLE_RESULT_PASS;
+    }
+
+    s_overLimit[opcode].fetch_add(1, std::memory_order_relaxed);
+
+    if (handler.rateAction == THROTTLE_DROP)
+    {
+        return THROTTLE_RESULT_DROP;
+    }
+
+    // the client waits for the answer, so it is handled on credit up to another burst
+    bucket.tokens -= 1000;
+    if (bucket.tokens > -capacity)
+    {
+        return THROTTLE_RESULT_PASS;
+    }
+
+    s_kicks[opcode].fetch_add(1, std::memory_order_relaxed);
+    return THROTTLE_RESULT_KICK;
+}
+
+uint32 OpcodeThrottle::GetOverLimit(uint16 opcode)
+{
+    return opcode < NUM_MSG_TYPES ? s_overLimit[opcode].load(std::memory_order_relaxed) : 0;
+}
+
+uint32 OpcodeThrottle::GetKicks(uint16 opcode)
+{
+    return opcode < NUM_MSG_TYPES ? s_kicks[opcode].load(std::memory_order_relaxed) : 0;
+}
+
+void OpcodeThrottle::ResetCounters()
+{
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        s_overLimit[i].store(0, std::memory_order_relaxed);
+        s_kicks[i].store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/** \addtogroup u2w User to World Communication
+ *  @{
+ *  \file OpcodeThrottle.h
+ */
+
+#ifndef MANGOS_H_OPCODETHROTTLE
+#define MANGOS_H_OPCODETHROTTLE
+
+#include <vector>
+
+#include "Common.h"
+
+/// What to do with a received packet
+enum OpcodeThrottleResult
+{
+    THROTTLE_RESULT_PASS,                                   ///< handle it
+    THROTTLE_RESULT_DROP,                                   ///< drop it, the client is over the limit of the opcode
+    THROTTLE_RESULT_KICK                                    ///< disconnect the client, it goes on past twice the burst of a query
+};
+
+/// Token buckets of one client for the opcodes with a rate limit in the opcode table.
+///
+/// Every bucket starts full with the burst of its opcode and refills at the rate limit,
+/// a packet takes one token. Over the limit, packets of THROTTLE_DROP opcodes are dropped.
+/// Packets of THROTTLE_KICK opcodes are still handled and run the bucket into debt, once the
+/// debt reaches the burst the client is disconnected. Used by the socket thread of the client only.
+class OpcodeThrottle
+{
+    public:
+        OpcodeThrottle() {}
+
+        /// Take a token for a received packet.
+        OpcodeThrottleResult Check(uint16 opcode, uint32 now);
+
+        /// Packets of the opcode over the limit over all clients, for the .debug throttle command.
+        static uint32 GetOverLimit(uint16 opcode);
+        /// Clients disconnected for the opcode, for the .debug throttle command.
+        static uint32 GetKicks(uint16 opcode);
+        static void ResetCounters();
+
+    private:
+        struct Bucket
+        {
+            int32 tokens;                                   ///< in thousandths of a packet, negative while in debt
+            uint32 lastRefill;                              ///< getMSTime() of the last refill
+            bool filled;                                    ///< filled on first use
+        };
+
+        std::vector<Bucket> m_buckets;
+};
+
+#endif
+/// @}
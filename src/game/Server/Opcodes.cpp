@@ -39,6 +39,24 @@ static void DefineOpcode(uint16 opcode, const char* name, SessionStatus status,
 
 #define OPCODE( name, status, packetProcessing, handler ) DefineOpcode( name, #name, status, packetProcessing, handler )
 
+/// Number of opcodes with a rate limit
+static uint16 rateLimitedOpcodes = 0;
+
+static void DefineOpcodeRateLimit(uint16 opcode, uint16 perSecond, uint16 burst, OpcodeThrottleAction action)
+{
+    opcodeTable[opcode].rateLimit = perSecond;
+    opcodeTable[opcode].rateBurst = burst;
+    opcodeTable[opcode].rateSlot = rateLimitedOpcodes++;
+    opcodeTable[opcode].rateAction = action;
+}
+
+#define OPCODE_RATE_LIMIT( name, perSecond, burst, action ) DefineOpcodeRateLimit( name, perSecond, burst, action )
+
+uint16 GetRateLimitedOpcodeCount()
+{
+    return rateLimitedOpcodes;
+}
+
 /// Correspondence between opcodes and their names
 OpcodeHandler opcodeTable[NUM_MSG_TYPES];
 
@@ -48,9 +66,14 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES];
  */
 void InitializeOpcodes()
 {
+    rateLimitedOpcodes = 0;
+
     for (uint16 i = 0; i < NUM_MSG_TYPES; ++i)
     {
         DefineOpcode(i, "UNKNOWN", STATUS_UNHANDLED, PROCESS_INPLACE, &WorldSession::Handle_NULL);
+        opcodeTable[i].rateLimit = 0;
+        opcodeTable[i].rateBurst = 0;
+        opcodeTable[i].rateSlot = 0;
     }
 
     OPCODE(MSG_NULL_ACTION,                                STATUS_NEVER,    PROCESS_INPLACE,      &WorldSession::Handle_NULL);
@@ -978,5 +1001,27 @@ void InitializeOpcodes()
 	// Data: Serialized player state (position, stats, equipment, etc.)
 	// ====================== END CLUSTER OPCODES ======================
 
+    // Rate limits per session: packets per second, the burst allowed on top and what happens beyond, see Network.OpcodeThrottle.
+    // Packets the client expects no answer to are dropped by the socket before they reach the session queue.
+    // Queries are always answered, a client waiting on a dropped one would show unknown names and items for good,
+    // instead a client going on past twice the burst is disconnected.
+    // Queries come in bursts when a bag, the bank or a crowded place is first seen, so their burst is high.
+    // Every quest giver coming into view is asked for its status, in a busy town that is hundreds at once.
+    OPCODE_RATE_LIMIT(CMSG_NAME_QUERY,                     50, 200, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_ITEM_QUERY_SINGLE,              50, 300, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_ITEM_NAME_QUERY,                50, 200, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_CREATURE_QUERY,                 50, 200, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_GAMEOBJECT_QUERY,               50, 200, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_PAGE_TEXT_QUERY,                10,  20, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_NPC_TEXT_QUERY,                 10,  20, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_QUESTGIVER_STATUS_QUERY,        50, 500, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_MESSAGECHAT,                     5,  20, THROTTLE_DROP);
+    OPCODE_RATE_LIMIT(CMSG_TEXT_EMOTE,                      5,  10, THROTTLE_DROP);
+    OPCODE_RATE_LIMIT(CMSG_EMOTE,                           5,  10, THROTTLE_DROP);
+    OPCODE_RATE_LIMIT(CMSG_WHO,                             1,   5, THROTTLE_DROP);
+    OPCODE_RATE_LIMIT(CMSG_WHOIS,                           1,   5, THROTTLE_DROP);
+    OPCODE_RATE_LIMIT(CMSG_GUILD_ROSTER,                    2,   5, THROTTLE_KICK);
+    OPCODE_RATE_LIMIT(CMSG_CHANNEL_LIST,                    2,   5, THROTTLE_KICK);
+
     return;
 };
@@ -996,6 +996,15 @@ enum PacketProcessing
     PROCESS_THREADSAFE     ///< packet is thread-safe - process it in \ref Map::Update
 };
 
+/**
+ * What the socket does with a packet of a client over the rate limit of its opcode (see \ref OpcodeThrottle).
+ */
+enum OpcodeThrottleAction
+{
+    THROTTLE_DROP = 0,     ///< drop it, for packets the client expects no answer to (chat, emotes, who)
+    THROTTLE_KICK          ///< handle it, but disconnect a client going on beyond twice the burst - for queries the client waits on
+};
+
 class WorldPacket;
 
 /**
@@ -1015,10 +1024,21 @@ struct OpcodeHandler
     PacketProcessing packetProcessing;
     ///The callback called for this opcode which will work some magic
     void (WorldSession::*handler)(WorldPacket& recvPacket);
+    ///Packets per second a session may send of this opcode, 0 for no limit (see \ref OpcodeThrottle)
+    uint16 rateLimit;
+    ///Packets a session may send at once before the rate limit applies
+    uint16 rateBurst;
+    ///Index of the token bucket of this opcode in \ref OpcodeThrottle
+    uint16 rateSlot;
+    ///What happens to packets over the rate limit
+    OpcodeThrottleAction rateAction;
 };
 
 extern OpcodeHandler opcodeTable[NUM_MSG_TYPES];
 
+/// Number of opcodes with a rate limit, the token buckets a session needs
+uint16 GetRateLimitedOpcodeCount();
+
 /// Lookup opcode name for human understandable logging
 inline const char* LookupOpcodeName(uint16 id)
 {
@@ -0,0 +1,227 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "OutboundScheduler.h"
+#include "Opcodes.h"
+#include "World.h"
+#include "MovementCoalescer.h"
+#include "Timer.h"
+#include "WorldSocket.h"
+
+#include <ace/Guard_T.h>
+
+/// Bytes a packet costs on the wire, payload and server header
+static inline int64 GetWireSize(WorldPacket const& packet)
+{
+    return int64(packet.size() + 4);
+}
+
+OutboundScheduler::OutboundScheduler() : m_queuedCount(0), m_tokens(0), m_lastRefill(0)
+{
+}
+
+OutboundPriority OutboundScheduler::GetPriority(uint16 opcode)
+{
+    switch (opcode)
+    {
+        case SMSG_UPDATE_OBJECT:
+        case SMSG_COMPRESSED_UPDATE_OBJECT:
+        case SMSG_DESTROY_OBJECT:
+            return OUTBOUND_PRIORITY_CREATE_NEAR;
+        case SMSG_COMPRESSED_MOVES:
+            return OUTBOUND_PRIORITY_MOVEMENT;
+        case SMSG_MESSAGECHAT:
+        case SMSG_CHANNEL_NOTIFY:
+        case SMSG_CHANNEL_LIST:
+        case SMSG_EMOTE:
+        case SMSG_TEXT_EMOTE:
+            return OUTBOUND_PRIORITY_CHAT;
+        default:
+            return MovementCoalescer::IsCoalescable(opcode) ? OUTBOUND_PRIORITY_MOVEMENT : OUTBOUND_PRIORITY_SELF;
+    }
+}
+
+void OutboundScheduler::Refill(uint32 now)
+{
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_SESSION_BANDWIDTH);
+
+    m_tokens += int64(budget) * getMSTimeDiff(m_lastRefill, now) / IN_MILLISECONDS;
+    if (m_tokens > int64(budget))
+    {
+        m_tokens = budget;                                  // at most one second of burst
+    }
+
+    m_lastRefill = now;
+}
+
+int OutboundScheduler::Send(WorldSocket* socket, WorldPacket const& packet, SharedWorldPacket const* shared, OutboundPriority priority,
+                            ObjectGuid const& subject, GuidVector const* created)
+{
+    uint32 budget = sWorld.getConfig(CONFIG_UINT32_SESSION_BANDWIDTH);
+    if (!budget && !HasQueued())
+    {
+        return shared ? socket->SendPacket(*shared) : socket->SendPacket(packet);
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, -1);
+
+    Refill(getMSTime());
+
+    // object updates must not overtake the creates held back
+    if (priority == OUTBOUND_PRIORITY_CREATE_NEAR && !m_queues[OUTBOUND_PRIORITY_CREATE_FAR].empty())
+    {
+        priority = OUTBOUND_PRIORITY_CREATE_FAR;
+    }
+
+    // nor anything else about an object the client doesn't know yet
+    if (!subject.IsEmpty() && m_pendingCreates.find(subject) != m_pendingCreates.end())
+    {
+        priority = m_queues[OUTBOUND_PRIORITY_CREATE_FAR].empty() ? OUTBOUND_PRIORITY_CREATE_NEAR : OUTBOUND_PRIORITY_CREATE_FAR;
+    }
+
+    bool sendNow;
+    if (priority == OUTBOUND_PRIORITY_SELF)
+    {
+        m_tokens = std::max(m_tokens - GetWireSize(packet), -int64(budget));
+        sendNow = true;
+    }
+    else
+    {
+        sendNow = !budget || m_tokens > 0;
+        for (uint8 i = OUTBOUND_PRIORITY_MOVEMENT; sendNow && i <= priority; ++i)
+        {
+            sendNow = m_queues[i].empty();
+        }
+
+        if (sendNow)
+        {
+            m_tokens -= GetWireSize(packet);
+        }
+    }
+
+    if (sendNow)
+    {
+        return shared ? socket->SendPacket(*shared) : socket->SendPacket(packet);
+    }
+
+    QueuedPacket queued;
+    queued.packet = shared ? *shared : std::make_shared<WorldPacket const>(packet);
+    if (created)
+    {
+        queued.created = *created;
+        for (GuidVector::const_iterator itr = created->begin(); itr != created->end(); ++itr)
+        {
+            ++m_pendingCreates[*itr];
+        }
+    }
+
+    m_queues[priority].push_back(queued);
+    ++m_queuedCount;
+    return 0;
+}
+
+void OutboundScheduler::Dequeue(std::deque<QueuedPacket>& queue)
+{
+    GuidVector const& created = queue.front().created;
+    for (GuidVector::const_iterator itr = created.begin(); itr != created.end(); ++itr)
+    {
+        std::map<ObjectGuid, uint32>::iterator pending = m_pendingCreates.find(*itr);
+        if (pending != m_pendingCreates.end() && --pending->second == 0)
+        {
+            m_pendingCreates.erase(pending);
+        }
+    }
+
+    queue.pop_front();
+    --m_queuedCount;
+}
+
+int OutboundScheduler::SendDue(WorldSocket* socket)
+{
+    if (!HasQueued())
+    {
+        return 0;
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+
+    Refill(getMSTime());
+
+    // without a budget (turned off by a config reload) everything goes
+    bool unlimited = !sWorld.getConfig(CONFIG_UINT32_SESSION_BANDWIDTH);
+
+    for (uint8 i = OUTBOUND_PRIORITY_MOVEMENT; i < MAX_OUTBOUND_PRIORITY; ++i)
+    {
+        std::deque<QueuedPacket>& queue = m_queues[i];
+        while (!queue.empty() && (unlimited || m_tokens > 0))
+        {
+            m_tokens -= GetWireSize(*queue.front().packet);
+
+            // taken off the queue only once written, so the unlocked path of Send() waits for it
+            if (socket->SendPacket(queue.front().packet) == -1)
+            {
+                return -1;
+            }
+
+            Dequeue(queue);
+        }
+
+        // lower classes wait until this one is through
+        if (!queue.empty())
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+void OutboundScheduler::ClearObjectPackets()
+{
+    if (!HasQueued())
+    {
+        return;
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    for (uint8 i = OUTBOUND_PRIORITY_MOVEMENT; i < OUTBOUND_PRIORITY_CHAT; ++i)
+    {
+        m_queuedCount -= long(m_queues[i].size());
+        m_queues[i].clear();
+    }
+
+    m_pendingCreates.clear();
+}
+
+bool OutboundScheduler::IsCreatePending(ObjectGuid const& guid)
+{
+    if (!HasQueued())
+    {
+        return false;
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    return m_pendingCreates.find(guid) != m_pendingCreates.end();
+}
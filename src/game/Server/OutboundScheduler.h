@@ -0,0 +1,120 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/** \addtogroup u2w User to World Communication
+ *  @{
+ *  \file OutboundScheduler.h
+ */
+
+#ifndef MANGOS_H_OUTBOUNDSCHEDULER
+#define MANGOS_H_OUTBOUNDSCHEDULER
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "Common.h"
+#include "ObjectGuid.h"
+#include "WorldPacket.h"
+
+class WorldSocket;
+
+/// Priority classes of packets sent to a client, lower values go first.
+enum OutboundPriority
+{
+    OUTBOUND_PRIORITY_SELF          = 0,                    ///< own state and combat, never held back
+    OUTBOUND_PRIORITY_MOVEMENT      = 1,                    ///< movement of other units
+    OUTBOUND_PRIORITY_CREATE_NEAR   = 2,                    ///< object updates, creates and destroys near the player
+    OUTBOUND_PRIORITY_CREATE_FAR    = 3,                    ///< creates of objects far from the player
+    OUTBOUND_PRIORITY_CHAT          = 4                     ///< chat and channel messages
+};
+
+#define MAX_OUTBOUND_PRIORITY 5
+
+/// Keeps a client within Network.SessionBandwidth bytes per second.
+///
+/// While the session has budget left, every packet is sent at once. Once it is used up, packets
+/// are held back per priority class and sent from the session update as the budget refills,
+/// highest class first, so a burst of creates no longer delays the player's own combat and
+/// movement. Own packets are never held back, they only use up the budget.
+///
+/// The client must know an object before anything else about it arrives. Object updates queue
+/// behind the far creates held back, and a packet about an object whose create is held back, its
+/// moves, spells and attacks included, waits in the class of that create whatever its own class is.
+///
+/// The scheduler writes to the socket itself, under its lock, so a packet sent directly can't
+/// slip in between the held back packets being sent.
+class OutboundScheduler
+{
+    public:
+        OutboundScheduler();
+
+        /// Priority class of a packet sent without an explicit one.
+        static OutboundPriority GetPriority(uint16 opcode);
+
+        /// Send a packet now or hold it back.
+        /// @param socket socket of the session
+        /// @param packet packet to send
+        /// @param shared the same packet if it's already shared, held back packets are copied otherwise
+        /// @param priority priority class of the packet
+        /// @param subject the object the packet is about, empty if none or unknown
+        /// @param created the objects the packet creates, NULL if none
+        /// @return -1 if the socket failed
+        int Send(WorldSocket* socket, WorldPacket const& packet, SharedWorldPacket const* shared, OutboundPriority priority,
+                 ObjectGuid const& subject, GuidVector const* created);
+
+        /// Send the held back packets the refilled budget allows, in send order.
+        /// @return -1 if the socket failed
+        int SendDue(WorldSocket* socket);
+
+        /// Drop the held back packets about objects, the client forgets them on a map change or logout. Chat is kept.
+        void ClearObjectPackets();
+
+        /// True while a create of the object is held back.
+        bool IsCreatePending(ObjectGuid const& guid);
+
+        bool HasQueued() const { return m_queuedCount.value() != 0; }
+
+    private:
+        struct QueuedPacket
+        {
+            SharedWorldPacket packet;
+            GuidVector created;
+        };
+
+        void Refill(uint32 now);
+        void Dequeue(std::deque<QueuedPacket>& queue);
+
+        std::deque<QueuedPacket> m_queues[MAX_OUTBOUND_PRIORITY];
+        std::map<ObjectGuid, uint32> m_pendingCreates;     ///< held back creates per object
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_queuedCount;
+        int64 m_tokens;                                     ///< bytes that may be sent now, negative after own packets beyond the budget
+        uint32 m_lastRefill;
+        ACE_Thread_Mutex m_lock;
+};
+#endif
+/// @}
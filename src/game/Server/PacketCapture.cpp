@@ -0,0 +1,270 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "PacketCapture.h"
+#include "PacketCaptureFile.h"
+#include "WorldPacket.h"
+#include "ByteConverter.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+
+#include <ace/Guard_T.h>
+
+#include <ctime>
+
+INSTANTIATE_SINGLETON_1(PacketCapture);
+
+/// Appends a number to a capture buffer in little-endian order
+template<class T>
+static void PutCaptureValue(std::vector<uint8>& buffer, T value)
+{
+    EndianConvert(value);
+    uint8 const* bytes = reinterpret_cast<uint8 const*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+PacketCapture::PacketCapture() : m_active(false), m_lastSessionId(0), m_startTime(0), m_records(0), m_bytes(0),
+    m_dropped(0), m_file(NULL)
+{
+}
+
+PacketCapture::~PacketCapture()
+{
+    Stop();
+}
+
+void PacketCapture::LoadFromConfig()
+{
+    std::string fileName = sConfig.GetStringDefault("Network.CaptureFile", "");
+    if (!fileName.empty() && !IsActive())
+    {
+        Start(fileName);
+    }
+}
+
+void PacketCapture::Update()
+{
+    if (!IsActive())
+    {
+        return;
+    }
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_fileLock);
+    if (m_file)
+    {
+        Flush();
+    }
+}
+
+bool PacketCapture::Start(std::string const& fileName)
+{
+    Stop();
+
+    if (!IsValidFileName(fileName))
+    {
+        sLog.outError("PacketCapture: %s is not a plain file name, captures are only written to LogsDir.", fileName.c_str());
+        return false;
+    }
+
+    std::string path = sLog.GetLogsDir() + fileName;
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_fileLock, false);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        sLog.outError("PacketCapture: can't open %s for writing.", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8> header;
+    PutCaptureValue<uint32>(header, PACKET_CAPTURE_MAGIC);
+    PutCaptureValue<uint16>(header, PACKET_CAPTURE_VERSION);
+    PutCaptureValue<uint16>(header, 0);
+    PutCaptureValue<uint64>(header, uint64(time(NULL)));
+
+    if (fwrite(&header[0], 1, header.size(), file) != header.size())
+    {
+        sLog.outError("PacketCapture: can't write to %s.", path.c_str());
+        fclose(file);
+        return false;
+    }
+
+    m_file = file;
+    m_fileName = path;
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, bufferGuard, m_bufferLock, false);
+        m_buffer.clear();
+        m_startTime = getMSTime();
+        m_records = 0;
+        m_bytes = 0;
+        m_dropped = 0;
+        m_active.store(true, std::memory_order_relaxed);
+    }
+
+    sLog.outString("PacketCapture: capturing the received packets to %s.", path.c_str());
+    return true;
+}
+
+bool PacketCapture::IsValidFileName(std::string const& fileName)
+{
+    if (fileName.empty() || fileName == "." || fileName == "..")
+    {
+        return false;
+    }
+
+    // no directories, absolute paths or drive letters
+    return fileName.find_first_of("/\\:") == std::string::npos;
+}
+
+void PacketCapture::Stop()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_fileLock);
+
+    if (!m_file)
+    {
+        return;
+    }
+
+    uint64 records, dropped;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, bufferGuard, m_bufferLock);
+        m_active.store(false, std::memory_order_relaxed);
+        records = m_records;
+        dropped = m_dropped;
+    }
+
+    Flush();
+
+    fclose(m_file);
+    m_file = NULL;
+
+    sLog.outString("PacketCapture: stopped, " UI64FMTD " records written to %s, " UI64FMTD " dropped.",
+                   records, m_fileName.c_str(), dropped);
+}
+
+void PacketCapture::AddSessionOpen(uint32 session, uint32 build)
+{
+    if (!IsActive())
+    {
+        return;
+    }
+
+    std::vector<uint8> payload;
+    PutCaptureValue<uint32>(payload, build);
+    AddRecord(PACKET_CAPTURE_SESSION_OPEN, session, 0, &payload[0], payload.size());
+}
+
+void PacketCapture::AddPacket(uint32 session, WorldPacket const& packet)
+{
+    if (!IsActive())
+    {
+        return;
+    }
+
+    AddRecord(PACKET_CAPTURE_PACKET, session, packet.GetOpcode(), packet.empty() ? NULL : packet.contents(), packet.size());
+}
+
+void PacketCapture::AddSessionClose(uint32 session)
+{
+    if (!IsActive())
+    {
+        return;
+    }
+
+    AddRecord(PACKET_CAPTURE_SESSION_CLOSE, session, 0, NULL, 0);
+}
+
+bool PacketCapture::GetStats(Stats& stats) const
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_fileLock, false);
+
+    if (!m_file)
+    {
+        return false;
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, bufferGuard, m_bufferLock, false);
+
+    stats.fileName = m_fileName;
+    stats.seconds = getMSTimeDiff(m_startTime, getMSTime()) / IN_MILLISECONDS;
+    stats.records = m_records;
+    stats.bytes = m_bytes;
+    stats.dropped = m_dropped;
+    return true;
+}
+
+void PacketCapture::AddRecord(uint8 type, uint32 session, uint16 opcode, uint8 const* data, size_t size)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_bufferLock);
+
+    // stopped since the caller checked
+    if (!m_active.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // the world thread fell behind, keep the memory bounded
+    if (m_buffer.size() + PACKET_CAPTURE_RECORD_SIZE + size > PACKET_CAPTURE_MAX_BUFFER)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    PutCaptureValue<uint8>(m_buffer, type);
+    PutCaptureValue<uint32>(m_buffer, getMSTimeDiff(m_startTime, getMSTime()));
+    PutCaptureValue<uint32>(m_buffer, session);
+    PutCaptureValue<uint16>(m_buffer, opcode);
+    PutCaptureValue<uint16>(m_buffer, uint16(size));
+    if (size)
+    {
+        m_buffer.insert(m_buffer.end(), data, data + size);
+    }
+
+    ++m_records;
+    m_bytes += PACKET_CAPTURE_RECORD_SIZE + size;
+}
+
+/// Needs m_fileLock held and m_file open
+void PacketCapture::Flush()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_bufferLock);
+        m_buffer.swap(m_writeBuffer);
+    }
+
+    if (m_writeBuffer.empty())
+    {
+        return;
+    }
+
+    if (fwrite(&m_writeBuffer[0], 1, m_writeBuffer.size(), m_file) != m_writeBuffer.size())
+    {
+        sLog.outError("PacketCapture: can't write to %s.", m_fileName.c_str());
+    }
+
+    m_writeBuffer.clear();
+}
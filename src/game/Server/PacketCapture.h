@@ -0,0 +1,118 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/** \addtogroup u2w User to World Communication
+ *  @{
+ *  \file PacketCapture.h
+ */
+
+#ifndef MANGOS_H_PACKETCAPTURE
+#define MANGOS_H_PACKETCAPTURE
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Thread_Mutex.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class WorldPacket;
+
+/// Records buffered between two world ticks at most, further records are dropped
+#define PACKET_CAPTURE_MAX_BUFFER (16 * 1024 * 1024)
+
+/**
+ * @brief Writes the packets received from the clients to a binary capture file.
+ *
+ * The layout of the file is described in PacketCaptureFile.h, the load test tools replay it.
+ * The socket threads append records to a memory buffer, the world thread writes the buffer
+ * to the file once per tick, so capturing costs the sockets one copy of each packet.
+ * Started by Network.CaptureFile or the .server capture command.
+ */
+class PacketCapture
+{
+    public:
+        PacketCapture();
+        ~PacketCapture();
+
+        /// Starts the capture set by Network.CaptureFile unless one is running
+        void LoadFromConfig();
+        /// Writes the buffered records, called by World::Update
+        void Update();
+
+        /// @param fileName file in LogsDir, overwritten
+        bool Start(std::string const& fileName);
+        void Stop();
+
+        /// A plain file name, captures can't be written outside of LogsDir
+        static bool IsValidFileName(std::string const& fileName);
+
+        bool IsActive() const { return m_active.load(std::memory_order_relaxed); }
+
+        /// Number of a new connection for the capture records, given to every connection whether capturing or not
+        uint32 NewSessionId() { return m_lastSessionId.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+        void AddSessionOpen(uint32 session, uint32 build);
+        void AddPacket(uint32 session, WorldPacket const& packet);
+        void AddSessionClose(uint32 session);
+
+        struct Stats
+        {
+            std::string fileName;
+            uint32 seconds;
+            uint64 records;
+            uint64 bytes;
+            uint64 dropped;
+        };
+
+        /// @return false when no capture is running
+        bool GetStats(Stats& stats) const;
+
+    private:
+        void AddRecord(uint8 type, uint32 session, uint16 opcode, uint8 const* data, size_t size);
+        void Flush();
+
+        std::atomic<bool> m_active;
+        std::atomic<uint32> m_lastSessionId;
+
+        mutable ACE_Thread_Mutex m_bufferLock;              // guards m_buffer and the counters
+        std::vector<uint8> m_buffer;
+        uint32 m_startTime;                                 // getMSTime() of the start, record times are relative to it
+        uint64 m_records;
+        uint64 m_bytes;
+        uint64 m_dropped;
+
+        mutable ACE_Thread_Mutex m_fileLock;                // guards the file, taken before m_bufferLock
+        std::vector<uint8> m_writeBuffer;
+        FILE* m_file;
+        std::string m_fileName;
+};
+
+#define sPacketCapture MaNGOS::Singleton<PacketCapture>::Instance()
+
+#endif
+/// @}
@@ -0,0 +1,163 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "PacketCompressor.h"
+#include "WorldSocket.h"
+#include "WorldPacket.h"
+#include "UpdateData.h"
+
+#include <ace/Guard_T.h>
+
+INSTANTIATE_SINGLETON_1(PacketCompressor);
+
+PacketCompressor::PacketCompressor() : m_activated(false), m_shutdown(false), m_mutex(), m_jobAvailable(m_mutex)
+{
+}
+
+PacketCompressor::~PacketCompressor()
+{
+    deactivate();
+}
+
+void PacketCompressor::Compress(WorldSocket* socket, WorldPacket* packet)
+{
+    Enqueue(socket, packet, true);
+}
+
+void PacketCompressor::Forward(WorldSocket* socket, WorldPacket* packet)
+{
+    Enqueue(socket, packet, false);
+}
+
+void PacketCompressor::Enqueue(WorldSocket* socket, WorldPacket* packet, bool compress)
+{
+    // keep the socket alive and route its other packets through here until this one is sent
+    socket->AddReference();
+    ++socket->m_PendingCompressions;
+
+    Job job;
+    job.socket = socket;
+    job.packet = packet;
+    job.compress = compress;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    if (m_shutdown)
+    {
+        Release(job);
+        return;
+    }
+
+    m_jobs.push_back(job);
+    m_jobAvailable.signal();
+}
+
+void PacketCompressor::Release(Job const& job)
+{
+    delete job.packet;
+    --job.socket->m_PendingCompressions;
+    job.socket->RemoveReference();
+}
+
+int PacketCompressor::activate()
+{
+    if (m_activated)
+    {
+        return -1;
+    }
+
+    m_shutdown = false;
+
+    // a single thread, the packets of a socket have to leave in the order they came in
+    if (ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 1) == -1)
+    {
+        return -1;
+    }
+
+    m_activated = true;
+    return 0;
+}
+
+int PacketCompressor::deactivate()
+{
+    if (!m_activated)
+    {
+        return -1;
+    }
+
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+        m_shutdown = true;
+
+        for (std::deque<Job>::const_iterator itr = m_jobs.begin(); itr != m_jobs.end(); ++itr)
+        {
+            Release(*itr);
+        }
+        m_jobs.clear();
+
+        m_jobAvailable.broadcast();
+    }
+
+    ACE_Task_Base::wait();
+
+    m_activated = false;
+    return 0;
+}
+
+int PacketCompressor::svc()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_mutex, -1);
+
+            while (m_jobs.empty() && !m_shutdown)
+                m_jobAvailable.wait();
+
+            if (m_shutdown)
+            {
+                break;
+            }
+
+            job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        if (!job.compress || UpdateData::CompressPacket(job.packet))
+        {
+            // the socket takes the packet over
+            if (job.socket->SendPacketNow(job.packet) == -1)
+            {
+                job.socket->CloseSocket();
+            }
+
+            job.packet = NULL;
+        }
+
+        Release(job);
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/** \addtogroup u2w User to World Communication
+ *  @{
+ *  \file PacketCompressor.h
+ */
+
+#ifndef MANGOS_H_PACKETCOMPRESSOR
+#define MANGOS_H_PACKETCOMPRESSOR
+
+#include <ace/Task.h>
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include <deque>
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+class WorldSocket;
+class WorldPacket;
+
+/// Worker compressing large update packets outside of the map update.
+///
+/// Packets are handed over together with their socket and sent from the worker once
+/// they are compressed. While a socket has packets in the worker, everything else sent
+/// on it is routed through the worker as well, so the client gets them in order.
+class PacketCompressor : protected ACE_Task_Base
+{
+    public:
+        PacketCompressor();
+        virtual ~PacketCompressor();
+
+        /// Queue an uncompressed SMSG_UPDATE_OBJECT, it is compressed and sent by the worker.
+        /// @param socket socket to send the packet on, referenced until it is sent
+        /// @param packet packet to compress, owned by the worker from now on
+        void Compress(WorldSocket* socket, WorldPacket* packet);
+
+        /// Queue a packet to be sent as it is, behind the packets of the socket already queued.
+        /// @param socket socket to send the packet on, referenced until it is sent
+        /// @param packet packet to send, owned by the worker from now on
+        void Forward(WorldSocket* socket, WorldPacket* packet);
+
+        /// Start the worker thread.
+        int activate();
+
+        /// Stop the worker thread, queued packets are dropped.
+        int deactivate();
+
+        bool activated() const { return m_activated; }
+
+    protected:
+        virtual int svc();
+
+    private:
+        struct Job
+        {
+            WorldSocket* socket;
+            WorldPacket* packet;
+            bool compress;
+        };
+
+        void Enqueue(WorldSocket* socket, WorldPacket* packet, bool compress);
+        static void Release(Job const& job);
+
+        std::deque<Job> m_jobs;
+        bool m_activated;
+        bool m_shutdown;
+
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_jobAvailable;
+};
+
+#define sPacketCompressor MaNGOS::Singleton<PacketCompressor>::Instance()
+
+#endif
+/// @}
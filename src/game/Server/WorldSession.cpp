@@ -33,6 +33,9 @@
 #include "Opcodes.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
+#include "PacketCompressor.h"
+#include "OpcodeProfiler.h"
+#include "UpdateData.h"
 #include "Player.h"
 #include "ObjectMgr.h"
 #include "Group.h"
@@ -57,6 +60,8 @@
 #include "WardenWin.h"
 #include "WardenMac.h"
 
+#include <ace/OS_NS_sys_time.h>
+
 // select opcodes appropriate for processing in Map::Update context for current session state
 static bool MapSessionFilterHelper(WorldSession* session, OpcodeHandler const& opHandle)
 {
@@ -111,7 +116,8 @@ WorldSession::WorldSession(uint32 id, WorldSocket* sock, AccountTypes sec, time_
     _player(NULL), m_Socket(sock), _security(sec), _accountId(id), _warden(NULL), _build(0), _logoutTime(0),
     m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
     m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
-    m_latency(0), m_clientTimeDelay(0), m_tutorialState(TUTORIALDATA_UNCHANGED)
+    m_latency(0), m_clientTimeDelay(0), m_tutorialState(TUTORIALDATA_UNCHANGED),
+    m_moveHeartbeatCount(0)
 {
     if (sock)
     {
@@ -147,7 +153,7 @@ WorldSession::~WorldSession()
     WorldPacket* packet = NULL;
     while (_recvQueue.next(packet))
     {
-        delete packet;
+        ReleaseRecvPacket(packet);
     }
 }
 
@@ -165,6 +171,12 @@ char const* WorldSession::GetPlayerName() const
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const* packet)
+{
+    SendPacket(packet, OutboundScheduler::GetPriority(packet->GetOpcode()));
+}
+
+/// Send a packet to the client, it may be held back behind higher priority classes by the bandwidth budget
+void WorldSession::SendPacket(WorldPacket const* packet, OutboundPriority priority, ObjectGuid const& subject /*= ObjectGuid()*/, GuidVector const* created /*= NULL*/)
 {
 #ifdef ENABLE_PLAYERBOTS
     if (GetPlayer()) {
@@ -226,12 +238,199 @@ void WorldSession::SendPacket(WorldPacket const* packet)
 
 #endif                                                  // !MANGOS_DEBUG
 
-    if (m_Socket->SendPacket(*packet) == -1)
+    if (m_outbound.Send(m_Socket, *packet, NULL, priority, subject, created) == -1)
     {
         m_Socket->CloseSocket();
     }
 }
 
+/// Send a packet shared with other sessions to the client
+void WorldSession::SendPacket(SharedWorldPacket const& packet, ObjectGuid const& subject /*= ObjectGuid()*/)
+{
+#ifdef ENABLE_PLAYERBOTS
+    if (GetPlayer()) {
+        if (GetPlayer()->GetPlayerbotAI())
+        {
+            GetPlayer()->GetPlayerbotAI()->HandleBotOutgoingPacket(*packet);
+        }
+        else if (GetPlayer()->GetPlayerbotMgr())
+        {
+            GetPlayer()->GetPlayerbotMgr()->HandleMasterOutgoingPacket(*packet);
+        }
+    }
+#endif
+
+    if (!m_Socket)
+    {
+        return;
+    }
+
+    if (opcodeTable[packet->GetOpcode()].status == STATUS_UNHANDLED)
+    {
+        sLog.outError("SESSION: tried to send an unhandled opcode 0x%.4X", packet->GetOpcode());
+        return;
+    }
+
+    if (m_outbound.Send(m_Socket, *packet, &packet, OutboundScheduler::GetPriority(packet->GetOpcode()), subject, NULL) == -1)
+    {
+        m_Socket->CloseSocket();
+    }
+}
+
+SharedPacketSender::SharedPacketSender(WorldPacket const* packet, ObjectGuid const& subject /*= ObjectGuid()*/) : m_packet(packet), m_subject(subject), m_sent(false),
+    m_coalesce(sWorld.getConfig(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW) && packet->size() <= MOVEMENT_COALESCE_MAX_PAYLOAD &&
+               MovementCoalescer::IsCoalescable(packet->GetOpcode()))
+{
+}
+
+void SharedPacketSender::SendTo(WorldSession* session)
+{
+    if (m_coalesce)
+    {
+        session->SendMovementPacket(m_packet, m_subject);
+        return;
+    }
+
+    // a single receiver or a tiny payload is cheaper to copy
+    if (!m_sent || m_packet->size() < SHARED_PACKET_MIN_SIZE)
+    {
+        m_sent = true;
+        session->SendPacket(m_packet, OutboundScheduler::GetPriority(m_packet->GetOpcode()), m_subject);
+        return;
+    }
+
+    if (!m_shared)
+    {
+        m_shared = std::make_shared<WorldPacket const>(*m_packet);
+    }
+
+    session->SendPacket(m_shared, m_subject);
+}
+
+/// Send an update object packet, large ones are left to the packet compressor if enabled
+///
+/// Creates are sent this way, so the collected moves are flushed first. Value updates sent by
+/// Map::SendObjectUpdates() and Object::SendForcedObjectUpdate() are not: they only concern
+/// objects the client already knows, so the moves can still wait for their window.
+void WorldSession::SendUpdateData(UpdateData& data, bool hasTransport /*= false*/, OutboundPriority priority /*= OUTBOUND_PRIORITY_CREATE_NEAR*/)
+{
+    // the lock is held until the creates are sent or held back, so a move of a created unit
+    // arriving meanwhile from another update region sees them pending and waits behind them
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_moveCoalescerLock);
+
+    // creates go out before the moves of the created units
+    WorldPacket moves;
+    if (m_moveCoalescer.Flush(moves))
+    {
+        SendPacket(&moves);
+    }
+
+    // the compressor writes to the socket directly, which would pass the packets held back by the budget
+    if (m_Socket && sPacketCompressor.activated() && !sWorld.getConfig(CONFIG_UINT32_SESSION_BANDWIDTH) && !m_outbound.HasQueued() &&
+        uint32(data.GetBuffer().wpos()) >= sWorld.getConfig(CONFIG_UINT32_COMPRESSION_ASYNC_MIN_SIZE))
+    {
+        WorldPacket* packet = new WorldPacket;
+        data.BuildPacket(packet, hasTransport, false);
+        sPacketCompressor.Compress(m_Socket, packet);
+        return;
+    }
+
+    WorldPacket packet;
+    if (data.BuildPacket(&packet, hasTransport))
+    {
+        SendPacket(&packet, priority, ObjectGuid(), &data.GetCreatedGUIDs());
+    }
+}
+
+/// Send the packets held back by the bandwidth budget as far as it refilled
+void WorldSession::SendScheduledPackets()
+{
+    if (m_outbound.SendDue(m_Socket) == -1)
+    {
+        m_Socket->CloseSocket();
+    }
+}
+
+/// Send a movement packet of another unit, collected with others while Network.MovementCoalesceWindow is set
+void WorldSession::SendMovementPacket(WorldPacket const* packet, ObjectGuid const& mover /*= ObjectGuid()*/)
+{
+    bool coalesce = m_Socket && sWorld.getConfig(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW) &&
+                    packet->size() <= MOVEMENT_COALESCE_MAX_PAYLOAD && MovementCoalescer::IsCoalescable(packet->GetOpcode());
+
+#ifdef ENABLE_PLAYERBOTS
+    // bots and their masters inspect the moves one by one
+    if (GetPlayer() && (GetPlayer()->GetPlayerbotAI() || GetPlayer()->GetPlayerbotMgr()))
+    {
+        coalesce = false;
+    }
+#endif
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_moveCoalescerLock);
+
+    // a unit whose create is held back by the budget moves behind the create, not with the others
+    if (coalesce && !mover.IsEmpty() && m_outbound.IsCreatePending(mover))
+    {
+        coalesce = false;
+    }
+
+    if (!coalesce)
+    {
+        // keep the order with the moves already collected
+        if (!m_moveCoalescer.IsEmpty())
+        {
+            WorldPacket moves;
+            if (m_moveCoalescer.Flush(moves))
+            {
+                SendPacket(&moves);
+            }
+        }
+
+        SendPacket(packet, OutboundScheduler::GetPriority(packet->GetOpcode()), mover);
+        return;
+    }
+
+    m_moveCoalescer.Add(*packet, getMSTime());
+
+    if (m_moveCoalescer.IsFull())
+    {
+        WorldPacket moves;
+        if (m_moveCoalescer.Flush(moves))
+        {
+            SendPacket(&moves);
+        }
+    }
+}
+
+/// Send the collected movement packets, unless forced only once the coalesce window has passed
+void WorldSession::FlushMovementPackets(bool force /*= false*/)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_moveCoalescerLock);
+
+    if (m_moveCoalescer.IsEmpty())
+    {
+        return;
+    }
+
+    if (!force && !m_moveCoalescer.IsDue(getMSTime(), sWorld.getConfig(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW)))
+    {
+        return;
+    }
+
+    WorldPacket moves;
+    if (m_moveCoalescer.Flush(moves))
+    {
+        SendPacket(&moves);
+    }
+}
+
+/// Drop the collected movement packets and the object packets held back by the budget, the objects they are about are gone for the client after a map change or logout
+void WorldSession::ClearObjectPackets()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_moveCoalescerLock);
+    m_moveCoalescer.Clear();
+    m_outbound.ClearObjectPackets();
+}
+
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(WorldPacket* new_packet)
 {
@@ -256,6 +455,19 @@ void WorldSession::LogUnprocessedTail(WorldPacket* packet)
                   packet->rpos(), packet->wpos());
 }
 
+/// Hands a handled packet back to the socket for its next packet, packets without one are deleted
+void WorldSession::ReleaseRecvPacket(WorldPacket* packet)
+{
+    if (m_Socket)
+    {
+        m_Socket->ReleaseRecvPacket(packet);
+    }
+    else
+    {
+        delete packet;
+    }
+}
+
 /// Update the WorldSession (triggered by World update)
 bool WorldSession::Update(PacketFilter& updater)
 {
@@ -373,7 +585,7 @@ bool WorldSession::Update(PacketFilter& updater)
             }
         }
 
-        delete packet;
+        ReleaseRecvPacket(packet);
     }
 
 #ifdef ENABLE_PLAYERBOTS
@@ -390,6 +602,12 @@ bool WorldSession::Update(PacketFilter& updater)
         m_Socket = NULL;
     }
 
+    // send what the bandwidth budget held back, once per world update
+    if (m_Socket && updater.ProcessLogout())
+    {
+        SendScheduledPackets();
+    }
+
     // Warden
     if (m_Socket && !m_Socket->IsClosed() && _warden)
     {
@@ -430,7 +648,7 @@ void WorldSession::HandleBotPackets()
     {
         OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
         (this->*opHandle.handler)(*packet);
-        delete packet;
+        ReleaseRecvPacket(packet);
     }
 }
 #endif
@@ -701,6 +919,8 @@ void WorldSession::LogoutPlayer(bool Save)
 
         SetPlayer(NULL);                                    // deleted in Remove/DeleteFromWorld call
 
+        ClearObjectPackets();
+
         ///- Send the 'logout complete' packet to the client
         WorldPacket data(SMSG_LOGOUT_COMPLETE, 0);
         SendPacket(&data);
@@ -957,8 +1177,14 @@ void WorldSession::ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* pac
         _player->SetCanDelayTeleport(true);
     }
 
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+
     (this->*opHandle.handler)(*packet);
 
+    ACE_UINT64 elapsed;
+    (ACE_OS::gettimeofday() - start).to_usec(elapsed);
+    sOpcodeProfiler.AddInbound(packet->GetOpcode(), opHandle.packetProcessing, packet->size(), uint32(elapsed));
+
     if (_player)
     {
         // can be not set in fact for login opcode, but this not create porblems.
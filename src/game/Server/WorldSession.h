@@ -33,6 +33,9 @@
 #include "Auth/BigNumber.h"
 #include "SharedDefines.h"
 #include "ObjectGuid.h"
+#include "WorldPacket.h"
+#include "MovementCoalescer.h"
+#include "OutboundScheduler.h"
 #include "AuctionHouseMgr.h"
 #include "Item.h"
 
@@ -42,13 +45,13 @@ struct AuctionHouseEntry;
 struct TradeStatusInfo;
 
 class ObjectGuid;
+class UpdateData;
 class Creature;
 class Item;
 class Object;
 class Player;
 class Unit;
 class Warden;
-class WorldPacket;
 class WorldSocket;
 class QueryResult;
 class LoginQueryHolder;
@@ -157,6 +160,12 @@ class WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const* packet);
+        void SendPacket(WorldPacket const* packet, OutboundPriority priority, ObjectGuid const& subject = ObjectGuid(), GuidVector const* created = NULL);
+        void SendPacket(SharedWorldPacket const& packet, ObjectGuid const& subject = ObjectGuid());
+        void SendUpdateData(UpdateData& data, bool hasTransport = false, OutboundPriority priority = OUTBOUND_PRIORITY_CREATE_NEAR);
+        void SendMovementPacket(WorldPacket const* packet, ObjectGuid const& mover = ObjectGuid());
+        void FlushMovementPackets(bool force = false);
+        void ClearObjectPackets();
         void SendNotification(const char* format, ...) ATTR_PRINTF(2, 3);
         void SendNotification(int32 string_id, ...);
         void SendPetNameInvalid(uint32 error, const std::string& name);
@@ -744,11 +753,14 @@ class WorldSession
         void HandleMoverRelocation(MovementInfo& movementInfo);
 
         void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket* packet);
+        void ReleaseRecvPacket(WorldPacket* packet);
 
         // logging helper
         void LogUnexpectedOpcode(WorldPacket* packet, const char* reason);
         void LogUnprocessedTail(WorldPacket* packet);
 
+        void SendScheduledPackets();
+
         Player* _player;
         WorldSocket* m_Socket;
         std::string m_Address;
@@ -772,7 +784,31 @@ class WorldSession
         uint32 m_Tutorials[8];
         TutorialDataState m_tutorialState;
         uint32 m_clientTimeDelay;
-        ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+        uint32 m_moveHeartbeatCount;                        // heartbeats relayed, every Visibility.LodInterval-th one reaches far viewers
+        ACE_Based::MPSCQueue<WorldPacket*> _recvQueue;
+
+        // movement of other units waiting for the coalesce window, filled from any update region of the map
+        MovementCoalescer m_moveCoalescer;
+        ACE_Thread_Mutex m_moveCoalescerLock;
+
+        OutboundScheduler m_outbound;                       // holds packets back once Network.SessionBandwidth is used up
+};
+
+// sends one packet to many sessions, from the second receiver on the payload is shared instead of copied
+class SharedPacketSender
+{
+    public:
+        /// @param subject the object the packet is about, it waits for a held back create of it
+        explicit SharedPacketSender(WorldPacket const* packet, ObjectGuid const& subject = ObjectGuid());
+
+        void SendTo(WorldSession* session);
+
+    private:
+        WorldPacket const* m_packet;
+        ObjectGuid m_subject;
+        SharedWorldPacket m_shared;
+        bool m_sent;
+        bool m_coalesce;                                    // movement packet collected per session instead
 };
 #endif
 /// @}
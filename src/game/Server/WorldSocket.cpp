@@ -31,7 +31,9 @@
 #include <ace/os_include/sys/os_socket.h>
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
-#include <ace/Auto_Ptr.h>
+#include <ace/OS_NS_sys_socket.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_sys_uio.h>
 
 #include "WorldSocket.h"
 #include "Common.h"
@@ -51,6 +53,9 @@
 #include "Auth/Sha1.h"
 #include "WorldSession.h"
 #include "WorldSocketMgr.h"
+#include "PacketCompressor.h"
+#include "OpcodeProfiler.h"
+#include "PacketCapture.h"
 #include "Log.h"
 #include "DBCStores.h"
 #ifdef ENABLE_ELUNA
@@ -81,39 +86,74 @@ struct ClientPktHeader
 #pragma pack(pop)
 #endif
 
+/// pieces written by one handle_output() call at most
+#define WORLDSOCKET_MAX_IOV 256
+
+/// size of the receive buffer, must hold the largest client packet (10240 + 2 bytes)
+#define WORLDSOCKET_RECV_BUFFER_SIZE 16384
+/// the unparsed data is moved to the front of the receive buffer when less space is left
+#define WORLDSOCKET_RECV_MIN_SPACE 4096
+/// recv() calls made by one handle_input() call at most, so other sockets of the reactor get their turn
+#define WORLDSOCKET_MAX_RECV_ROUNDS 8
+/// written payload copies a socket keeps for its next packets
+#define WORLDSOCKET_MAX_FREE_PACKETS 32
+/// handled received packets a socket keeps for its next packets
+#define WORLDSOCKET_MAX_FREE_RECV_PACKETS 32
+/// packets with a larger payload are deleted instead of being kept, so a socket does not pin big buffers
+#define WORLDSOCKET_MAX_FREE_PACKET_SIZE 1024
+
+/// Hands a received packet back to its socket unless it was passed on to the session.
+class PooledPacketGuard
+{
+    public:
+        PooledPacketGuard(WorldSocket* socket, WorldPacket* packet) : m_socket(socket), m_packet(packet) {}
+        ~PooledPacketGuard() { m_socket->ReleaseRecvPacket(m_packet); }
+
+        void release() { m_packet = NULL; }
+
+    private:
+        WorldSocket* m_socket;
+        WorldPacket* m_packet;
+};
+
 WorldSocket::WorldSocket(void) :
     WorldHandler(),
     m_LastPingTime(ACE_Time_Value::zero),
     m_OverSpeedPings(0),
     m_Session(0),
-    m_RecvWPct(0),
-    m_RecvPct(),
-    m_Header(sizeof(ClientPktHeader)),
+    m_RecvBuffer(WORLDSOCKET_RECV_BUFFER_SIZE),
+    m_RecvHeaderReady(false),
+    m_RecvSize(0),
+    m_RecvCmd(0),
     m_OutBufferLock(),
-    m_OutBuffer(0),
-    m_OutBufferSize(65536),
-    m_Seed(rand32())
+    m_Seed(rand32()),
+    m_PendingCompressions(0),
+    m_CaptureSession(sPacketCapture.NewSessionId())
 {
     reference_counting_policy().value(ACE_Event_Handler::Reference_Counting_Policy::ENABLED);
 }
 
 WorldSocket::~WorldSocket(void)
 {
-    delete m_RecvWPct;
+    closing_ = true;
 
-    if (m_OutBuffer)
+    sPacketCapture.AddSessionClose(m_CaptureSession);
+
+    peer().close();
+
+    for (std::deque<OutboundPacket>::const_iterator itr = m_OutQueue.begin(); itr != m_OutQueue.end(); ++itr)
     {
-        m_OutBuffer->release();
+        delete itr->owned;
     }
 
-    closing_ = true;
-
-    peer().close();
+    for (std::vector<WorldPacket*>::const_iterator itr = m_FreePackets.begin(); itr != m_FreePackets.end(); ++itr)
+    {
+        delete *itr;
+    }
 
-    WorldPacket* pct;
-    while (m_PacketQueue.dequeue_head(pct) == 0)
+    for (std::vector<WorldPacket*>::const_iterator itr = m_FreeRecvPackets.begin(); itr != m_FreeRecvPackets.end(); ++itr)
     {
-        delete pct;
+        delete *itr;
     }
 }
 
@@ -144,6 +184,30 @@ const std::string& WorldSocket::GetRemoteAddress(void) const
 
 int WorldSocket::SendPacket(const WorldPacket& pkt)
 {
+    if (m_PendingCompressions.value() > 0)
+    {
+        if (closing_)
+        {
+            return -1;
+        }
+
+        WorldPacket* npct;
+        ACE_NEW_RETURN(npct, WorldPacket(pkt), -1);
+        sPacketCompressor.Forward(this, npct);
+        return 0;
+    }
+
+    return SendPacketNow(pkt);
+}
+
+int WorldSocket::SendPacket(const SharedWorldPacket& pkt)
+{
+    // packets waiting in the compressor go first, the forwarded copy queues up behind them
+    if (m_PendingCompressions.value() > 0 || pkt->size() < SHARED_PACKET_MIN_SIZE)
+    {
+        return SendPacket(*pkt);
+    }
+
     ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
 
     if (closing_)
@@ -151,31 +215,53 @@ int WorldSocket::SendPacket(const WorldPacket& pkt)
         return -1;
     }
 
-    WorldPacket pct = pkt;
+    return iQueuePacket(NULL, pkt);
+}
 
-    if (iSendPacket(pct) == -1)
+int WorldSocket::SendPacketNow(const WorldPacket& pkt)
+{
+    // reuse a payload copy this socket has written already, a global pool would make every
+    // map thread and network thread meet at its lock
+    WorldPacket* pct = NULL;
     {
-        WorldPacket* npct;
-
-        ACE_NEW_RETURN(npct, WorldPacket(pct), -1);
+        ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
 
-        // NOTE maybe check of the size of the queue can be good ?
-        // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail(npct) == -1)
+        if (!m_FreePackets.empty())
         {
-            delete npct;
-            sLog.outError("WorldSocket::SendPacket: m_PacketQueue.enqueue_tail failed");
-            return -1;
+            pct = m_FreePackets.back();
+            m_FreePackets.pop_back();
         }
     }
 
-    if (reactor()->schedule_wakeup(this, ACE_Event_Handler::WRITE_MASK) == -1)
+    // copy without holding the lock, the copy is the only one made of the payload
+    if (pct)
     {
-        sLog.outError("SendPacket failed setting WRITE mask, peer = %s", GetRemoteAddress().c_str());
+        pct->Initialize(pkt.GetOpcode(), pkt.size());
+    }
+    else
+    {
+        pct = new WorldPacket(pkt.GetOpcode(), pkt.size());
+    }
+
+    if (!pkt.empty())
+    {
+        pct->append(pkt.contents(), pkt.size());
+    }
+
+    return SendPacketNow(pct);
+}
+
+int WorldSocket::SendPacketNow(WorldPacket* pct)
+{
+    ACE_GUARD_RETURN(LockType, Guard, m_OutBufferLock, -1);
+
+    if (closing_)
+    {
+        iReleasePacket(pct);
         return -1;
     }
 
-    return 0;
+    return iQueuePacket(pct, SharedWorldPacket());
 }
 
 long WorldSocket::AddReference(void)
@@ -193,7 +279,7 @@ int WorldSocket::open(void* a)
     ACE_UNUSED_ARG(a);
 
     // Prevent double call to this func.
-    if (m_OutBuffer)
+    if (!m_Address.empty())
     {
         return -1;
     }
@@ -204,9 +290,6 @@ int WorldSocket::open(void* a)
         return -1;
     }
 
-    // Allocate the buffer.
-    ACE_NEW_RETURN(m_OutBuffer, ACE_Message_Block(m_OutBufferSize), -1);
-
     // Store peer address.
     ACE_INET_Addr remote_addr;
 
@@ -253,25 +336,55 @@ int WorldSocket::handle_input(ACE_HANDLE)
         return -1;
     }
 
-    switch (handle_input_missing_data())
+    for (int round = 0; round < WORLDSOCKET_MAX_RECV_ROUNDS; ++round)
     {
-        case -1 :
+        // make room behind the partial packet left over by the last call
+        if (m_RecvBuffer.length() == 0)
+        {
+            m_RecvBuffer.reset();
+        }
+        else if (m_RecvBuffer.space() < WORLDSOCKET_RECV_MIN_SPACE)
+        {
+            m_RecvBuffer.crunch();
+        }
+
+        const size_t recv_size = m_RecvBuffer.space();
+
+        const ssize_t n = peer().recv(m_RecvBuffer.wr_ptr(), recv_size);
+
+        if (n == 0)
+        {
+            errno = ECONNRESET;
+            return -1;
+        }
+
+        if (n < 0)
         {
             if ((errno == EWOULDBLOCK) || (errno == EAGAIN))
             {
                 return 0;
             }
+
+            return -1;
         }
-        case 0:
+
+        m_RecvBuffer.wr_ptr(n);
+
+        if (ProcessReceived() == -1)
         {
-            errno = ECONNRESET;
+            MANGOS_ASSERT((errno != EWOULDBLOCK) && (errno != EAGAIN));
             return -1;
         }
-        default:
-            return 0;
+
+        // the socket is drained
+        if (size_t(n) < recv_size)
+        {
+            break;
+        }
     }
 
-    ACE_NOTREACHED(return -1);
+    // data still waiting is reported by the reactor again
+    return 0;
 }
 
 int WorldSocket::handle_output(ACE_HANDLE)
@@ -283,18 +396,49 @@ int WorldSocket::handle_output(ACE_HANDLE)
         return -1;
     }
 
-    const size_t send_len = m_OutBuffer->length();
-
-    if (send_len == 0)
+    if (m_OutQueue.empty())
     {
         reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK);
         return 0;
     }
 
+    // the header and payload of every queued packet, the first one possibly partly written
+    iovec iov[WORLDSOCKET_MAX_IOV];
+    int iovcnt = 0;
+
+    for (std::deque<OutboundPacket>::const_iterator itr = m_OutQueue.begin();
+         itr != m_OutQueue.end() && iovcnt + 2 <= WORLDSOCKET_MAX_IOV; ++itr)
+    {
+        size_t sent = itr->sent;
+        if (sent < sizeof(itr->header))
+        {
+            iov[iovcnt].iov_base = (char*)itr->header + sent;
+            iov[iovcnt].iov_len = sizeof(itr->header) - sent;
+            ++iovcnt;
+            sent = 0;
+        }
+        else
+        {
+            sent -= sizeof(itr->header);
+        }
+
+        WorldPacket const* payload = itr->Payload();
+        if (payload->size() > sent)
+        {
+            iov[iovcnt].iov_base = (char*)payload->contents() + sent;
+            iov[iovcnt].iov_len = payload->size() - sent;
+            ++iovcnt;
+        }
+    }
+
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+    msghdr msg;
+    ACE_OS::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    ssize_t n = ACE_OS::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len);
+    ssize_t n = peer().sendv(iov, iovcnt);
 #endif // MSG_NOSIGNAL
 
     if (n == 0)
@@ -305,33 +449,37 @@ int WorldSocket::handle_output(ACE_HANDLE)
     else if (n == -1)
     {
         if (errno == EWOULDBLOCK || errno == EAGAIN)
-            {
+        {
             return 0;
-            }
+        }
 
         return -1;
     }
-    else if (n < (ssize_t)send_len) // now n > 0
-    {
-        m_OutBuffer->rd_ptr(static_cast<size_t>(n));
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
-
-        return 0;
-    }
-    else // now n == send_len
+    // drop the packets written completely
+    size_t left = static_cast<size_t>(n);
+    while (left > 0)
     {
-        m_OutBuffer->reset();
+        OutboundPacket& front = m_OutQueue.front();
+        size_t total = sizeof(front.header) + front.Payload()->size();
+        size_t chunk = std::min(left, total - front.sent);
+        front.sent += chunk;
+        left -= chunk;
 
-        if(!iFlushPacketQueue()) //no more packets in queue
+        if (front.sent == total)
         {
-            reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK);
+            iReleasePacket(front.owned);
+            m_OutQueue.pop_front();
         }
-        return 0;
     }
 
-    ACE_NOTREACHED(return 0);
+    // the rest is written when the socket is writable again
+    if (m_OutQueue.empty())
+    {
+        reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK);
+    }
+
+    return 0;
 }
 
 int WorldSocket::handle_close(ACE_HANDLE h, ACE_Reactor_Mask)
@@ -354,159 +502,61 @@ int WorldSocket::handle_close(ACE_HANDLE h, ACE_Reactor_Mask)
 }
 
 
-int WorldSocket::handle_input_header(void)
-{
-    MANGOS_ASSERT(m_RecvWPct == NULL);
-
-    MANGOS_ASSERT(m_Header.length() == sizeof(ClientPktHeader));
-
-    m_Crypt.DecryptRecv((uint8*) m_Header.rd_ptr(), sizeof(ClientPktHeader));
-
-    ClientPktHeader& header = *((ClientPktHeader*) m_Header.rd_ptr());
-
-    EndianConvertReverse(header.size);
-    EndianConvert(header.cmd);
-
-    if ((header.size < 4) || (header.size > 10240) || (header.cmd  > 10240))
-    {
-        sLog.outError("WorldSocket::handle_input_header: client sent malformed packet size = %d , cmd = %d",
-                      header.size, header.cmd);
-
-        errno = EINVAL;
-        return -1;
-    }
-
-    header.size -= 4;
-
-    ACE_NEW_RETURN(m_RecvWPct, WorldPacket((uint16)header.cmd, header.size), -1);
-
-    if (header.size > 0)
-    {
-        m_RecvWPct->resize(header.size);
-        m_RecvPct.base((char*) m_RecvWPct->contents(), m_RecvWPct->size());
-    }
-    else
-    {
-        MANGOS_ASSERT(m_RecvPct.space() == 0);
-    }
-
-    return 0;
-}
-
-int WorldSocket::handle_input_payload(void)
+int WorldSocket::ProcessReceived(void)
 {
-    // set errno properly here on error !!!
-    // now have a header and payload
-
-    MANGOS_ASSERT(m_RecvPct.space() == 0);
-    MANGOS_ASSERT(m_Header.space() == 0);
-    MANGOS_ASSERT(m_RecvWPct != NULL);
-
-    const int ret = ProcessIncoming(m_RecvWPct);
-
-    m_RecvPct.base(NULL, 0);
-    m_RecvPct.reset();
-    m_RecvWPct = NULL;
-
-    m_Header.reset();
-
-    if (ret == -1)
+    while (true)
     {
-        errno = EINVAL;
-    }
-
-    return ret;
-}
-
-int WorldSocket::handle_input_missing_data(void)
-{
-    char buf [4096];
-
-    ACE_Data_Block db(sizeof(buf),
-                      ACE_Message_Block::MB_DATA,
-                      buf,
-                      0,
-                      0,
-                      ACE_Message_Block::DONT_DELETE,
-                      0);
-
-    ACE_Message_Block message_block(&db,
-                                    ACE_Message_Block::DONT_DELETE,
-                                    0);
-
-    const size_t recv_size = message_block.space();
-
-    const ssize_t n = peer().recv(message_block.wr_ptr(),
-                                  recv_size);
+        if (!m_RecvHeaderReady)
+        {
+            if (m_RecvBuffer.length() < sizeof(ClientPktHeader))
+            {
+                return 0;
+            }
 
-    if (n <= 0)
-    {
-        return (int)n;
-    }
+            // the header stays in the buffer until its packet is complete, decrypt it only once
+            m_Crypt.DecryptRecv((uint8*) m_RecvBuffer.rd_ptr(), sizeof(ClientPktHeader));
 
-    message_block.wr_ptr(n);
+            ClientPktHeader& header = *((ClientPktHeader*) m_RecvBuffer.rd_ptr());
 
-    while (message_block.length() > 0)
-    {
-        if (m_Header.space() > 0)
-        {
-            // need to receive the header
-            const size_t to_header = (message_block.length() > m_Header.space() ? m_Header.space() : message_block.length());
-            m_Header.copy(message_block.rd_ptr(), to_header);
-            message_block.rd_ptr(to_header);
+            EndianConvertReverse(header.size);
+            EndianConvert(header.cmd);
 
-            if (m_Header.space() > 0)
+            if ((header.size < 4) || (header.size > 10240) || (header.cmd  > 10240))
             {
-                // Couldn't receive the whole header this time.
-                MANGOS_ASSERT(message_block.length() == 0);
-                errno = EWOULDBLOCK;
-                return -1;
-            }
+                sLog.outError("WorldSocket::ProcessReceived: client sent malformed packet size = %d , cmd = %d",
+                              header.size, header.cmd);
 
-            // We just received nice new header
-            if (handle_input_header() == -1)
-            {
-                MANGOS_ASSERT((errno != EWOULDBLOCK) && (errno != EAGAIN));
+                errno = EINVAL;
                 return -1;
             }
+
+            m_RecvSize = header.size - 4;
+            m_RecvCmd = (uint16)header.cmd;
+            m_RecvHeaderReady = true;
         }
 
-        // Its possible on some error situations that this happens
-        // for example on closing when epoll receives more chunked data and stuff
-        // hope this is not hack ,as proper m_RecvWPct is asserted around
-        if (!m_RecvWPct)
+        if (m_RecvBuffer.length() < sizeof(ClientPktHeader) + m_RecvSize)
         {
-            sLog.outError("Forcing close on input m_RecvWPct = NULL");
-            errno = EINVAL;
-            return -1;
+            return 0;
         }
 
-        // We have full read header, now check the data payload
-        if (m_RecvPct.space() > 0)
-        {
-            // need more data in the payload
-            const size_t to_data = (message_block.length() > m_RecvPct.space() ? m_RecvPct.space() : message_block.length());
-            m_RecvPct.copy(message_block.rd_ptr(), to_data);
-            message_block.rd_ptr(to_data);
+        m_RecvBuffer.rd_ptr(sizeof(ClientPktHeader));
 
-            if (m_RecvPct.space() > 0)
-            {
-                // Couldn't receive the whole data this time.
-                MANGOS_ASSERT(message_block.length() == 0);
-                errno = EWOULDBLOCK;
-                return -1;
-            }
+        WorldPacket* packet = AcquireRecvPacket(m_RecvCmd, m_RecvSize);
+        if (m_RecvSize > 0)
+        {
+            packet->append((uint8 const*) m_RecvBuffer.rd_ptr(), m_RecvSize);
+            m_RecvBuffer.rd_ptr(m_RecvSize);
         }
 
-        // just received fresh new payload
-        if (handle_input_payload() == -1)
+        m_RecvHeaderReady = false;
+
+        if (ProcessIncoming(packet) == -1)
         {
-            MANGOS_ASSERT((errno != EWOULDBLOCK) && (errno != EAGAIN));
+            errno = EINVAL;
             return -1;
         }
     }
-
-    return size_t(n) == recv_size ? 1 : 2;
 }
 
 void WorldSocket::HandleMovementOpcodes(WorldPacket& recvPacket)
@@ -637,7 +687,7 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     MANGOS_ASSERT(new_pct);
 
     // manage memory ;)
-    ACE_Auto_Ptr<WorldPacket> aptr(new_pct);
+    PooledPacketGuard aptr(this, new_pct);
 
     const ACE_UINT16 opcode = new_pct->GetOpcode();
 
@@ -652,6 +702,31 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
         return -1;
     }
 
+    // CMSG_AUTH_SESSION is bound to this connection, the capture only notes the session opened.
+    // Captured before the throttle, so a replay sends the floods it stopped as well.
+    if (opcode != CMSG_AUTH_SESSION)
+    {
+        sPacketCapture.AddPacket(m_CaptureSession, *new_pct);
+    }
+
+    // stop floods here, before they are queued to the session and cost handler time
+    if (sWorld.getConfig(CONFIG_BOOL_OPCODE_THROTTLE))
+    {
+        switch (m_Throttle.Check(opcode, getMSTime()))
+        {
+            case THROTTLE_RESULT_DROP:
+                DEBUG_LOG("WorldSocket::ProcessIncoming: dropped %s (0x%.4X) from %s, over its rate limit",
+                          new_pct->GetOpcodeName(), opcode, GetRemoteAddress().c_str());
+                return 0;
+            case THROTTLE_RESULT_KICK:
+                sLog.outError("WorldSocket::ProcessIncoming: %s (0x%.4X) from %s far over its rate limit, disconnecting",
+                              new_pct->GetOpcodeName(), opcode, GetRemoteAddress().c_str());
+                return -1;
+            default:
+                break;
+        }
+    }
+
     // Dump received packet.
     sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), new_pct->GetOpcodeName(), new_pct, true);
 
@@ -714,7 +789,12 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
                 if (m_Session != NULL)
                 {
                     // Intercept movement packets for direct processing
+                    ACE_Time_Value start = ACE_OS::gettimeofday();
                     HandleMovementOpcodes(*new_pct);
+
+                    ACE_UINT64 elapsed;
+                    (ACE_OS::gettimeofday() - start).to_usec(elapsed);
+                    sOpcodeProfiler.AddInbound(opcode, PROCESS_INPLACE, new_pct->size(), uint32(elapsed));
                     return 0; // Handled, don't forward to session
                 }
                 else
@@ -979,6 +1059,8 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
         m_Session->InitWarden(uint16(BuiltNumberClient), &K, os);
     }
 
+    sPacketCapture.AddSessionOpen(m_CaptureSession, BuiltNumberClient);
+
     sWorld.AddSession(m_Session);
 
     // Create and send the Addon packet
@@ -1054,63 +1136,99 @@ int WorldSocket::HandlePing(WorldPacket& recvPacket)
     return SendPacket(packet);
 }
 
-int WorldSocket::iSendPacket(const WorldPacket& pct)
+WorldPacket* WorldSocket::AcquireRecvPacket(uint16 opcode, size_t size)
 {
-    if (m_OutBuffer->space() < pct.size() + sizeof(ServerPktHeader))
+    WorldPacket* pct = NULL;
     {
-        errno = ENOBUFS;
-        return -1;
-    }
-
-    ServerPktHeader header;
-
-    header.cmd = pct.GetOpcode();
+        ACE_GUARD_RETURN(LockType, Guard, m_RecvPacketLock, new WorldPacket(opcode, size));
 
-    header.size = (uint16) pct.size() + 2;
+        if (!m_FreeRecvPackets.empty())
+        {
+            pct = m_FreeRecvPackets.back();
+            m_FreeRecvPackets.pop_back();
+        }
+    }
 
-    EndianConvertReverse(header.size);
-    EndianConvert(header.cmd);
+    if (!pct)
+    {
+        return new WorldPacket(opcode, size);
+    }
 
-    m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+    pct->Initialize(opcode, size);
+    return pct;
+}
 
-    if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
+void WorldSocket::ReleaseRecvPacket(WorldPacket* pct)
+{
+    if (!pct)
     {
-        ACE_ASSERT(false);
+        return;
     }
 
-    if (!pct.empty())
-        if (m_OutBuffer->copy((char*) pct.contents(), pct.size()) == -1)
+    if (pct->size() <= WORLDSOCKET_MAX_FREE_PACKET_SIZE)
+    {
+        ACE_GUARD(LockType, Guard, m_RecvPacketLock);
+
+        if (m_FreeRecvPackets.size() < WORLDSOCKET_MAX_FREE_RECV_PACKETS)
         {
-            ACE_ASSERT(false);
+            m_FreeRecvPackets.push_back(pct);
+            return;
         }
+    }
 
-    return 0;
+    delete pct;
 }
 
-bool WorldSocket::iFlushPacketQueue()
+void WorldSocket::iReleasePacket(WorldPacket* pct)
 {
-    WorldPacket* pct;
-    bool haveone = false;
+    if (!pct)
+    {
+        return;
+    }
 
-    while (m_PacketQueue.dequeue_head(pct) == 0)
+    if (pct->size() <= WORLDSOCKET_MAX_FREE_PACKET_SIZE && m_FreePackets.size() < WORLDSOCKET_MAX_FREE_PACKETS)
     {
-        if (iSendPacket(*pct) == -1)
-        {
-            if (m_PacketQueue.enqueue_head(pct) == -1)
-            {
-                delete pct;
-                sLog.outError("WorldSocket::iFlushPacketQueue m_PacketQueue->enqueue_head");
-                return false;
-            }
+        m_FreePackets.push_back(pct);
+        return;
+    }
 
-            break;
-        }
-        else
-        {
-            haveone = true;
-            delete pct;
-        }
+    delete pct;
+}
+
+int WorldSocket::iQueuePacket(WorldPacket* owned, const SharedWorldPacket& shared)
+{
+    // the write mask is set while anything is queued, handle_output clears it once all is written
+    bool wakeup = m_OutQueue.empty();
+
+    m_OutQueue.push_back(OutboundPacket());
+    OutboundPacket& entry = m_OutQueue.back();
+    entry.owned = owned;
+    entry.shared = shared;
+    entry.sent = 0;
+
+    WorldPacket const& pct = *entry.Payload();
+
+    sOpcodeProfiler.AddOutbound(pct.GetOpcode(), sizeof(entry.header) + pct.size());
+
+    ServerPktHeader header;
+
+    header.cmd = pct.GetOpcode();
+
+    header.size = (uint16) pct.size() + 2;
+
+    EndianConvertReverse(header.size);
+    EndianConvert(header.cmd);
+
+    m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+
+    static_assert(sizeof(header) == sizeof(entry.header), "OutboundPacket::header holds a ServerPktHeader");
+    ACE_OS::memcpy(entry.header, &header, sizeof(header));
+
+    if (wakeup && reactor()->schedule_wakeup(this, ACE_Event_Handler::WRITE_MASK) == -1)
+    {
+        sLog.outError("SendPacket failed setting WRITE mask, peer = %s", GetRemoteAddress().c_str());
+        return -1;
     }
 
-    return haveone;
+    return 0;
 }
@@ -39,8 +39,9 @@
 #include <ace/Acceptor.h>
 #include <ace/Thread_Mutex.h>
 #include <ace/Guard_T.h>
-#include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
+#include <ace/Atomic_Op.h>
+#include <ace/OS_NS_sys_socket.h>
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -48,15 +49,58 @@
 
 #include "Common.h"
 #include "Auth/AuthCrypt.h"
+#include "WorldPacket.h"
+#include "OpcodeThrottle.h"
+
+#include <deque>
+#include <vector>
 
 class ACE_Message_Block;
-class WorldPacket;
 class WorldSession;
 class WorldSocket;
 
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
 typedef ACE_Acceptor< WorldSocket, ACE_SOCK_ACCEPTOR > WorldAcceptor;
 
+#ifdef SO_REUSEPORT
+/**
+ * Listening socket bound with SO_REUSEPORT.
+ *
+ * Every network thread opens one on the world port when Network.Engine = 1,
+ * the kernel spreads the incoming connections over them.
+ */
+class ReusePortSockAcceptor : public ACE_SOCK_Acceptor
+{
+    public:
+        int open(const ACE_Addr& local_sap, int reuse_addr = 0, int protocol_family = PF_UNSPEC,
+                 int backlog = ACE_DEFAULT_BACKLOG, int protocol = 0)
+        {
+            if (protocol_family == PF_UNSPEC)
+            {
+                protocol_family = local_sap.get_type();
+            }
+
+            if (ACE_SOCK::open(SOCK_STREAM, protocol_family, protocol, reuse_addr) == -1)
+            {
+                return -1;
+            }
+
+            int one = 1;
+            if (set_option(SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1 ||
+                ACE_OS::bind(get_handle(), reinterpret_cast<sockaddr*>(local_sap.get_addr()), local_sap.get_size()) == -1 ||
+                ACE_OS::listen(get_handle(), backlog) == -1)
+            {
+                close();
+                return -1;
+            }
+
+            return 0;
+        }
+};
+
+typedef ACE_Acceptor< WorldSocket, ReusePortSockAcceptor > WorldReusePortAcceptor;
+#endif
+
 /**
  * WorldSocket.
  *
@@ -65,25 +109,16 @@ typedef ACE_Acceptor< WorldSocket, ACE_SOCK_ACCEPTOR > WorldAcceptor;
  * Most methods return -1 on failure.
  * The class uses reference counting.
  *
- * For output the class uses one buffer (64K usually) and
- * a queue where it stores packet if there is no space left on
- * the buffer. The reason this is done, is because the server
- * does really a lot of small-size writes to it, and it doesn't
- * scale well to allocate memory for every. When something is
- * written to the output buffer the socket is not immediately
- * activated for output (again for the same reason), there
- * is 10ms celling (thats why there is Update() override method).
- * This concept is similar to TCP_CORK, but TCP_CORK
- * uses 200ms celling. As result overhead generated by
- * sending packets from "producer" threads is minimal,
- * and doing a lot of writes with small size is tolerated.
+ * For output the class keeps a queue of packets, each with its
+ * encrypted header and the buffer its payload is written from:
+ * a pooled copy owned by the socket, or a payload shared with
+ * other sockets. The socket is marked for output when the queue
+ * stops being empty, and every handle_output() writes as much of
+ * the queue as fits into one writev()/sendmsg() call, so the
+ * packets sent during a world tick usually leave together.
  *
- * The calls to Update () method are managed by WorldSocketMgr.
- *
- * For input, the class uses one 1024 bytes buffer on stack
- * to which it does recv() calls. And then received data is
- * distributed where its needed. 1024 matches pretty well the
- * traffic generated by client for now.
+ * For input, the class recv()s into a buffer of its own and
+ * slices the complete packets out of it into pooled packets.
  *
  * The input/output do speculative reads/writes (AKA it tryes
  * to read all data available in the kernel buffer or tryes to
@@ -99,13 +134,11 @@ class WorldSocket : protected WorldHandler
         /// Declare some friends
         friend class ACE_Acceptor< WorldSocket, ACE_SOCK_ACCEPTOR >;
         friend class WorldSocketMgr;
+        friend class PacketCompressor;
 
         /// Mutex type used for various synchronizations.
         typedef ACE_Thread_Mutex LockType;
 
-        /// Queue for storing packets for which there is no space.
-        typedef ACE_Unbounded_Queue< WorldPacket* > PacketQueueT;
-
         /// Check if socket is closed.
         bool IsClosed(void) const;
 
@@ -120,12 +153,22 @@ class WorldSocket : protected WorldHandler
         /// @return -1 of failure
         int SendPacket(const WorldPacket& pct);
 
+        /// Send a packet shared with other sockets, only its header is
+        /// written to this socket, the payload is written from the shared buffer.
+        /// @param pct packet to send
+        /// @return -1 of failure
+        int SendPacket(const SharedWorldPacket& pct);
+
         /// Add reference to this object.
         long AddReference(void);
 
         /// Remove reference to this object.
         long RemoveReference(void);
 
+        /// Give a received packet back once the session handled it, it is
+        /// reused for the next packet of this socket or deleted.
+        void ReleaseRecvPacket(WorldPacket* pct);
+
     protected:
         /// things called by ACE framework.
         WorldSocket(void);
@@ -148,13 +191,14 @@ class WorldSocket : protected WorldHandler
                                  ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK) override;
 
     private:
-        /// Helper functions for processing incoming data.
-        int handle_input_header(void);
-        int handle_input_payload(void);
-        int handle_input_missing_data(void);
+        /// Slice the complete packets out of m_RecvBuffer and process them.
+        int ProcessReceived(void);
+
+        /// Get an empty packet for a received message, from m_FreeRecvPackets if possible.
+        WorldPacket* AcquireRecvPacket(uint16 opcode, size_t size);
 
         /// process one incoming packet.
-        /// @param new_pct received packet ,note that you need to delete it.
+        /// @param new_pct received packet from AcquireRecvPacket(), ownership is taken.
         int ProcessIncoming(WorldPacket* new_pct);
 		void HandleMovementOpcodes(WorldPacket& recvPacket);
 
@@ -164,15 +208,21 @@ class WorldSocket : protected WorldHandler
         /// Called by ProcessIncoming() on CMSG_PING.
         int HandlePing(WorldPacket& recvPacket);
 
-        /// Try to write WorldPacket to m_OutBuffer ,return -1 if no space
+        /// Send a packet right away, bypassing the packet compressor.
+        int SendPacketNow(const WorldPacket& pct);
+
+        /// Send a packet right away, bypassing the packet compressor.
+        /// @param pct heap allocated packet, ownership is taken
+        int SendPacketNow(WorldPacket* pct);
+
+        /// Encrypt the header of a packet and append it to m_OutQueue,
+        /// either owned or shared is set.
         /// Need to be called with m_OutBufferLock lock held
-        int iSendPacket(const WorldPacket& pct);
+        int iQueuePacket(WorldPacket* owned, const SharedWorldPacket& shared);
 
-        /// Flush m_PacketQueue if there are packets in it
+        /// Keep a written payload copy for the next packet or delete it.
         /// Need to be called with m_OutBufferLock lock held
-        /// @return true if it wrote to the buffer ( AKA you need
-        /// to mark the socket for output ).
-        bool iFlushPacketQueue();
+        void iReleasePacket(WorldPacket* pct);
 
     private:
         /// Time in which the last ping was received
@@ -190,31 +240,52 @@ class WorldSocket : protected WorldHandler
         /// Session to which received packets are routed
         WorldSession* m_Session;
 
-        /// here are stored the fragments of the received data
-        WorldPacket* m_RecvWPct;
+        /// Rate limits of the received opcodes
+        OpcodeThrottle m_Throttle;
 
-        /// This block actually refers to m_RecvWPct contents,
-        /// which allows easy and safe writing to it.
-        /// It wont free memory when its deleted. m_RecvWPct takes care of freeing.
-        ACE_Message_Block m_RecvPct;
+        /// Received data not parsed yet, always has room for one full packet.
+        ACE_Message_Block m_RecvBuffer;
 
-        /// Fragment of the received header.
-        ACE_Message_Block m_Header;
+        /// The header at the read position of m_RecvBuffer is decrypted already.
+        bool m_RecvHeaderReady;
+
+        /// Payload size and opcode of the decrypted header.
+        uint16 m_RecvSize;
+        uint16 m_RecvCmd;
 
         /// Mutex for protecting output related data.
         LockType m_OutBufferLock;
 
-        /// Buffer used for writing output.
-        ACE_Message_Block* m_OutBuffer;
+        /// Packet waiting to be written.
+        struct OutboundPacket
+        {
+            uint8 header[4];                                ///< encrypted ServerPktHeader
+            WorldPacket* owned;                             ///< payload copy owned by the socket
+            SharedWorldPacket shared;                       ///< or a payload shared with other sockets
+            size_t sent;                                    ///< bytes of header and payload already written
+
+            WorldPacket const* Payload() const { return owned ? owned : shared.get(); }
+        };
+
+        /// Packets waiting to be written, in order.
+        std::deque<OutboundPacket> m_OutQueue;
 
-        /// Size of the m_OutBuffer.
-        size_t m_OutBufferSize;
+        /// Payload copies written already, reused by SendPacketNow().
+        std::vector<WorldPacket*> m_FreePackets;
 
-        /// Here are stored packets for which there was no space on m_OutBuffer,
-        /// this allows not-to kick player if its buffer is overflowed.
-        PacketQueueT m_PacketQueue;
+        /// Received packets the session handled already, reused by ProcessReceived().
+        /// Locked on its own, as the session hands them back from the world and map threads.
+        LockType m_RecvPacketLock;
+        std::vector<WorldPacket*> m_FreeRecvPackets;
 
         const uint32 m_Seed;
+
+        /// Packets of this socket waiting in the packet compressor, while there are
+        /// any the other packets are queued behind them to keep the order.
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_PendingCompressions;
+
+        /// Number of the connection in packet captures.
+        const uint32 m_CaptureSession;
 };
 
 #endif  /* _WORLDSOCKET_H */
@@ -36,6 +36,10 @@
 
 #include <ace/ACE.h>
 #include <ace/TP_Reactor.h>
+#include <ace/Select_Reactor.h>
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+#include <ace/Dev_Poll_Reactor.h>
+#endif
 #include <ace/os_include/arpa/os_inet.h>
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
@@ -44,22 +48,28 @@
 #include <set>
 
 WorldSocketMgr::WorldSocketMgr()
-  : m_SockOutKBuff(-1), m_SockOutUBuff(65536), m_UseNoDelay(true),
-    reactor_(NULL), acceptor_(NULL)
+  : m_SockOutKBuff(-1), m_UseNoDelay(true),
+    m_ReactorPerThread(false), m_NextThread(0), m_NextReactor(0), acceptor_(NULL)
 {
     InitializeOpcodes();
 }
 
 WorldSocketMgr::~WorldSocketMgr()
 {
-    if (reactor_)
-    {
-        delete reactor_;
-    }
     if (acceptor_)
     {
         delete acceptor_;
     }
+#ifdef SO_REUSEPORT
+    for (size_t i = 0; i < m_PortAcceptors.size(); ++i)
+    {
+        delete m_PortAcceptors[i];
+    }
+#endif
+    for (size_t i = 0; i < m_Reactors.size(); ++i)
+    {
+        delete m_Reactors[i];
+    }
 }
 
 
@@ -67,12 +77,33 @@ int WorldSocketMgr::svc()
 {
     DEBUG_LOG("Starting Network Thread");
 
-    reactor_->run_reactor_event_loop();
+    // with a reactor per thread, every thread takes the next one
+    ACE_Reactor* reactor = m_Reactors[0];
+    if (m_ReactorPerThread)
+    {
+        reactor = m_Reactors[m_NextThread++];
+        reactor->owner(ACE_OS::thr_self());
+    }
+
+    reactor->run_reactor_event_loop();
 
     DEBUG_LOG("Network Thread Exitting");
     return 0;
 }
 
+/// Reactor for a single network thread, epoll based where ACE supports it
+ACE_Reactor* WorldSocketMgr::CreateThreadReactor()
+{
+    ACE_Reactor_Impl* imp = 0;
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    imp = new ACE_Dev_Poll_Reactor(ACE::max_handles());
+#else
+    imp = new ACE_Select_Reactor();
+#endif
+    imp->max_notify_iterations(128);
+    return new ACE_Reactor(imp, 1);
+}
+
 
 
 int WorldSocketMgr::StartNetwork(ACE_INET_Addr& addr)
@@ -84,29 +115,58 @@ int WorldSocketMgr::StartNetwork(ACE_INET_Addr& addr)
         return -1;
     }
 
-    m_SockOutUBuff = sConfig.GetIntDefault("Network.OutUBuff", 65536);
-    if (m_SockOutUBuff <= 0)
-    {
-        sLog.outError("Network.OutUBuff is wrong in your config file");
-        return -1;
-    }
-
     // -1 means use default
     m_SockOutKBuff = sConfig.GetIntDefault("Network.OutKBuff", -1);
     m_UseNoDelay = sConfig.GetBoolDefault("Network.TcpNodelay", true);
 
 
-    ACE_Reactor_Impl* imp = 0;
-    imp = new ACE_TP_Reactor();
-    imp->max_notify_iterations(128);
-    reactor_ = new ACE_Reactor(imp, 1);
+    uint32 engine = sConfig.GetIntDefault("Network.Engine", NETWORK_ENGINE_TP_REACTOR);
+    if (engine == NETWORK_ENGINE_REACTOR_PER_THREAD)
+    {
+        m_ReactorPerThread = true;
+        for (int i = 0; i < num_threads; ++i)
+        {
+            m_Reactors.push_back(CreateThreadReactor());
+        }
 
-    acceptor_ = new WorldAcceptor;
+#ifdef SO_REUSEPORT
+        // every thread accepts its own connections, sockets never change thread
+        for (int i = 0; i < num_threads; ++i)
+        {
+            WorldReusePortAcceptor* acceptor = new WorldReusePortAcceptor;
+            m_PortAcceptors.push_back(acceptor);
+
+            if (acceptor->open(addr, m_Reactors[i], ACE_NONBLOCK) == -1)
+            {
+                sLog.outError("Failed to open acceptor, check if the port is free");
+                return -1;
+            }
+        }
+#else
+        // no SO_REUSEPORT, the first thread accepts and the sockets are spread over the reactors
+        acceptor_ = new WorldAcceptor;
 
-    if (acceptor_->open(addr, reactor_, ACE_NONBLOCK) == -1)
+        if (acceptor_->open(addr, m_Reactors[0], ACE_NONBLOCK) == -1)
+        {
+            sLog.outError("Failed to open acceptor, check if the port is free");
+            return -1;
+        }
+#endif
+    }
+    else
     {
-        sLog.outError("Failed to open acceptor, check if the port is free");
-        return -1;
+        ACE_Reactor_Impl* imp = 0;
+        imp = new ACE_TP_Reactor();
+        imp->max_notify_iterations(128);
+        m_Reactors.push_back(new ACE_Reactor(imp, 1));
+
+        acceptor_ = new WorldAcceptor;
+
+        if (acceptor_->open(addr, m_Reactors[0], ACE_NONBLOCK) == -1)
+        {
+            sLog.outError("Failed to open acceptor, check if the port is free");
+            return -1;
+        }
     }
 
     if (activate(THR_NEW_LWP | THR_JOINABLE, num_threads) == -1)
@@ -115,6 +175,7 @@ int WorldSocketMgr::StartNetwork(ACE_INET_Addr& addr)
     }
 
     sLog.outString("Max allowed socket connections: %d", ACE::max_handles());
+    sLog.outString("Network engine: %s, %d threads", m_ReactorPerThread ? "reactor per thread" : "shared TP reactor", num_threads);
     return 0;
 }
 
@@ -124,9 +185,15 @@ void WorldSocketMgr::StopNetwork()
     {
         acceptor_->close();
     }
-    if (reactor_)
+#ifdef SO_REUSEPORT
+    for (size_t i = 0; i < m_PortAcceptors.size(); ++i)
+    {
+        m_PortAcceptors[i]->close();
+    }
+#endif
+    for (size_t i = 0; i < m_Reactors.size(); ++i)
     {
-        reactor_->end_reactor_event_loop();
+        m_Reactors[i]->end_reactor_event_loop();
     }
     wait();
 }
@@ -155,8 +222,16 @@ int WorldSocketMgr::OnSocketOpen(WorldSocket* sock)
         }
     }
 
-    sock->m_OutBufferSize = static_cast<size_t>(m_SockOutUBuff);
-    sock->reactor(reactor_);
+    // pin the socket to a reactor; with one acceptor per thread it stays on the accepting one
+    if (!m_ReactorPerThread)
+    {
+        sock->reactor(m_Reactors[0]);
+    }
+    else if (acceptor_)
+    {
+        // only the thread running the acceptor gets here
+        sock->reactor(m_Reactors[m_NextReactor++ % m_Reactors.size()]);
+    }
 
     return 0;
 }
@@ -37,10 +37,20 @@
 #include <ace/INET_Addr.h>
 #include <ace/Task.h>
 #include <ace/Acceptor.h>
+#include <ace/Atomic_Op.h>
+
+#include <vector>
 
 class WorldSocket;
 
-/// This is a pool of threads designed to be used by an ACE_TP_Reactor.
+/// Network engines selectable with Network.Engine
+enum NetworkEngine
+{
+    NETWORK_ENGINE_TP_REACTOR       = 0,                    ///< one ACE_TP_Reactor shared by all network threads
+    NETWORK_ENGINE_REACTOR_PER_THREAD = 1                   ///< one epoll reactor per network thread, sockets stay on the thread that accepted them
+};
+
+/// This is a pool of threads running either one shared ACE_TP_Reactor or one reactor each.
 /// Manages all sockets connected to peers
 
 class WorldSocketMgr : public ACE_Task_Base
@@ -59,12 +69,20 @@ class WorldSocketMgr : public ACE_Task_Base
         virtual ~WorldSocketMgr();
 
     private:
+        ACE_Reactor* CreateThreadReactor();
+
         int m_SockOutKBuff;
-        int m_SockOutUBuff;
         bool m_UseNoDelay;
 
-        ACE_Reactor   *reactor_;
+        bool m_ReactorPerThread;
+        std::vector<ACE_Reactor*> m_Reactors;               ///< one shared or one per network thread
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_NextThread; ///< index of the reactor the next started thread runs
+        size_t m_NextReactor;                               ///< round robin for sockets when a single acceptor serves all reactors
+
         WorldAcceptor *acceptor_;
+#ifdef SO_REUSEPORT
+        std::vector<WorldReusePortAcceptor*> m_PortAcceptors;
+#endif
 };
 
 #define sWorldSocketMgr ACE_Singleton<WorldSocketMgr, ACE_Thread_Mutex>::instance()
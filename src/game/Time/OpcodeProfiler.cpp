@@ -0,0 +1,260 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "OpcodeProfiler.h"
+#include "Opcodes.h"
+#include "Config.h"
+#include "Log.h"
+#include "Timer.h"
+
+#include <ace/Guard_T.h>
+
+#include <cstdio>
+#include <ctime>
+
+INSTANTIATE_SINGLETON_1(OpcodeProfiler);
+
+OpcodeProfiler::OpcodeProfiler() : m_since(getMSTime()), m_windowLength(60 * IN_MILLISECONDS), m_csvInterval(0),
+    m_windowTimer(0), m_csvTimer(0)
+{
+    m_inbound = new Inbound[NUM_MSG_TYPES * OPCODE_PROFILE_PLACES];
+    m_outbound = new Outbound[NUM_MSG_TYPES];
+
+    for (uint32 i = 0; i < NUM_MSG_TYPES * OPCODE_PROFILE_PLACES; ++i)
+    {
+        m_inbound[i].calls = 0;
+        m_inbound[i].bytes = 0;
+        m_inbound[i].usec = 0;
+        m_inbound[i].time = NULL;
+    }
+
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        m_outbound[i].packets = 0;
+        m_outbound[i].bytes = 0;
+    }
+}
+
+OpcodeProfiler::~OpcodeProfiler()
+{
+    for (uint32 i = 0; i < NUM_MSG_TYPES * OPCODE_PROFILE_PLACES; ++i)
+    {
+        delete m_inbound[i].time;
+    }
+
+    delete[] m_inbound;
+    delete[] m_outbound;
+}
+
+void OpcodeProfiler::LoadFromConfig()
+{
+    m_windowLength = std::max(sConfig.GetIntDefault("PerfProfiler.Window", 60), 1) * IN_MILLISECONDS;
+    m_csvInterval = std::max(sConfig.GetIntDefault("PerfProfiler.CsvInterval", 0), 0) * IN_MILLISECONDS;
+
+    m_csvFile = sConfig.GetStringDefault("PerfProfiler.OpcodeCsvFile", "");
+    if (!m_csvFile.empty())
+    {
+        m_csvFile = sLog.GetLogsDir() + m_csvFile;
+    }
+}
+
+void OpcodeProfiler::Update(uint32 diff)
+{
+    m_csvTimer += diff;
+    if (m_csvInterval && !m_csvFile.empty() && m_csvTimer >= m_csvInterval)
+    {
+        m_csvTimer = 0;
+        WriteCsv();
+    }
+
+    m_windowTimer += diff;
+    if (m_windowTimer >= m_windowLength)
+    {
+        m_windowTimer = 0;
+        Rotate();
+    }
+}
+
+void OpcodeProfiler::AddInbound(uint16 opcode, uint32 place, size_t bytes, uint32 usec)
+{
+    if (opcode >= NUM_MSG_TYPES || place >= OPCODE_PROFILE_PLACES)
+    {
+        return;
+    }
+
+    Inbound& inbound = m_inbound[opcode * OPCODE_PROFILE_PLACES + place];
+    inbound.calls.fetch_add(1, std::memory_order_relaxed);
+    inbound.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    inbound.usec.fetch_add(usec, std::memory_order_relaxed);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, LockOf(opcode));
+    if (!inbound.time)
+    {
+        inbound.time = new PerfHistogram();
+    }
+
+    inbound.time->Add(usec);
+}
+
+void OpcodeProfiler::AddOutbound(uint16 opcode, size_t bytes)
+{
+    if (opcode >= NUM_MSG_TYPES)
+    {
+        return;
+    }
+
+    m_outbound[opcode].packets.fetch_add(1, std::memory_order_relaxed);
+    m_outbound[opcode].bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void OpcodeProfiler::GetInboundReport(std::vector<InboundReport>& report) const
+{
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        for (uint32 place = 0; place < OPCODE_PROFILE_PLACES; ++place)
+        {
+            Inbound const& inbound = m_inbound[opcode * OPCODE_PROFILE_PLACES + place];
+            uint64 calls = inbound.calls.load(std::memory_order_relaxed);
+            if (!calls)
+            {
+                continue;
+            }
+
+            report.push_back(InboundReport());
+            InboundReport& entry = report.back();
+            entry.opcode = opcode;
+            entry.place = place;
+            entry.calls = calls;
+            entry.bytes = inbound.bytes.load(std::memory_order_relaxed);
+            entry.usec = inbound.usec.load(std::memory_order_relaxed);
+
+            ACE_GUARD(ACE_Thread_Mutex, guard, LockOf(opcode));
+            if (inbound.time)
+            {
+                entry.time = *inbound.time;
+            }
+        }
+    }
+}
+
+void OpcodeProfiler::GetOutboundReport(std::vector<OutboundReport>& report) const
+{
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        uint64 packets = m_outbound[opcode].packets.load(std::memory_order_relaxed);
+        if (!packets)
+        {
+            continue;
+        }
+
+        report.push_back(OutboundReport());
+        OutboundReport& entry = report.back();
+        entry.opcode = opcode;
+        entry.packets = packets;
+        entry.bytes = m_outbound[opcode].bytes.load(std::memory_order_relaxed);
+    }
+}
+
+uint32 OpcodeProfiler::GetSeconds() const
+{
+    return std::max(getMSTimeDiff(m_since.load(std::memory_order_relaxed), getMSTime()) / IN_MILLISECONDS, uint32(1));
+}
+
+void OpcodeProfiler::Reset()
+{
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, LockOf(opcode));
+
+        for (uint32 place = 0; place < OPCODE_PROFILE_PLACES; ++place)
+        {
+            Inbound& inbound = m_inbound[opcode * OPCODE_PROFILE_PLACES + place];
+            inbound.calls = 0;
+            inbound.bytes = 0;
+            inbound.usec = 0;
+            if (inbound.time)
+            {
+                *inbound.time = PerfHistogram();
+            }
+        }
+
+        m_outbound[opcode].packets = 0;
+        m_outbound[opcode].bytes = 0;
+    }
+
+    m_since = getMSTime();
+}
+
+void OpcodeProfiler::Rotate()
+{
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, LockOf(opcode));
+
+        for (uint32 place = 0; place < OPCODE_PROFILE_PLACES; ++place)
+        {
+            if (PerfHistogram* time = m_inbound[opcode * OPCODE_PROFILE_PLACES + place].time)
+            {
+                time->Rotate();
+            }
+        }
+    }
+}
+
+void OpcodeProfiler::WriteCsv()
+{
+    FILE* file = TickProfiler::OpenCsvFile(m_csvFile, "time,direction,opcode,place,count,bytes,usec,p50,p95,p99,max");
+    if (!file)
+    {
+        sLog.outError("OpcodeProfiler: can't open %s for writing.", m_csvFile.c_str());
+        return;
+    }
+
+    unsigned long long now = (unsigned long long)time(NULL);
+
+    std::vector<InboundReport> inbound;
+    GetInboundReport(inbound);
+    for (std::vector<InboundReport>::const_iterator itr = inbound.begin(); itr != inbound.end(); ++itr)
+    {
+        fprintf(file, "%llu,in,%s,%s," UI64FMTD "," UI64FMTD "," UI64FMTD ",%u,%u,%u,%u\n", now, LookupOpcodeName(itr->opcode),
+                GetPlaceName(itr->place), itr->calls, itr->bytes, itr->usec, itr->time.GetPercentile(50),
+                itr->time.GetPercentile(95), itr->time.GetPercentile(99), itr->time.GetMax());
+    }
+
+    std::vector<OutboundReport> outbound;
+    GetOutboundReport(outbound);
+    for (std::vector<OutboundReport>::const_iterator itr = outbound.begin(); itr != outbound.end(); ++itr)
+    {
+        fprintf(file, "%llu,out,%s,,"  UI64FMTD "," UI64FMTD ",,,,,\n", now, LookupOpcodeName(itr->opcode), itr->packets, itr->bytes);
+    }
+
+    fclose(file);
+}
+
+char const* OpcodeProfiler::GetPlaceName(uint32 place)
+{
+    static char const* names[OPCODE_PROFILE_PLACES] = { "inplace", "threadunsafe", "threadsafe" };
+
+    return place < OPCODE_PROFILE_PLACES ? names[place] : "unknown";
+}
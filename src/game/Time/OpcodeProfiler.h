@@ -0,0 +1,128 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef OPCODEPROFILER_H
+#define OPCODEPROFILER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "TickProfiler.h"
+
+#include <ace/Thread_Mutex.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/// Places a received packet is handled in, the PacketProcessing values of the opcode table
+#define OPCODE_PROFILE_PLACES 3
+/// Locks guarding the handler time histograms, picked by opcode
+#define OPCODE_PROFILE_LOCKS 64
+
+/**
+ * @brief Volume and handler time per opcode, always collected.
+ *
+ * Received packets are recorded with their processing place once their handler ran,
+ * sent packets when they are queued on a socket. Counters run since the last reset,
+ * handler times are histograms over the PerfProfiler.Window rolling window.
+ * Queried by the .server opcodes command, and dumped to a CSV file periodically.
+ */
+class OpcodeProfiler
+{
+    public:
+        OpcodeProfiler();
+        ~OpcodeProfiler();
+
+        void LoadFromConfig();
+        void Update(uint32 diff);
+
+        /// The handler of a received packet of bytes size ran for usec microseconds at place (PacketProcessing)
+        void AddInbound(uint16 opcode, uint32 place, size_t bytes, uint32 usec);
+        /// A packet of bytes size, header included, was queued for sending
+        void AddOutbound(uint16 opcode, size_t bytes);
+
+        struct InboundReport
+        {
+            uint16 opcode;
+            uint32 place;
+            uint64 calls;
+            uint64 bytes;
+            uint64 usec;                                    // handler time of all calls
+            PerfHistogram time;
+        };
+
+        struct OutboundReport
+        {
+            uint16 opcode;
+            uint64 packets;
+            uint64 bytes;
+        };
+
+        /// Snapshots of the opcodes recorded since the last reset
+        void GetInboundReport(std::vector<InboundReport>& report) const;
+        void GetOutboundReport(std::vector<OutboundReport>& report) const;
+
+        /// Seconds covered by the counters
+        uint32 GetSeconds() const;
+        void Reset();
+
+        static char const* GetPlaceName(uint32 place);
+
+    private:
+        struct Inbound
+        {
+            std::atomic<uint64> calls;
+            std::atomic<uint64> bytes;
+            std::atomic<uint64> usec;
+            PerfHistogram* time;                            // allocated on the first call, guarded by LockOf()
+        };
+
+        struct Outbound
+        {
+            std::atomic<uint64> packets;
+            std::atomic<uint64> bytes;
+        };
+
+        void Rotate();
+        void WriteCsv();
+
+        ACE_Thread_Mutex& LockOf(uint16 opcode) const { return m_locks[opcode % OPCODE_PROFILE_LOCKS]; }
+
+        Inbound* m_inbound;                                 // NUM_MSG_TYPES * OPCODE_PROFILE_PLACES
+        Outbound* m_outbound;                               // NUM_MSG_TYPES
+        mutable ACE_Thread_Mutex m_locks[OPCODE_PROFILE_LOCKS];
+
+        std::atomic<uint32> m_since;                        // getMSTime() of the last reset
+
+        uint32 m_windowLength;                              // ms
+        uint32 m_csvInterval;                               // ms, 0 to disable
+        std::string m_csvFile;
+
+        uint32 m_windowTimer;
+        uint32 m_csvTimer;
+};
+
+#define sOpcodeProfiler MaNGOS::Singleton<OpcodeProfiler>::Instance()
+
+#endif
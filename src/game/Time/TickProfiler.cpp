@@ -0,0 +1,346 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "TickProfiler.h"
+#include "Config.h"
+#include "Log.h"
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <cstdio>
+#include <ctime>
+
+INSTANTIATE_SINGLETON_1(TickProfiler);
+
+PerfHistogram::PerfHistogram() : m_current(0)
+{
+    memset(m_windows, 0, sizeof(m_windows));
+}
+
+uint32 PerfHistogram::BucketOf(uint32 usec)
+{
+    if (usec < 16)
+    {
+        return usec;
+    }
+
+    uint32 msb = 0;
+    for (uint32 v = usec; v > 1; v >>= 1)
+    {
+        ++msb;
+    }
+
+    return 16 + (msb - 4) * 8 + ((usec >> (msb - 3)) & 7);
+}
+
+uint32 PerfHistogram::BucketUpperBound(uint32 bucket)
+{
+    if (bucket < 16)
+    {
+        return bucket;
+    }
+
+    uint32 msb = (bucket - 16) / 8 + 4;
+    uint64 low = uint64(8 + (bucket - 16) % 8) << (msb - 3);
+    return uint32(std::min(low + (uint64(1) << (msb - 3)) - 1, uint64(0xFFFFFFFF)));
+}
+
+void PerfHistogram::Add(uint32 usec)
+{
+    Window& window = m_windows[m_current];
+    ++window.buckets[BucketOf(usec)];
+    ++window.count;
+    if (usec > window.max)
+    {
+        window.max = usec;
+    }
+}
+
+void PerfHistogram::Rotate()
+{
+    m_current ^= 1;
+    memset(&m_windows[m_current], 0, sizeof(Window));
+}
+
+uint32 PerfHistogram::GetCount() const
+{
+    return m_windows[0].count + m_windows[1].count;
+}
+
+uint32 PerfHistogram::GetMax() const
+{
+    return std::max(m_windows[0].max, m_windows[1].max);
+}
+
+uint32 PerfHistogram::GetPercentile(uint32 percent) const
+{
+    uint32 count = GetCount();
+    if (!count)
+    {
+        return 0;
+    }
+
+    // rank of the requested sample, rounded up
+    uint64 rank = (uint64(count) * percent + 99) / 100;
+    uint64 seen = 0;
+    for (uint32 i = 0; i < PERF_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += m_windows[0].buckets[i] + m_windows[1].buckets[i];
+        if (seen >= rank)
+        {
+            return std::min(BucketUpperBound(i), GetMax());
+        }
+    }
+
+    return GetMax();
+}
+
+PerfProfile::PerfProfile(uint32 phaseCount, uint32 mapId, uint32 instanceId, char const* name) :
+    m_phases(phaseCount), m_mapId(mapId), m_instanceId(instanceId), m_name(name ? name : "")
+{
+}
+
+void PerfProfile::Add(uint32 phase, uint32 usec)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_phases[phase].Add(usec);
+}
+
+void PerfProfile::Rotate()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (std::vector<PerfHistogram>::iterator itr = m_phases.begin(); itr != m_phases.end(); ++itr)
+    {
+        itr->Rotate();
+    }
+}
+
+void PerfProfile::Snapshot(std::vector<PerfHistogram>& phases) const
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    phases = m_phases;
+}
+
+PerfPhaseTimer::PerfPhaseTimer(PerfProfile& profile) : m_profile(sTickProfiler.IsEnabled() ? &profile : NULL)
+{
+    if (m_profile)
+    {
+        m_start = m_last = ACE_OS::gettimeofday();
+    }
+}
+
+void PerfPhaseTimer::Lap(uint32 phase)
+{
+    if (!m_profile)
+    {
+        return;
+    }
+
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    ACE_UINT64 elapsed;
+    (now - m_last).to_usec(elapsed);
+    m_profile->Add(phase, uint32(elapsed));
+    m_last = now;
+}
+
+void PerfPhaseTimer::Total(uint32 phase)
+{
+    if (!m_profile)
+    {
+        return;
+    }
+
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    ACE_UINT64 elapsed;
+    (now - m_start).to_usec(elapsed);
+    m_profile->Add(phase, uint32(elapsed));
+    m_last = now;
+}
+
+TickProfiler::TickProfiler() : m_enabled(false), m_windowLength(60 * IN_MILLISECONDS), m_csvInterval(0),
+    m_windowTimer(0), m_csvTimer(0), m_worldProfile(WORLD_PERF_PHASE_COUNT)
+{
+}
+
+TickProfiler::~TickProfiler()
+{
+}
+
+void TickProfiler::LoadFromConfig()
+{
+    m_enabled = sConfig.GetBoolDefault("PerfProfiler.Enable", false);
+    m_windowLength = std::max(sConfig.GetIntDefault("PerfProfiler.Window", 60), 1) * IN_MILLISECONDS;
+    m_csvInterval = std::max(sConfig.GetIntDefault("PerfProfiler.CsvInterval", 0), 0) * IN_MILLISECONDS;
+
+    m_csvFile = sConfig.GetStringDefault("PerfProfiler.CsvFile", "");
+    if (!m_csvFile.empty())
+    {
+        m_csvFile = sLog.GetLogsDir() + m_csvFile;
+    }
+}
+
+void TickProfiler::Update(uint32 diff)
+{
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    m_csvTimer += diff;
+    if (m_csvInterval && !m_csvFile.empty() && m_csvTimer >= m_csvInterval)
+    {
+        m_csvTimer = 0;
+        WriteCsv();
+    }
+
+    m_windowTimer += diff;
+    if (m_windowTimer >= m_windowLength)
+    {
+        m_windowTimer = 0;
+        Rotate();
+    }
+}
+
+void TickProfiler::RegisterMapProfile(PerfProfile* profile)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mapProfilesLock);
+    m_mapProfiles.insert(profile);
+}
+
+void TickProfiler::UnregisterMapProfile(PerfProfile* profile)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mapProfilesLock);
+    m_mapProfiles.erase(profile);
+}
+
+void TickProfiler::GetMapReports(std::vector<MapReport>& reports, int32 mapId) const
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mapProfilesLock);
+
+    for (MapProfileSet::const_iterator itr = m_mapProfiles.begin(); itr != m_mapProfiles.end(); ++itr)
+    {
+        if (mapId >= 0 && (*itr)->GetMapId() != uint32(mapId))
+        {
+            continue;
+        }
+
+        reports.push_back(MapReport());
+        MapReport& report = reports.back();
+        report.mapId = (*itr)->GetMapId();
+        report.instanceId = (*itr)->GetInstanceId();
+        report.name = (*itr)->GetName();
+        (*itr)->Snapshot(report.phases);
+    }
+}
+
+void TickProfiler::Rotate()
+{
+    m_worldProfile.Rotate();
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mapProfilesLock);
+    for (MapProfileSet::const_iterator itr = m_mapProfiles.begin(); itr != m_mapProfiles.end(); ++itr)
+    {
+        (*itr)->Rotate();
+    }
+}
+
+void TickProfiler::WriteCsv()
+{
+    FILE* file = OpenCsvFile(m_csvFile, "time,map,instance,phase,count,p50,p95,p99,max");
+    if (!file)
+    {
+        sLog.outError("TickProfiler: can't open %s for writing.", m_csvFile.c_str());
+        return;
+    }
+
+    unsigned long long now = (unsigned long long)time(NULL);
+
+    std::vector<PerfHistogram> phases;
+    GetWorldReport(phases);
+    for (uint32 i = 0; i < phases.size(); ++i)
+    {
+        fprintf(file, "%llu,world,0,%s,%u,%u,%u,%u,%u\n", now, GetWorldPhaseName(i), phases[i].GetCount(),
+                phases[i].GetPercentile(50), phases[i].GetPercentile(95), phases[i].GetPercentile(99), phases[i].GetMax());
+    }
+
+    std::vector<MapReport> reports;
+    GetMapReports(reports);
+    for (std::vector<MapReport>::const_iterator itr = reports.begin(); itr != reports.end(); ++itr)
+    {
+        for (uint32 i = 0; i < itr->phases.size(); ++i)
+        {
+            PerfHistogram const& phase = itr->phases[i];
+            if (!phase.GetCount())
+            {
+                continue;
+            }
+
+            fprintf(file, "%llu,%u,%u,%s,%u,%u,%u,%u,%u\n", now, itr->mapId, itr->instanceId, GetMapPhaseName(i), phase.GetCount(),
+                    phase.GetPercentile(50), phase.GetPercentile(95), phase.GetPercentile(99), phase.GetMax());
+        }
+    }
+
+    fclose(file);
+}
+
+FILE* TickProfiler::OpenCsvFile(std::string const& fileName, char const* header)
+{
+    FILE* file = fopen(fileName.c_str(), "a");
+    if (!file)
+    {
+        return NULL;
+    }
+
+    // the position right after opening in append mode isn't the end of the file on every platform
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0)
+    {
+        fprintf(file, "%s\n", header);
+    }
+
+    return file;
+}
+
+char const* TickProfiler::GetWorldPhaseName(uint32 phase)
+{
+    static char const* names[WORLD_PERF_PHASE_COUNT] =
+    {
+        "total", "auctions", "sessions", "maps", "battlegrounds", "lfg", "outdoorpvp",
+        "resultqueue", "gameevents", "removelist", "clicommands", "terrain"
+    };
+
+    return phase < WORLD_PERF_PHASE_COUNT ? names[phase] : "unknown";
+}
+
+char const* TickProfiler::GetMapPhaseName(uint32 phase)
+{
+    static char const* names[MAP_PERF_PHASE_COUNT] =
+    {
+        "total", "sessions", "players", "transports", "cells", "objectupdates", "gridstates",
+        "scripts", "instance", "region", "regionmerge"
+    };
+
+    return phase < MAP_PERF_PHASE_COUNT ? names[phase] : "unknown";
+}
@@ -0,0 +1,214 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Time_Value.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+/// Buckets of a PerfHistogram: exact below 16us, then 8 buckets per power of two
+#define PERF_HISTOGRAM_BUCKETS 240
+
+/// Phases of World::Update
+enum WorldPerfPhase
+{
+    WORLD_PERF_TOTAL,
+    WORLD_PERF_AUCTIONS,
+    WORLD_PERF_SESSIONS,
+    WORLD_PERF_MAPS,
+    WORLD_PERF_BATTLEGROUNDS,
+    WORLD_PERF_LFG,
+    WORLD_PERF_OUTDOORPVP,
+    WORLD_PERF_RESULT_QUEUE,
+    WORLD_PERF_GAME_EVENTS,
+    WORLD_PERF_REMOVE_LIST,
+    WORLD_PERF_CLI_COMMANDS,
+    WORLD_PERF_TERRAIN,
+    WORLD_PERF_PHASE_COUNT
+};
+
+/// Phases of Map::Update
+enum MapPerfPhase
+{
+    MAP_PERF_TOTAL,
+    MAP_PERF_SESSIONS,
+    MAP_PERF_PLAYERS,
+    MAP_PERF_TRANSPORTS,
+    MAP_PERF_CELLS,                                         // VisitNearbyCellsOf around players and active objects
+    MAP_PERF_OBJECT_UPDATES,                                // SendObjectUpdates
+    MAP_PERF_GRID_STATES,
+    MAP_PERF_SCRIPTS,                                       // ScriptsProcess
+    MAP_PERF_INSTANCE,                                      // Eluna, instance data and weather
+    MAP_PERF_REGION,                                        // cells of one region of a region-partitioned update
+    MAP_PERF_REGION_MERGE,                                  // part of MAP_PERF_CELLS
+    MAP_PERF_PHASE_COUNT
+};
+
+/**
+ * @brief Histogram of durations in microseconds over a rolling window.
+ *
+ * Samples go to the current window, queries cover the current and the previous window.
+ */
+class PerfHistogram
+{
+    public:
+        PerfHistogram();
+
+        void Add(uint32 usec);
+        void Rotate();
+
+        uint32 GetCount() const;
+        uint32 GetMax() const;
+        uint32 GetPercentile(uint32 percent) const;
+
+    private:
+        struct Window
+        {
+            uint32 buckets[PERF_HISTOGRAM_BUCKETS];
+            uint32 count;
+            uint32 max;
+        };
+
+        static uint32 BucketOf(uint32 usec);
+        static uint32 BucketUpperBound(uint32 bucket);
+
+        Window m_windows[2];
+        uint32 m_current;
+};
+
+/**
+ * @brief Histograms of all phases of one update loop, World::Update or one map.
+ */
+class PerfProfile
+{
+    public:
+        PerfProfile(uint32 phaseCount, uint32 mapId = 0, uint32 instanceId = 0, char const* name = "");
+
+        void Add(uint32 phase, uint32 usec);
+        void Rotate();
+
+        /// Copies the histograms, safe against concurrent Add() calls
+        void Snapshot(std::vector<PerfHistogram>& phases) const;
+
+        uint32 GetMapId() const { return m_mapId; }
+        uint32 GetInstanceId() const { return m_instanceId; }
+        std::string const& GetName() const { return m_name; }
+
+    private:
+        std::vector<PerfHistogram> m_phases;
+        mutable ACE_Thread_Mutex m_lock;                    // regions of the same map report concurrently
+
+        uint32 m_mapId;
+        uint32 m_instanceId;
+        std::string m_name;
+};
+
+/**
+ * @brief Records the time spent in consecutive phases of an update with one clock read per phase.
+ */
+class PerfPhaseTimer
+{
+    public:
+        explicit PerfPhaseTimer(PerfProfile& profile);
+
+        /// Accounts the time since the previous lap (or the start) to the phase
+        void Lap(uint32 phase);
+        /// Accounts the time since the start to the phase
+        void Total(uint32 phase);
+
+    private:
+        PerfProfile* m_profile;                             // NULL while the profiler is disabled
+        ACE_Time_Value m_start;
+        ACE_Time_Value m_last;
+};
+
+/**
+ * @brief Collects the per-phase timings of World::Update and every map.
+ *
+ * Queried by the .server perf command, and dumped to a CSV file periodically.
+ */
+class TickProfiler
+{
+    public:
+        TickProfiler();
+        ~TickProfiler();
+
+        void LoadFromConfig();
+        void Update(uint32 diff);
+
+        bool IsEnabled() const { return m_enabled; }
+
+        PerfProfile& GetWorldProfile() { return m_worldProfile; }
+
+        void RegisterMapProfile(PerfProfile* profile);
+        void UnregisterMapProfile(PerfProfile* profile);
+
+        struct MapReport
+        {
+            uint32 mapId;
+            uint32 instanceId;
+            std::string name;
+            std::vector<PerfHistogram> phases;
+        };
+
+        void GetWorldReport(std::vector<PerfHistogram>& phases) const { m_worldProfile.Snapshot(phases); }
+        /// Snapshots of all maps, or of all instances of one map
+        void GetMapReports(std::vector<MapReport>& reports, int32 mapId = -1) const;
+
+        static char const* GetWorldPhaseName(uint32 phase);
+        static char const* GetMapPhaseName(uint32 phase);
+
+        /// Opens a CSV file for appending, the header is written first into a new or empty file. NULL if it can't be opened
+        static FILE* OpenCsvFile(std::string const& fileName, char const* header);
+
+    private:
+        void Rotate();
+        void WriteCsv();
+
+        bool m_enabled;
+        uint32 m_windowLength;                              // ms
+        uint32 m_csvInterval;                               // ms, 0 to disable
+        std::string m_csvFile;
+
+        uint32 m_windowTimer;
+        uint32 m_csvTimer;
+
+        PerfProfile m_worldProfile;
+
+        typedef std::set<PerfProfile*> MapProfileSet;
+        MapProfileSet m_mapProfiles;
+        mutable ACE_Thread_Mutex m_mapProfilesLock;
+};
+
+#define sTickProfiler MaNGOS::Singleton<TickProfiler>::Instance()
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "Common.h"
 #include "GameSystem/NGrid.h"
+#include "CellObjectIndex.h"
 #include <cmath>
 
 // Forward class definitions
@@ -76,8 +77,8 @@ typedef GridRefManager<DynamicObject>   DynamicObjectMapType;
 typedef GridRefManager<GameObject>      GameObjectMapType;
 typedef GridRefManager<Player>          PlayerMapType;
 
-typedef Grid<Player, WorldTypeMapContainer, GridTypeMapContainer> GridType;
-typedef NGrid<MAX_NUMBER_OF_CELLS, Player, WorldTypeMapContainer, GridTypeMapContainer> NGridType;
+typedef Grid<Player, WorldTypeMapContainer, GridTypeMapContainer, CellObjectIndex> GridType;
+typedef NGrid<MAX_NUMBER_OF_CELLS, Player, WorldTypeMapContainer, GridTypeMapContainer, CellObjectIndex> NGridType;
 
 /**
  * @brief A structure representing a pair of coordinates.
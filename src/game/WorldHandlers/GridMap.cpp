@@ -30,10 +30,14 @@
 #include "GridMap.h"
 #include "VMapFactory.h"
 #include "MoveMap.h"
+#include "MapTree.h"
 #include "World.h"
 #include "Policies/Singleton.h"
 #include "Util.h"
 
+#include <ace/Mem_Map.h>
+#include <ace/OS_NS_unistd.h>
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "z1.5";
 char const* MAP_AREA_MAGIC    = "AREA";
@@ -68,6 +72,8 @@ GridMap::GridMap()
     m_liquidFlags = NULL;
     m_liquidEntry = NULL;
     m_liquid_map  = NULL;
+
+    m_mappedFile = NULL;
 }
 
 GridMap::~GridMap()
@@ -80,6 +86,11 @@ bool GridMap::loadData(char* filename)
     // Unload old data if exist
     unloadData();
 
+    if (sWorld.getConfig(CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED))
+    {
+        return loadMappedData(filename);
+    }
+
     GridMapFileHeader header;
     // Not return error if file not found
     FILE* in = fopen(filename, "rb");
@@ -136,12 +147,34 @@ bool GridMap::loadData(char* filename)
 
 void GridMap::unloadData()
 {
-    delete[] m_area_map;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] m_liquidEntry;
-    delete[] m_liquidFlags;
-    delete[] m_liquid_map;
+    // arrays pointing into the mapped file go away with the mapping
+    if (!isMapped(m_area_map))
+    {
+        delete[] m_area_map;
+    }
+    if (!isMapped(m_V9))
+    {
+        delete[] m_V9;
+    }
+    if (!isMapped(m_V8))
+    {
+        delete[] m_V8;
+    }
+    if (!isMapped(m_liquidEntry))
+    {
+        delete[] m_liquidEntry;
+    }
+    if (!isMapped(m_liquidFlags))
+    {
+        delete[] m_liquidFlags;
+    }
+    if (!isMapped(m_liquid_map))
+    {
+        delete[] m_liquid_map;
+    }
+
+    delete m_mappedFile;
+    m_mappedFile = NULL;
 
     m_area_map = NULL;
     m_V9 = NULL;
@@ -321,6 +354,249 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
+bool GridMap::loadMappedData(char* filename)
+{
+    ACE_Mem_Map* file = new ACE_Mem_Map();
+    if (file->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, MAP_SHARED) == -1)
+    {
+        delete file;
+
+        // Not return error if file not found
+        return ACE_OS::access(filename, F_OK) != 0;
+    }
+
+    m_mappedFile = file;
+
+    uint8 const* data = static_cast<uint8 const*>(file->addr());
+    if (file->size() < sizeof(GridMapFileHeader))
+    {
+        sLog.outError("Map file '%s' is truncated.", filename);
+        unloadData();
+        return false;
+    }
+
+    GridMapFileHeader const& header = *reinterpret_cast<GridMapFileHeader const*>(data);
+    if (header.mapMagic     == *((uint32 const*)(MAP_MAGIC)) &&
+            header.versionMagic == *((uint32 const*)(MAP_VERSION_MAGIC)) &&
+            IsAcceptableClientBuild(header.buildMagic))
+    {
+        // loadup area data
+        if (header.areaMapOffset && !mapAreaData(data, header.areaMapOffset, header.areaMapSize))
+        {
+            sLog.outError("Error loading map area data\n");
+            unloadData();
+            return false;
+        }
+
+        // loadup holes data
+        if (header.holesOffset)
+        {
+            if (size_t(header.holesOffset) + sizeof(m_holes) > file->size())
+            {
+                sLog.outError("Error loading map holes data\n");
+                unloadData();
+                return false;
+            }
+
+            memcpy(m_holes, data + header.holesOffset, sizeof(m_holes));
+        }
+
+        // loadup height data
+        if (header.heightMapOffset && !mapHeightData(data, header.heightMapOffset, header.heightMapSize))
+        {
+            sLog.outError("Error loading map height data\n");
+            unloadData();
+            return false;
+        }
+
+        // loadup liquid data
+        if (header.liquidMapOffset && !mapGridMapLiquidData(data, header.liquidMapOffset, header.liquidMapSize))
+        {
+            sLog.outError("Error loading map liquids data\n");
+            unloadData();
+            return false;
+        }
+
+#ifdef MADV_WILLNEED
+        // start reading the pages in, the first lookups will most likely hit them
+        file->advise(MADV_WILLNEED);
+#endif
+        return true;
+    }
+
+    sLog.outError("Map file '%s' is non-compatible version created with a different map-extractor version.", filename);
+    unloadData();
+    return false;
+}
+
+bool GridMap::isMapped(void const* ptr) const
+{
+    if (!m_mappedFile || !ptr)
+    {
+        return false;
+    }
+
+    uint8 const* base = static_cast<uint8 const*>(m_mappedFile->addr());
+    return ptr >= base && ptr < base + m_mappedFile->size();
+}
+
+// points into the mapping if the array is properly aligned, some sections of the
+// extractor output are not, those are copied to the heap
+template<typename T>
+T* GridMap::mapArray(uint8 const* data, uint32 count)
+{
+    if (reinterpret_cast<size_t>(data) % sizeof(T) == 0)
+    {
+        return reinterpret_cast<T*>(const_cast<uint8*>(data));
+    }
+
+    T* copy = new T[count];
+    memcpy(copy, data, count * sizeof(T));
+    return copy;
+}
+
+bool GridMap::mapAreaData(uint8 const* data, uint32 offset, uint32 /*size*/)
+{
+    size_t fileSize = m_mappedFile->size();
+    if (size_t(offset) + sizeof(GridMapAreaHeader) > fileSize)
+    {
+        return false;
+    }
+
+    GridMapAreaHeader header;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
+    {
+        return false;
+    }
+
+    m_gridArea = header.gridArea;
+    if (!(header.flags & MAP_AREA_NO_AREA))
+    {
+        offset += sizeof(header);
+        if (size_t(offset) + 16 * 16 * sizeof(uint16) > fileSize)
+        {
+            return false;
+        }
+
+        m_area_map = mapArray<uint16>(data + offset, 16 * 16);
+    }
+
+    return true;
+}
+
+bool GridMap::mapHeightData(uint8 const* data, uint32 offset, uint32 /*size*/)
+{
+    size_t fileSize = m_mappedFile->size();
+    if (size_t(offset) + sizeof(GridMapHeightHeader) > fileSize)
+    {
+        return false;
+    }
+
+    GridMapHeightHeader header;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+    {
+        return false;
+    }
+
+    m_gridHeight = header.gridHeight;
+    if (header.flags & MAP_HEIGHT_NO_HEIGHT)
+    {
+        m_gridGetHeight = &GridMap::getHeightFromFlat;
+        return true;
+    }
+
+    offset += sizeof(header);
+
+    if ((header.flags & MAP_HEIGHT_AS_INT16))
+    {
+        if (size_t(offset) + (129 * 129 + 128 * 128) * sizeof(uint16) > fileSize)
+        {
+            return false;
+        }
+
+        m_uint16_V9 = mapArray<uint16>(data + offset, 129 * 129);
+        m_uint16_V8 = mapArray<uint16>(data + offset + 129 * 129 * sizeof(uint16), 128 * 128);
+        m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
+        m_gridGetHeight = &GridMap::getHeightFromUint16;
+    }
+    else if ((header.flags & MAP_HEIGHT_AS_INT8))
+    {
+        if (size_t(offset) + (129 * 129 + 128 * 128) * sizeof(uint8) > fileSize)
+        {
+            return false;
+        }
+
+        m_uint8_V9 = mapArray<uint8>(data + offset, 129 * 129);
+        m_uint8_V8 = mapArray<uint8>(data + offset + 129 * 129 * sizeof(uint8), 128 * 128);
+        m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
+        m_gridGetHeight = &GridMap::getHeightFromUint8;
+    }
+    else
+    {
+        if (size_t(offset) + (129 * 129 + 128 * 128) * sizeof(float) > fileSize)
+        {
+            return false;
+        }
+
+        m_V9 = mapArray<float>(data + offset, 129 * 129);
+        m_V8 = mapArray<float>(data + offset + 129 * 129 * sizeof(float), 128 * 128);
+        m_gridGetHeight = &GridMap::getHeightFromFloat;
+    }
+
+    return true;
+}
+
+bool GridMap::mapGridMapLiquidData(uint8 const* data, uint32 offset, uint32 /*size*/)
+{
+    size_t fileSize = m_mappedFile->size();
+    if (size_t(offset) + sizeof(GridMapLiquidHeader) > fileSize)
+    {
+        return false;
+    }
+
+    GridMapLiquidHeader header;
+    memcpy(&header, data + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+    {
+        return false;
+    }
+
+    m_liquidType    = header.liquidType;
+    m_liquid_offX   = header.offsetX;
+    m_liquid_offY   = header.offsetY;
+    m_liquid_width  = header.width;
+    m_liquid_height = header.height;
+    m_liquidLevel   = header.liquidLevel;
+
+    offset += sizeof(header);
+
+    if (!(header.flags & MAP_LIQUID_NO_TYPE))
+    {
+        if (size_t(offset) + 16 * 16 * (sizeof(uint16) + sizeof(uint8)) > fileSize)
+        {
+            return false;
+        }
+
+        m_liquidEntry = mapArray<uint16>(data + offset, 16 * 16);
+        m_liquidFlags = mapArray<uint8>(data + offset + 16 * 16 * sizeof(uint16), 16 * 16);
+        offset += 16 * 16 * (sizeof(uint16) + sizeof(uint8));
+    }
+
+    if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
+    {
+        if (size_t(offset) + m_liquid_width * m_liquid_height * sizeof(float) > fileSize)
+        {
+            return false;
+        }
+
+        m_liquid_map = mapArray<float>(data + offset, m_liquid_width * m_liquid_height);
+    }
+
+    return true;
+}
+
 uint16 GridMap::getArea(float x, float y)
 {
     if (!m_area_map)
@@ -814,6 +1090,8 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid), m_refMutex(), m_mutex()
         {
             m_GridMaps[i][k] = NULL;
             m_GridRef[i][k] = 0;
+            m_PrefetchedMaps[i][k] = NULL;
+            m_PrefetchedAged[i][k] = false;
         }
     }
 
@@ -832,6 +1110,7 @@ TerrainInfo::~TerrainInfo()
         for (int i = 0; i < MAX_NUMBER_OF_GRIDS; ++i)
         {
             delete m_GridMaps[i][k];
+            delete m_PrefetchedMaps[i][k];
         }
 
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
@@ -881,6 +1160,30 @@ void TerrainInfo::CleanUpGrids(const uint32 diff)
         return;
     }
 
+    {
+        ACE_GUARD(LOCK_TYPE, lock, m_mutex)
+
+        // prefetched grids nobody entered since the previous clean up won't be needed anymore
+        for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
+        {
+            for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
+            {
+                if (!m_PrefetchedMaps[x][y])
+                {
+                    continue;
+                }
+
+                if (m_PrefetchedAged[x][y])
+                {
+                    delete m_PrefetchedMaps[x][y];
+                    m_PrefetchedMaps[x][y] = NULL;
+                }
+
+                m_PrefetchedAged[x][y] = !m_PrefetchedAged[x][y];
+            }
+        }
+    }
+
     for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
@@ -1291,21 +1594,17 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
 
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
-
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
-
-            if (!map->loadData(tmp))
+            // take over the GridMap read by the grid preloader, if any
+            GridMap* map = m_PrefetchedMaps[x][y];
+            if (map)
             {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
+                m_PrefetchedMaps[x][y] = NULL;
+            }
+            else
+            {
+                map = LoadGridMap(x, y);
             }
 
-            delete[] tmp;
             m_GridMaps[x][y] = map;
 
             // load VMAPs for current map/grid...
@@ -1334,6 +1633,91 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y)
     return  m_GridMaps[x][y];
 }
 
+GridMap* TerrainInfo::LoadGridMap(const uint32 x, const uint32 y) const
+{
+    GridMap* map = new GridMap();
+
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
+    DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+    if (!map->loadData(tmp))
+    {
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
+
+    delete[] tmp;
+    return map;
+}
+
+// read the whole file once, so the following load is served from the OS file cache
+static void WarmUpFile(std::string const& fileName)
+{
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        return;
+    }
+
+    char buffer[64 * 1024];
+    while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer)) {}
+
+    fclose(file);
+}
+
+bool TerrainInfo::IsPrefetched(const uint32 x, const uint32 y) const
+{
+    // the slots are filled by the preloader threads and emptied by Unload() on map threads
+    ACE_GUARD_RETURN(LOCK_TYPE, lock, m_mutex, false)
+
+    return m_GridMaps[x][y] || m_PrefetchedMaps[x][y];
+}
+
+void TerrainInfo::Prefetch(const uint32 x, const uint32 y)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    if (IsPrefetched(x, y))
+    {
+        return;
+    }
+
+    // the .map data is private to the GridMap object, so it is read completely outside of the lock
+    GridMap* map = LoadGridMap(x, y);
+
+    // vmap and mmap tiles are linked into trees the map threads are reading,
+    // so only their files are read here and the cheap link-in stays with Load()
+    if (VMAP::VMapFactory::createOrGetVMapManager()->isMapLoadingEnabled())
+    {
+        WarmUpFile(sWorld.GetDataPath() + "vmaps/" + VMAP::StaticMapTree::getTileFileName(m_mapId, x, y));
+    }
+
+    if (sWorld.getConfig(CONFIG_BOOL_MMAP_ENABLED))
+    {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "mmaps/%03u%02u%02u.mmtile", m_mapId, x, y);
+        WarmUpFile(sWorld.GetDataPath() + fileName);
+    }
+
+    {
+        ACE_GUARD(LOCK_TYPE, lock, m_mutex)
+
+        if (!m_GridMaps[x][y] && !m_PrefetchedMaps[x][y])
+        {
+            m_PrefetchedMaps[x][y] = map;
+            m_PrefetchedAged[x][y] = false;
+            return;
+        }
+    }
+
+    // a map thread loaded the grid meanwhile
+    delete map;
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= NULL*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
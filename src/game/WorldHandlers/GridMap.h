@@ -120,6 +120,8 @@ struct GridMapLiquidData
     float depth_level;
 };
 
+class ACE_Mem_Map;
+
 class GridMap
 {
     private:
@@ -162,6 +164,17 @@ class GridMap
         bool loadHeightData(FILE* in, uint32 offset, uint32 size);
         bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
         bool loadHolesData(FILE* in, uint32 offset, uint32 size);
+
+        // zero-copy loading, the data arrays point into the read-only mapped file
+        ACE_Mem_Map* m_mappedFile;
+
+        bool loadMappedData(char* filename);
+        bool mapAreaData(uint8 const* data, uint32 offset, uint32 size);
+        bool mapHeightData(uint8 const* data, uint32 offset, uint32 size);
+        bool mapGridMapLiquidData(uint8 const* data, uint32 offset, uint32 size);
+        bool isMapped(void const* ptr) const;
+        template<typename T> T* mapArray(uint8 const* data, uint32 count);
+
         bool isHole(int row, int col) const;
 
         // Get height functions and pointers
@@ -255,16 +268,22 @@ class TerrainInfo : public Referencable<AtomicLong>
 
     protected:
         friend class Map;
+        friend class GridPreloader;
         // load/unload terrain data
         GridMap* Load(const uint32 x, const uint32 y);
         void Unload(const uint32 x, const uint32 y);
 
+        // read the terrain files of a grid ahead of Load(), used by the grid preloader threads
+        void Prefetch(const uint32 x, const uint32 y);
+        bool IsPrefetched(const uint32 x, const uint32 y) const;
+
     private:
         TerrainInfo(const TerrainInfo&);
         TerrainInfo& operator=(const TerrainInfo&);
 
         GridMap* GetGrid(const float x, const float y);
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y);
+        GridMap* LoadGridMap(const uint32 x, const uint32 y) const;
 
         int RefGrid(const uint32& x, const uint32& y);
         int UnrefGrid(const uint32& x, const uint32& y);
@@ -274,11 +293,15 @@ class TerrainInfo : public Referencable<AtomicLong>
         GridMap* m_GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         int16 m_GridRef[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
+        // GridMap objects read by Prefetch() that no map has loaded yet
+        GridMap* m_PrefetchedMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        bool m_PrefetchedAged[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
         // global garbage collection timer
         IntervalTimer i_timer;
 
         typedef ACE_Thread_Mutex LOCK_TYPE;
-        LOCK_TYPE m_mutex;
+        mutable LOCK_TYPE m_mutex;
         char _cache_guard[1024];
         LOCK_TYPE m_refMutex;
 };
@@ -31,9 +31,40 @@
 #include "ObjectAccessor.h"
 #include "BattleGround/BattleGroundMgr.h"
 #include "CreatureAI.h"
+#include "World.h"
 
 using namespace MaNGOS;
 
+bool MaNGOS::IsFarViewer(Camera* camera, WorldObject const* obj, float farDistSq)
+{
+    WorldObject* body = camera->GetBody();
+    float dx = body->GetPositionX() - obj->GetPositionX();
+    float dy = body->GetPositionY() - obj->GetPositionY();
+    if (dx * dx + dy * dy <= farDistSq)
+    {
+        return false;
+    }
+
+    // what the player interacts with stays at full rate
+    Player* owner = camera->GetOwner();
+    if (owner->GetSelectionGuid() == obj->GetObjectGuid())
+    {
+        return false;
+    }
+
+    if (obj->isType(TYPEMASK_UNIT) && ((Unit const*)obj)->GetCharmerOrOwnerGuid() == owner->GetObjectGuid())
+    {
+        return false;
+    }
+
+    if (obj->GetTypeId() == TYPEID_PLAYER && owner->IsInSameRaidWith((Player const*)obj))
+    {
+        return false;
+    }
+
+    return true;
+}
+
 void VisibleChangesNotifier::Visit(CameraMapType& m)
 {
     for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
@@ -42,16 +73,32 @@ void VisibleChangesNotifier::Visit(CameraMapType& m)
     }
 }
 
+VisibleNotifier::VisibleNotifier(Camera& c) : i_camera(c), i_farDistSq(0.0f)
+{
+    // with a bandwidth budget, far creates are sent apart so they can wait behind everything else
+    if (sWorld.getConfig(CONFIG_UINT32_SESSION_BANDWIDTH))
+    {
+        float farDist = c.GetBody()->GetMap()->GetVisibilityDistance() / 2;
+        i_farDistSq = farDist * farDist;
+    }
+}
+
 void VisibleNotifier::Notify()
 {
     Player& player = *i_camera.GetOwner();
-    // at this moment i_clientGUIDs have guids that not iterate at grid level checks
+
+    std::sort(i_visitedGUIDs.begin(), i_visitedGUIDs.end());
+    i_visitedGUIDs.erase(std::unique(i_visitedGUIDs.begin(), i_visitedGUIDs.end()), i_visitedGUIDs.end());
+
+    // at this moment the client knows guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = player.GetTransport())
     {
+        GuidVector passengers;
         for (UnitSet::const_iterator itr = transport->GetPassengers().begin(); itr != transport->GetPassengers().end(); ++itr)
         {
-            if (i_clientGUIDs.find((*itr)->GetObjectGuid()) != i_clientGUIDs.end())
+            ObjectGuid guid = (*itr)->GetObjectGuid();
+            if (player.m_clientGUIDs.contains(guid) && !std::binary_search(i_visitedGUIDs.begin(), i_visitedGUIDs.end(), guid))
             {
                 // ignore far sight case
                 if(Player* p = (*itr)->ToPlayer())
@@ -59,27 +106,36 @@ void VisibleNotifier::Notify()
                     p->UpdateVisibilityOf(p, &player);
                 }
                 player.UpdateVisibilityOf(&player, (WorldObject*)(*itr), i_data, i_visibleNow);
-                i_clientGUIDs.erase((*itr)->GetObjectGuid());
+                passengers.push_back(guid);
             }
         }
+
+        if (!passengers.empty())
+        {
+            i_visitedGUIDs.insert(i_visitedGUIDs.end(), passengers.begin(), passengers.end());
+            std::sort(i_visitedGUIDs.begin(), i_visitedGUIDs.end());
+        }
     }
 
-    // generate outOfRange for not iterate objects
-    i_data.AddOutOfRangeGUID(i_clientGUIDs);
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
+    // generate outOfRange for not iterate objects, both lists are sorted so this is one sweep each
+    GuidVector outOfRange;
+    player.m_clientGUIDs.Difference(i_visitedGUIDs, outOfRange);
+    if (!outOfRange.empty())
     {
-        player.m_clientGUIDs.erase(*itr);
+        i_data.AddOutOfRangeGUID(outOfRange);
+        player.m_clientGUIDs.erase(outOfRange);
 
-        DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is out of range (no in active cells set) now for %s",
-                         itr->GetString().c_str(), player.GetGuidStr().c_str());
+        for (GuidVector::const_iterator itr = outOfRange.begin(); itr != outOfRange.end(); ++itr)
+        {
+            DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is out of range (no in active cells set) now for %s",
+                             itr->GetString().c_str(), player.GetGuidStr().c_str());
+        }
     }
 
     if (i_data.HasData())
     {
         // send create/outofrange packet to player (except player create updates that already sent using SendUpdateToPlayer)
-        WorldPacket packet;
-        i_data.BuildPacket(&packet);
-        player.GetSession()->SendPacket(&packet);
+        player.GetSession()->SendUpdateData(i_data);
 
         // send out of range to other players if need
         GuidSet const& oor = i_data.GetOutOfRangeGUIDs();
@@ -97,6 +153,11 @@ void VisibleNotifier::Notify()
         }
     }
 
+    if (i_farData.HasData())
+    {
+        player.GetSession()->SendUpdateData(i_farData, false, OUTBOUND_PRIORITY_CREATE_FAR);
+    }
+
     // Now do operations that required done at object visibility change to visible
 
     // send data at target visibility change (adding to client)
@@ -120,7 +181,7 @@ void MessageDeliverer::Visit(CameraMapType& m)
         {
             if (WorldSession* session = owner->GetSession())
             {
-                session->SendPacket(i_message);
+                i_sender.SendTo(session);
             }
         }
     }
@@ -139,7 +200,30 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
 
         if (WorldSession* session = owner->GetSession())
         {
-            session->SendPacket(i_message);
+            i_sender.SendTo(session);
+        }
+    }
+}
+
+void MovementMessageDeliverer::Visit(CameraMapType& m)
+{
+    for (CameraMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
+    {
+        Player* owner = iter->getSource()->GetOwner();
+
+        if (owner == i_skipped_receiver)
+        {
+            continue;
+        }
+
+        if (i_farDistSq > 0.0f && IsFarViewer(iter->getSource(), i_mover, i_farDistSq))
+        {
+            continue;
+        }
+
+        if (WorldSession* session = owner->GetSession())
+        {
+            i_sender.SendTo(session);
         }
     }
 }
@@ -150,7 +234,7 @@ void ObjectMessageDeliverer::Visit(CameraMapType& m)
     {
         if (WorldSession* session = iter->getSource()->GetOwner()->GetSession())
         {
-            session->SendPacket(i_message);
+            i_sender.SendTo(session);
         }
     }
 }
@@ -167,7 +251,7 @@ void MessageDistDeliverer::Visit(CameraMapType& m)
         {
             if (WorldSession* session = owner->GetSession())
             {
-                session->SendPacket(i_message);
+                i_sender.SendTo(session);
             }
         }
     }
@@ -181,7 +265,7 @@ void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
         {
             if (WorldSession* session = iter->getSource()->GetOwner()->GetSession())
             {
-                session->SendPacket(i_message);
+                i_sender.SendTo(session);
             }
         }
     }
@@ -36,19 +36,36 @@
 
 namespace MaNGOS
 {
+    // true if the camera is beyond farDistSq of obj and its owner doesn't interact with obj, see Visibility.LodDistance
+    bool IsFarViewer(Camera* camera, WorldObject const* obj, float farDistSq);
+
     struct VisibleNotifier
     {
         Camera& i_camera;
         UpdateData i_data;
-        GuidSet i_clientGUIDs;
+        UpdateData i_farData;                               // objects beyond i_farDistSq, sent at a lower priority
+        float i_farDistSq;                                  // 0 unless a bandwidth budget is set
+        GuidVector i_visitedGUIDs;                          // everything checked in this pass, the rest the client knows is out of range
         std::set<WorldObject*> i_visibleNow;
 
-        explicit VisibleNotifier(Camera& c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_clientGUIDs) {}
+        explicit VisibleNotifier(Camera& c);
         template<class T> void Visit(GridRefManager<T>& m);
         void Visit(CameraMapType& /*m*/) {}
+        void VisitObject(WorldObject* obj);
         void Notify(void);
     };
 
+    // passes only the objects that can be visible beyond the visibility distance to a VisibleNotifier
+    struct VisibleObjectsNotifier
+    {
+        VisibleNotifier& i_notifier;
+
+        explicit VisibleObjectsNotifier(VisibleNotifier& notifier) : i_notifier(notifier) {}
+        void Visit(GameObjectMapType& m) { i_notifier.Visit(m); }
+        void Visit(DynamicObjectMapType& m) { i_notifier.Visit(m); }
+        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+    };
+
     struct VisibleChangesNotifier
     {
         WorldObject& i_object;
@@ -63,7 +80,8 @@ namespace MaNGOS
         Player const& i_player;
         WorldPacket* i_message;
         bool i_toSelf;
-        MessageDeliverer(Player const& pl, WorldPacket* msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
+        SharedPacketSender i_sender;
+        MessageDeliverer(Player const& pl, WorldPacket* msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self), i_sender(msg, pl.GetObjectGuid()) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
@@ -72,9 +90,26 @@ namespace MaNGOS
     {
         WorldPacket*  i_message;
         Player const* i_skipped_receiver;
+        SharedPacketSender i_sender;
+
+        MessageDelivererExcept(WorldObject const* obj, WorldPacket* msg, Player const* skipped)
+            : i_message(msg), i_skipped_receiver(skipped), i_sender(msg, obj->GetObjectGuid()) {}
+
+        void Visit(CameraMapType& m);
+        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+    };
+
+    // relays a movement packet, receivers beyond farDist only get it when sendFar is set
+    struct MovementMessageDeliverer
+    {
+        WorldPacket*  i_message;
+        Player const* i_skipped_receiver;
+        WorldObject const* i_mover;
+        float i_farDistSq;
+        SharedPacketSender i_sender;
 
-        MessageDelivererExcept(WorldPacket* msg, Player const* skipped)
-            : i_message(msg), i_skipped_receiver(skipped) {}
+        MovementMessageDeliverer(WorldPacket* msg, Player const* skipped, WorldObject const* mover, float farDist, bool sendFar)
+            : i_message(msg), i_skipped_receiver(skipped), i_mover(mover), i_farDistSq(sendFar ? 0.0f : farDist * farDist), i_sender(msg, mover->GetObjectGuid()) {}
 
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
@@ -83,7 +118,8 @@ namespace MaNGOS
     struct ObjectMessageDeliverer
     {
         WorldPacket* i_message;
-        explicit ObjectMessageDeliverer(WorldPacket* msg) : i_message(msg) {}
+        SharedPacketSender i_sender;
+        ObjectMessageDeliverer(WorldObject const& obj, WorldPacket* msg) : i_message(msg), i_sender(msg, obj.GetObjectGuid()) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
@@ -95,9 +131,10 @@ namespace MaNGOS
         bool i_toSelf;
         bool i_ownTeamOnly;
         float i_dist;
+        SharedPacketSender i_sender;
 
         MessageDistDeliverer(Player const& pl, WorldPacket* msg, float dist, bool to_self, bool ownTeamOnly)
-            : i_player(pl), i_message(msg), i_toSelf(to_self), i_ownTeamOnly(ownTeamOnly), i_dist(dist) {}
+            : i_player(pl), i_message(msg), i_toSelf(to_self), i_ownTeamOnly(ownTeamOnly), i_dist(dist), i_sender(msg, pl.GetObjectGuid()) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
@@ -107,7 +144,8 @@ namespace MaNGOS
         WorldObject const& i_object;
         WorldPacket* i_message;
         float i_dist;
-        ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket* msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
+        SharedPacketSender i_sender;
+        ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket* msg, float dist) : i_object(obj), i_message(msg), i_dist(dist), i_sender(msg, obj.GetObjectGuid()) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
     };
@@ -129,6 +167,7 @@ namespace MaNGOS
         PlayerRelocationNotifier(Player& pl) : i_player(pl) {}
         template<class T> void Visit(GridRefManager<T>&) {}
         void Visit(CreatureMapType&);
+        void VisitObject(Unit* unit);
     };
 
     struct CreatureRelocationNotifier
@@ -136,6 +175,7 @@ namespace MaNGOS
         Creature& i_creature;
         CreatureRelocationNotifier(Creature& c) : i_creature(c) {}
         template<class T> void Visit(GridRefManager<T>&) {}
+        void VisitObject(Unit* unit);
 #ifdef WIN32
         template<> void Visit(PlayerMapType&);
 #endif
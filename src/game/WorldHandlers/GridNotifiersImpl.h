@@ -39,11 +39,25 @@ inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T>& m)
 {
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
-        i_camera.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
-        i_clientGUIDs.erase(iter->getSource()->GetObjectGuid());
+        VisitObject(iter->getSource());
     }
 }
 
+inline void MaNGOS::VisibleNotifier::VisitObject(WorldObject* obj)
+{
+    // only creates go apart, out of range blocks stay with the near ones
+    bool farCreate = false;
+    if (i_farDistSq > 0.0f && !i_camera.GetOwner()->HaveAtClient(obj))
+    {
+        float dx = i_camera.GetBody()->GetPositionX() - obj->GetPositionX();
+        float dy = i_camera.GetBody()->GetPositionY() - obj->GetPositionY();
+        farCreate = dx * dx + dy * dy > i_farDistSq;
+    }
+
+    i_camera.UpdateVisibilityOf(obj, farCreate ? i_farData : i_data, i_visibleNow);
+    i_visitedGUIDs.push_back(obj->GetObjectGuid());
+}
+
 inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 {
     for (CreatureMapType::iterator iter = m.begin(); iter != m.end(); ++iter)
@@ -101,6 +115,19 @@ inline void MaNGOS::PlayerRelocationNotifier::Visit(CreatureMapType& m)
     }
 }
 
+inline void MaNGOS::PlayerRelocationNotifier::VisitObject(Unit* unit)
+{
+    if (unit->GetTypeId() != TYPEID_UNIT || !i_player.IsAlive() || i_player.IsTaxiFlying())
+    {
+        return;
+    }
+
+    if (unit->IsAlive())
+    {
+        PlayerCreatureRelocationWorker(&i_player, (Creature*)unit);
+    }
+}
+
 template<>
 inline void MaNGOS::CreatureRelocationNotifier::Visit(PlayerMapType& m)
 {
@@ -137,6 +164,26 @@ inline void MaNGOS::CreatureRelocationNotifier::Visit(CreatureMapType& m)
     }
 }
 
+inline void MaNGOS::CreatureRelocationNotifier::VisitObject(Unit* unit)
+{
+    if (unit == &i_creature || !i_creature.IsAlive() || !unit->IsAlive())
+    {
+        return;
+    }
+
+    if (unit->GetTypeId() == TYPEID_PLAYER)
+    {
+        if (!unit->IsTaxiFlying())
+        {
+            PlayerCreatureRelocationWorker((Player*)unit, &i_creature);
+        }
+    }
+    else
+    {
+        CreatureCreatureRelocationWorker((Creature*)unit, &i_creature);
+    }
+}
+
 inline void MaNGOS::DynamicObjectUpdater::VisitHelper(Unit* target)
 {
     if (!target->IsAlive() || target->IsTaxiFlying())
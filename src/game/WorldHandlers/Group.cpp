@@ -1496,6 +1496,7 @@ void Group::UpdatePlayerOutOfRange(Player* pPlayer)
 
 void Group::BroadcastPacket(WorldPacket* packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore)
 {
+    SharedPacketSender sender(packet);
     for (GroupReference* itr = GetFirstMember(); itr != NULL; itr = itr->next())
     {
         Player* pl = itr->getSource();
@@ -1506,7 +1507,7 @@ void Group::BroadcastPacket(WorldPacket* packet, bool ignorePlayersInBGRaid, int
 
         if (pl->GetSession() && (group == -1 || itr->getSubGroup() == group))
         {
-            pl->GetSession()->SendPacket(packet);
+            sender.SendTo(pl->GetSession());
         }
     }
 }
@@ -44,6 +44,10 @@
 #include "Weather.h"
 #include "Transports.h"
 #include "ObjectGridLoader.h"
+#include "MapUpdater.h"
+#include "DynamicTick.h"
+#include "GridPreloader.h"
+#include "movement/MoveSpline.h"
 
 #ifdef ENABLE_ELUNA
 #include "LuaEngine.h"
@@ -73,6 +77,8 @@ Map::~Map()
 
     UnloadAll(true);
 
+    sTickProfiler.UnregisterMapProfile(&m_perfProfile);
+
     if (!m_scriptSchedule.empty())
     {
         sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
@@ -124,7 +130,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
       m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_persistentState(NULL),
       m_activeNonPlayersIter(m_activeNonPlayers.end()),
       i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-      i_data(NULL)
+      m_updateRegionCount(0), m_regionUpdate(false), m_gridPreloadTimer(0), m_skippedUpdateDiff(0), m_updateCost(0), m_tickUpdateCost(0),
+      m_perfProfile(MAP_PERF_PHASE_COUNT, id, InstanceId, GetMapName()), i_data(NULL)
 {
 #ifdef ENABLE_ELUNA
     // lua state begins uninitialized
@@ -136,6 +143,10 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
     }
 #endif
 
+    sTickProfiler.RegisterMapProfile(&m_perfProfile);
+
+    m_objectUpdateTick = 0;
+
     m_CreatureGuids.Set(sObjectMgr.GetFirstTemporaryCreatureLowGuid());
     m_GameObjectGuids.Set(sObjectMgr.GetFirstTemporaryGameObjectLowGuid());
 
@@ -270,6 +281,9 @@ void Map::DeleteFromWorld(Player* pl)
 void
 Map::EnsureGridCreated(const GridPair& p)
 {
+    // regions of the same map may reach the same grid, it has to be checked and created under the lock
+    RegionGuard guard(this);
+
     if (!getNGrid(p.x_coord, p.y_coord))
     {
         setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
@@ -325,6 +339,9 @@ Map::EnsureGridLoadedAtEnter(const Cell& cell, Player* player)
 
 bool Map::EnsureGridLoaded(const Cell& cell)
 {
+    // another region may be creating or loading the same grid, so even the loaded check needs the lock
+    RegionGuard guard(this);
+
     EnsureGridCreated(GridPair(cell.GridX(), cell.GridY()));
     NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
 
@@ -361,6 +378,8 @@ void Map::ForceLoadGrid(float x, float y)
 
 bool Map::Add(Player* player)
 {
+    RegionGuard guard(this);
+
     player->GetMapRef().link(this, player);
     player->SetMap(this);
 
@@ -399,6 +418,8 @@ Map::Add(T* obj)
 {
     MANGOS_ASSERT(obj);
 
+    RegionGuard guard(this);
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -480,7 +501,7 @@ void Map::MessageBroadcast(WorldObject const* obj, WorldPacket* msg)
 
     // TODO: currently on continents when Visibility.Distance.InFlight > Visibility.Distance.Continents
     // we have alot of blinking mobs because monster move packet send is broken...
-    MaNGOS::ObjectMessageDeliverer post_man(msg);
+    MaNGOS::ObjectMessageDeliverer post_man(*obj, msg);
     TypeContainerVisitor<MaNGOS::ObjectMessageDeliverer, WorldTypeMapContainer > message(post_man);
     cell.Visit(p, message, *this, *obj, GetVisibilityDistance());
 }
@@ -536,7 +557,7 @@ bool Map::loaded(const GridPair& p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj,
+void Map::VisitNearbyCellsOf(WorldObject* obj, MarkedCells& marked,
                              TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer> &gridVisitor,
                              TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
 {
@@ -555,9 +576,9 @@ void Map::VisitNearbyCellsOf(WorldObject* obj,
             // marked cells are those that have been visited
             // don't visit the same cell twice
             uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (!isCellMarked(cell_id))
+            if (!marked.test(cell_id))
             {
-                markCell(cell_id);
+                marked.set(cell_id);
                 CellPair pair(x, y);
                 Cell cell(pair);
                 cell.SetNoCreate();
@@ -568,8 +589,75 @@ void Map::VisitNearbyCellsOf(WorldObject* obj,
     }
 }
 
+void Map::FindObjectsInRange(float x, float y, float z, float radius, uint16 typeMask, std::vector<WorldObject*>& result, bool is3D) const
+{
+    if (!MaNGOS::IsValidMapCoord(x, y))
+    {
+        return;
+    }
+
+    // same limit as Cell::Visit
+    if (radius > 333.0f)
+    {
+        radius = 333.0f;
+    }
+
+    CellArea area = Cell::CalculateCellArea(x, y, radius);
+
+    for (uint32 cx = area.low_bound.x_coord; cx <= area.high_bound.x_coord; ++cx)
+    {
+        for (uint32 cy = area.low_bound.y_coord; cy <= area.high_bound.y_coord; ++cy)
+        {
+            CellPair pair(cx, cy);
+            Cell cell(pair);
+            if (GridType* cellObjects = GetLoadedCell(cell))
+            {
+                cellObjects->GetIndex().FindInRange(x, y, z, radius, typeMask, result, is3D);
+            }
+        }
+    }
+}
+
+bool Map::IsUpdateDue(uint32& t_diff)
+{
+    m_skippedUpdateDiff += t_diff;
+
+    if (m_skippedUpdateDiff < DynamicTick::GetUpdateInterval(*this))
+    {
+        return false;
+    }
+
+    t_diff = m_skippedUpdateDiff;
+    m_skippedUpdateDiff = 0;
+    return true;
+}
+
+/**
+ * Updates the cells of one region of a map split by Map::PrepareUpdateRegions().
+ */
+class UpdateRegionRequest : public ACE_Method_Request
+{
+    public:
+        UpdateRegionRequest(Map& map, uint32 index, uint32 diff) : m_map(map), m_index(index), m_diff(diff)
+        {
+        }
+
+        virtual int call()
+        {
+            m_map.UpdateRegion(m_index, m_diff);
+            return 0;
+        }
+
+    private:
+        Map& m_map;
+        uint32 m_index;
+        uint32 m_diff;
+};
+
 void Map::Update(const uint32& t_diff)
 {
+    PerfPhaseTimer perf(m_perfProfile);
+
     m_dyn_tree.update(t_diff);
 
     /// update worldsessions for existing players
@@ -585,6 +673,8 @@ void Map::Update(const uint32& t_diff)
         }
     }
 
+    perf.Lap(MAP_PERF_SESSIONS);
+
     /// update players at tick
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -596,6 +686,8 @@ void Map::Update(const uint32& t_diff)
         }
     }
 
+    perf.Lap(MAP_PERF_PLAYERS);
+
     /// update local transports
     for (std::set<Transport*>::iterator t = i_transports.begin(); t != i_transports.end(); ++t)
     {
@@ -603,7 +695,29 @@ void Map::Update(const uint32& t_diff)
         helper.Update(t_diff);
     }
 
-    /// update active cells around players and active objects
+    perf.Lap(MAP_PERF_TRANSPORTS);
+
+    /// update active cells around players and active objects, on continents split into regions in parallel
+    if (PrepareUpdateRegions())
+    {
+        std::vector<ACE_Method_Request*> requests;
+        for (uint32 i = 0; i < m_updateRegionCount; ++i)
+        {
+            requests.push_back(new UpdateRegionRequest(*this, i, t_diff));
+        }
+
+        MapUpdater::execute_subtasks(requests);
+
+        FinishUpdateRegions(t_diff);
+
+        perf.Lap(MAP_PERF_CELLS);
+
+        FinishUpdate(t_diff, perf);
+
+        perf.Total(MAP_PERF_TOTAL);
+        return;
+    }
+
     resetMarkedCells();
 
     MaNGOS::ObjectUpdater updater(t_diff);
@@ -623,7 +737,7 @@ void Map::Update(const uint32& t_diff)
             continue;
         }
 
-        VisitNearbyCellsOf(plr, grid_object_update, world_object_update);
+        VisitNearbyCellsOf(plr, marked_cells, grid_object_update, world_object_update);
 
         // Collect and remove references to creatures too far away from player's m_HostileRefManager
         // Combat state will change on next tick, if case
@@ -652,7 +766,7 @@ void Map::Update(const uint32& t_diff)
 
                 href.deleteReference(*it);
 
-                VisitNearbyCellsOf(*it, grid_object_update, world_object_update);
+                VisitNearbyCellsOf(*it, marked_cells, grid_object_update, world_object_update);
             }
         }
     }
@@ -674,13 +788,38 @@ void Map::Update(const uint32& t_diff)
                 continue;
             }
 
-            VisitNearbyCellsOf(obj, grid_object_update, world_object_update);
+            VisitNearbyCellsOf(obj, marked_cells, grid_object_update, world_object_update);
         }
     }
 
+    perf.Lap(MAP_PERF_CELLS);
+
+    FinishUpdate(t_diff, perf);
+
+    perf.Total(MAP_PERF_TOTAL);
+}
+
+void Map::FinishUpdate(uint32 t_diff, PerfPhaseTimer& perf)
+{
     // Send world objects and item update field changes
     SendObjectUpdates();
 
+    // Send the collected movement of other units once the flush window has passed
+    if (sWorld.getConfig(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW))
+    {
+        for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+        {
+            if (Player* plr = itr->getSource())
+            {
+                plr->GetSession()->FlushMovementPackets();
+            }
+        }
+    }
+
+    perf.Lap(MAP_PERF_OBJECT_UPDATES);
+
+    UpdateGridPreload(t_diff);
+
     // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
     if (!IsBattleGround())
@@ -695,12 +834,16 @@ void Map::Update(const uint32& t_diff)
         }
     }
 
+    perf.Lap(MAP_PERF_GRID_STATES);
+
     ///- Process necessary scripts
     if (!m_scriptSchedule.empty())
     {
         ScriptsProcess();
     }
 
+    perf.Lap(MAP_PERF_SCRIPTS);
+
 #ifdef ENABLE_ELUNA
     if (Eluna* e = GetEluna())
     {
@@ -719,10 +862,499 @@ void Map::Update(const uint32& t_diff)
     }
 
     m_weatherSystem->UpdateWeathers(t_diff);
+
+    perf.Lap(MAP_PERF_INSTANCE);
+}
+
+/// how often the grids ahead of the players are predicted, in milliseconds
+#define GRID_PRELOAD_PREDICT_INTERVAL 1000
+
+/**
+ * Loads the object data of grids the players are about to enter.
+ *
+ * The grids were queued by PredictGridPreload() and their terrain is read by the grid
+ * preloader threads meanwhile. Only one grid with its terrain in memory is loaded per tick,
+ * so crossing fresh grids no longer stalls the map with disk reads and several grid loads
+ * at once.
+ */
+void Map::UpdateGridPreload(uint32 t_diff)
+{
+    if (!sGridPreloader.activated() || !IsContinent())
+    {
+        return;
+    }
+
+    m_gridPreloadTimer += t_diff;
+    if (m_gridPreloadTimer >= GRID_PRELOAD_PREDICT_INTERVAL)
+    {
+        m_gridPreloadTimer = 0;
+
+        for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+        {
+            Player* plr = itr->getSource();
+            if (plr && plr->IsInWorld() && plr->IsPositionValid())
+            {
+                PredictGridPreload(plr);
+            }
+        }
+    }
+
+    bool gridLoaded = false;
+    for (std::deque<std::pair<GridPair, uint32> >::iterator itr = m_gridPreloadQueue.begin(); itr != m_gridPreloadQueue.end();)
+    {
+        GridPair const& p = itr->first;
+        NGridType* grid = getNGrid(p.x_coord, p.y_coord);
+
+        bool done = grid && grid->isGridObjectDataLoaded();
+        bool expired = itr->second <= t_diff;
+
+        if (!done && !expired && !gridLoaded && m_TerrainData->IsPrefetched((MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord))
+        {
+            Cell cell(CellPair(p.x_coord * MAX_NUMBER_OF_CELLS, p.y_coord * MAX_NUMBER_OF_CELLS));
+            EnsureGridLoaded(cell);
+
+            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Preloaded grid[%u,%u] on map %u", p.x_coord, p.y_coord, i_id);
+            done = gridLoaded = true;
+        }
+
+        if (done || expired)
+        {
+            m_gridPreloadQueued.reset(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord);
+            itr = m_gridPreloadQueue.erase(itr);
+        }
+        else
+        {
+            itr->second -= t_diff;
+            ++itr;
+        }
+    }
+}
+
+/**
+ * Queues the grids a player reaches within the preload lookahead, along the remaining
+ * flight path or straight ahead at the current speed.
+ */
+void Map::PredictGridPreload(Player* player)
+{
+    const uint32 lookahead = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD) * IN_MILLISECONDS;
+    const float step = SIZE_OF_GRIDS / 2;
+
+    float x = player->GetPositionX();
+    float y = player->GetPositionY();
+
+    if (player->IsTaxiFlying())
+    {
+        Movement::MoveSpline const* spline = player->movespline;
+        if (spline->Finalized())
+        {
+            return;
+        }
+
+        Movement::MoveSpline::MySpline const& path = spline->_Spline();
+        const int32 current = spline->_currentSplineIdx();
+
+        // walk the flight path node by node, sampling long segments so no grid in between is missed
+        for (int32 i = current + 1; i <= path.last() && uint32(path.length(current, i)) <= lookahead; ++i)
+        {
+            G3D::Vector3 const& node = path.getPoint(i);
+            float dist = sqrtf((node.x - x) * (node.x - x) + (node.y - y) * (node.y - y));
+
+            for (float d = step; d < dist; d += step)
+            {
+                QueueGridPreload(x + (node.x - x) * d / dist, y + (node.y - y) * d / dist, lookahead);
+            }
+
+            QueueGridPreload(node.x, node.y, lookahead);
+            x = node.x;
+            y = node.y;
+        }
+        return;
+    }
+
+    MovementInfo const& movementInfo = player->m_movementInfo;
+    if (!movementInfo.HasMovementFlag(MovementFlags(MOVEFLAG_FORWARD | MOVEFLAG_BACKWARD)))
+    {
+        return;
+    }
+
+    float angle = player->GetOrientation();
+    if (movementInfo.HasMovementFlag(MOVEFLAG_BACKWARD))
+    {
+        angle += M_PI_F;
+    }
+
+    float speed = player->GetSpeed(movementInfo.HasMovementFlag(MOVEFLAG_SWIMMING) ? MOVE_SWIM : MOVE_RUN);
+    float dist = speed * lookahead / IN_MILLISECONDS;
+
+    for (float d = step; d <= dist; d += step)
+    {
+        QueueGridPreload(x + d * cos(angle), y + d * sin(angle), lookahead);
+    }
+}
+
+void Map::QueueGridPreload(float x, float y, uint32 lifetime)
+{
+    if (!MaNGOS::IsValidMapCoord(x, y))
+    {
+        return;
+    }
+
+    GridPair p = MaNGOS::ComputeGridPair(x, y);
+    const uint32 index = p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord;
+    if (m_gridPreloadQueued.test(index))
+    {
+        return;
+    }
+
+    NGridType* grid = getNGrid(p.x_coord, p.y_coord);
+    if (grid && grid->isGridObjectDataLoaded())
+    {
+        return;
+    }
+
+    m_gridPreloadQueued.set(index);
+    m_gridPreloadQueue.push_back(std::make_pair(p, lifetime));
+
+    sGridPreloader.Prefetch(m_TerrainData, (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord);
+}
+
+/// region the calling MapUpdater thread is currently working on, if any
+static thread_local MapUpdateRegion* t_currentRegion = NULL;
+
+/**
+ * Splits the active part of a continent into independent regions for the cell update.
+ *
+ * Every player and active object claims the square of grids reachable by its visibility
+ * distance. Squares closer to each other than one visibility distance are merged, so the
+ * creatures and objects updated in one region can't see or reach the ones of another.
+ * Sessions and players are updated before, for the whole map: their handlers and spells
+ * reach anything on the map.
+ *
+ * @return true if the cells are to be updated by UpdateRegion() calls followed by
+ *         FinishUpdateRegions(), false if the map is updated as a whole
+ */
+bool Map::PrepareUpdateRegions()
+{
+    m_updateRegionCount = 0;
+
+    if (!IsContinent() || !sWorld.getConfig(CONFIG_BOOL_MAP_UPDATE_REGIONS) || m_mapRefManager.getSize() < 2)
+    {
+        return false;
+    }
+
+#ifdef ENABLE_ELUNA
+    // per-map Lua state can't be entered from more than one thread
+    if (GetEluna())
+    {
+        return false;
+    }
+#endif /* ENABLE_ELUNA */
+
+    const uint32 radius = std::max(1u, uint32(ceilf(GetVisibilityDistance() / SIZE_OF_GRIDS)));
+
+    struct Footprint
+    {
+        uint32 lowX, lowY, highX, highY;
+    };
+
+    // one footprint per occupied grid
+    std::vector<Footprint> footprints;
+    std::bitset<MAX_NUMBER_OF_GRIDS* MAX_NUMBER_OF_GRIDS> occupied;
+
+    std::vector<WorldObject*> seeds;
+    for (MapRefManager::iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+    {
+        seeds.push_back(itr->getSource());
+    }
+    for (ActiveNonPlayers::const_iterator itr = m_activeNonPlayers.begin(); itr != m_activeNonPlayers.end(); ++itr)
+    {
+        seeds.push_back(*itr);
+    }
+
+    for (std::vector<WorldObject*>::const_iterator itr = seeds.begin(); itr != seeds.end(); ++itr)
+    {
+        if (!(*itr)->IsPositionValid())
+        {
+            continue;
+        }
+
+        GridPair p = MaNGOS::ComputeGridPair((*itr)->GetPositionX(), (*itr)->GetPositionY());
+        if (occupied.test(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord))
+        {
+            continue;
+        }
+
+        occupied.set(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord);
+
+        Footprint fp;
+        fp.lowX = p.x_coord > radius ? p.x_coord - radius : 0;
+        fp.lowY = p.y_coord > radius ? p.y_coord - radius : 0;
+        fp.highX = std::min(p.x_coord + radius, uint32(MAX_NUMBER_OF_GRIDS - 1));
+        fp.highY = std::min(p.y_coord + radius, uint32(MAX_NUMBER_OF_GRIDS - 1));
+        footprints.push_back(fp);
+    }
+
+    // merge footprints separated by less than one visibility distance until stable
+    for (bool merged = true; merged;)
+    {
+        merged = false;
+        for (size_t i = 0; i < footprints.size() && !merged; ++i)
+        {
+            for (size_t j = i + 1; j < footprints.size(); ++j)
+            {
+                Footprint& a = footprints[i];
+                Footprint const& b = footprints[j];
+
+                uint32 gapX = std::max(a.lowX, b.lowX) > std::min(a.highX, b.highX) ? std::max(a.lowX, b.lowX) - std::min(a.highX, b.highX) - 1 : 0;
+                uint32 gapY = std::max(a.lowY, b.lowY) > std::min(a.highY, b.highY) ? std::max(a.lowY, b.lowY) - std::min(a.highY, b.highY) - 1 : 0;
+                if (std::max(gapX, gapY) >= radius)
+                {
+                    continue;
+                }
+
+                a.lowX = std::min(a.lowX, b.lowX);
+                a.lowY = std::min(a.lowY, b.lowY);
+                a.highX = std::max(a.highX, b.highX);
+                a.highY = std::max(a.highY, b.highY);
+                footprints.erase(footprints.begin() + j);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (footprints.size() < 2)
+    {
+        return false;
+    }
+
+    if (m_updateRegions.size() < footprints.size())
+    {
+        m_updateRegions.resize(footprints.size());
+    }
+
+    for (size_t i = 0; i < footprints.size(); ++i)
+    {
+        MapUpdateRegion& region = m_updateRegions[i];
+        region.owner = this;
+        region.lowX = footprints[i].lowX;
+        region.lowY = footprints[i].lowY;
+        region.highX = footprints[i].highX;
+        region.highY = footprints[i].highY;
+        region.players.clear();
+        region.activeObjects.clear();
+        region.relocations.clear();
+        region.hostileCleanup.clear();
+    }
+
+    m_updateRegionCount = footprints.size();
+
+    for (std::vector<WorldObject*>::const_iterator itr = seeds.begin(); itr != seeds.end(); ++itr)
+    {
+        // objects without valid position are still updated, by the first region
+        MapUpdateRegion* target = &m_updateRegions[0];
+        if ((*itr)->IsPositionValid())
+        {
+            GridPair p = MaNGOS::ComputeGridPair((*itr)->GetPositionX(), (*itr)->GetPositionY());
+            for (uint32 i = 0; i < m_updateRegionCount; ++i)
+            {
+                if (m_updateRegions[i].Contains(p.x_coord, p.y_coord))
+                {
+                    target = &m_updateRegions[i];
+                    break;
+                }
+            }
+        }
+
+        if ((*itr)->GetTypeId() == TYPEID_PLAYER)
+        {
+            target->players.push_back((Player*)(*itr));
+        }
+        else
+        {
+            target->activeObjects.push_back((*itr)->GetObjectGuid());
+        }
+    }
+
+    m_regionUpdate = true;
+    return true;
+}
+
+/**
+ * Updates the cells around the players and active objects of one region.
+ * Runs concurrently with the other regions of the same map.
+ */
+void Map::UpdateRegion(uint32 index, uint32 t_diff)
+{
+    MANGOS_ASSERT(m_regionUpdate && index < m_updateRegionCount);
+
+    PerfPhaseTimer perf(m_perfProfile);
+
+    MapUpdateRegion& region = m_updateRegions[index];
+    t_currentRegion = &region;
+
+    /// update active cells around players and active objects
+    region.markedCells.reset();
+
+    MaNGOS::ObjectUpdater updater(t_diff);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    for (std::vector<Player*>::const_iterator itr = region.players.begin(); itr != region.players.end(); ++itr)
+    {
+        Player* plr = *itr;
+        if (!plr->IsInWorld() || plr->GetMap() != this)
+        {
+            continue;
+        }
+
+        VisitNearbyCellsOf(plr, region.markedCells, grid_object_update, world_object_update);
+
+        // creatures out of visibility range may belong to another region, drop them in the merge phase
+        if (!IsDungeon() && plr->IsInCombat())
+        {
+            for (HostileReference* ref = plr->GetHostileRefManager().getFirst(); ref; ref = ref->next())
+            {
+                if (Unit* unit = ref->getSource()->getOwner())
+                    if (unit->ToCreature() && unit->GetMapId() == plr->GetMapId() && !unit->IsWithinDistInMap(plr, GetVisibilityDistance(), false))
+                    {
+                        region.hostileCleanup.push_back(std::make_pair(plr->GetObjectGuid(), unit->GetObjectGuid()));
+                    }
+            }
+        }
+    }
+
+    for (std::vector<ObjectGuid>::const_iterator itr = region.activeObjects.begin(); itr != region.activeObjects.end(); ++itr)
+    {
+        WorldObject* obj = GetWorldObject(*itr);
+        if (!obj || !obj->IsInWorld())
+        {
+            continue;
+        }
+
+        VisitNearbyCellsOf(obj, region.markedCells, grid_object_update, world_object_update);
+    }
+
+    t_currentRegion = NULL;
+
+    perf.Total(MAP_PERF_REGION);
+}
+
+/// True while the object still is where it was when its move out of the region was queued
+static bool IsAtQueuedPosition(WorldObject const* obj, MapUpdateRegion::Relocation const& relocation)
+{
+    return obj->GetPositionX() == relocation.fromX && obj->GetPositionY() == relocation.fromY && obj->GetPositionZ() == relocation.fromZ;
+}
+
+/**
+ * Serial merge phase after all regions of the map were updated: applies the deferred cross-region work.
+ */
+void Map::FinishUpdateRegions(uint32 t_diff)
+{
+    PerfPhaseTimer perf(m_perfProfile);
+
+    m_regionUpdate = false;
+
+    resetMarkedCells();
+    for (uint32 i = 0; i < m_updateRegionCount; ++i)
+    {
+        marked_cells |= m_updateRegions[i].markedCells;
+    }
+
+    MaNGOS::ObjectUpdater updater(t_diff);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
+    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
+
+    for (uint32 i = 0; i < m_updateRegionCount; ++i)
+    {
+        MapUpdateRegion& region = m_updateRegions[i];
+
+        for (std::vector<MapUpdateRegion::Relocation>::const_iterator itr = region.relocations.begin(); itr != region.relocations.end(); ++itr)
+        {
+            // the object may have been removed, teleported or moved again since the move was queued
+            if (itr->guid.IsPlayer())
+            {
+                Player* plr = GetPlayer(itr->guid);
+                if (plr && plr->IsInWorld() && plr->GetMap() == this && !plr->IsBeingTeleported() && IsAtQueuedPosition(plr, *itr))
+                {
+                    PlayerRelocation(plr, itr->x, itr->y, itr->z, itr->orientation);
+                }
+            }
+            else
+            {
+                Creature* creature = GetAnyTypeCreature(itr->guid);
+                if (creature && creature->IsInWorld() && creature->GetMap() == this && IsAtQueuedPosition(creature, *itr))
+                {
+                    CreatureRelocation(creature, itr->x, itr->y, itr->z, itr->orientation);
+                }
+            }
+        }
+
+        for (std::vector<std::pair<ObjectGuid, ObjectGuid> >::const_iterator itr = region.hostileCleanup.begin(); itr != region.hostileCleanup.end(); ++itr)
+        {
+            Player* plr = GetPlayer(itr->first);
+            Creature* creature = GetAnyTypeCreature(itr->second);
+            if (!plr || !creature || creature->IsWithinDistInMap(plr, GetVisibilityDistance(), false))
+            {
+                continue;
+            }
+
+            creature->RemoveAurasByCaster(plr->GetObjectGuid());
+            creature->_removeAttacker(plr);
+            creature->GetHostileRefManager().deleteReference(plr);
+
+            plr->GetHostileRefManager().deleteReference(creature);
+
+            VisitNearbyCellsOf(creature, marked_cells, grid_object_update, world_object_update);
+        }
+
+        region.players.clear();
+        region.activeObjects.clear();
+        region.relocations.clear();
+        region.hostileCleanup.clear();
+    }
+
+    m_updateRegionCount = 0;
+
+    perf.Total(MAP_PERF_REGION_MERGE);
+}
+
+/**
+ * Queues a relocation done from inside a region update that would leave the region footprint.
+ *
+ * @return true if the move was deferred to FinishUpdateRegions()
+ */
+bool Map::DeferRegionRelocation(WorldObject* obj, float x, float y, float z, float orientation)
+{
+    MapUpdateRegion* region = t_currentRegion;
+    if (!region || region->owner != this)
+    {
+        return false;
+    }
+
+    GridPair p = MaNGOS::ComputeGridPair(x, y);
+    if (region->Contains(p.x_coord, p.y_coord))
+    {
+        return false;
+    }
+
+    MapUpdateRegion::Relocation relocation;
+    relocation.guid = obj->GetObjectGuid();
+    relocation.fromX = obj->GetPositionX();
+    relocation.fromY = obj->GetPositionY();
+    relocation.fromZ = obj->GetPositionZ();
+    relocation.x = x;
+    relocation.y = y;
+    relocation.z = z;
+    relocation.orientation = orientation;
+    region->relocations.push_back(relocation);
+    return true;
 }
 
 void Map::Remove(Player* player, bool remove)
 {
+    RegionGuard guard(this);
+
 #ifdef ENABLE_ELUNA
     if (Eluna* e = GetEluna())
     {
@@ -799,6 +1431,8 @@ template<class T>
 void
 Map::Remove(T* obj, bool remove)
 {
+    RegionGuard guard(this);
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -851,6 +1485,11 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
 {
     MANGOS_ASSERT(player);
 
+    if (DeferRegionRelocation(player, x, y, z, orientation))
+    {
+        return;
+    }
+
     CellPair old_val = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(x, y);
 
@@ -893,6 +1532,11 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 {
     MANGOS_ASSERT(CheckGridIntegrity(creature, false));
 
+    if (DeferRegionRelocation(creature, x, y, z, ang))
+    {
+        return;
+    }
+
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
     // do move or do move to respawn or remove creature if previous all fail
@@ -1082,9 +1726,7 @@ void Map::SendInitSelf(Player* player)
         }
     }
 
-    WorldPacket packet;
-    data.BuildPacket(&packet, hasTransport);
-    player->GetSession()->SendPacket(&packet);
+    player->GetSession()->SendUpdateData(data, hasTransport, OUTBOUND_PRIORITY_SELF);
 }
 
 void Map::SendInitTransports(Player* player)
@@ -1206,6 +1848,7 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
 
+    RegionGuard guard(this);
     i_objectsToRemove.insert(obj);
     // DEBUG_LOG("Object (GUID: %u TypeId: %u ) added to removing list.",obj->GetGUIDLow(),obj->GetTypeId());
 }
@@ -1258,6 +1901,8 @@ void Map::RemoveAllObjectsInRemoveList()
 
 uint32 Map::GetPlayersCountExceptGMs() const
 {
+    RegionGuard guard(this);
+
     uint32 count = 0;
     for (MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
         if (!itr->getSource()->isGameMaster())
@@ -1269,6 +1914,8 @@ uint32 Map::GetPlayersCountExceptGMs() const
 
 void Map::SendToPlayers(WorldPacket const* data) const
 {
+    RegionGuard guard(this);
+
     for (MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
     {
         itr->getSource()->GetSession()->SendPacket(data);
@@ -1277,6 +1924,8 @@ void Map::SendToPlayers(WorldPacket const* data) const
 
 bool Map::SendToPlayersInZone(WorldPacket const* data, uint32 zoneId) const
 {
+    RegionGuard guard(this);
+
     bool foundPlayer = false;
     for (MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
     {
@@ -1289,6 +1938,17 @@ bool Map::SendToPlayersInZone(WorldPacket const* data, uint32 zoneId) const
     return foundPlayer;
 }
 
+void Map::GetPlayersSnapshot(std::vector<Player*>& players) const
+{
+    RegionGuard guard(this);
+
+    players.reserve(players.size() + m_mapRefManager.getSize());
+    for (MapRefManager::const_iterator itr = m_mapRefManager.begin(); itr != m_mapRefManager.end(); ++itr)
+    {
+        players.push_back(itr->getSource());
+    }
+}
+
 bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 {
     MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -1335,6 +1995,8 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    RegionGuard guard(this);
+
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1365,6 +2027,8 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive(WorldObject* obj)
 {
+    RegionGuard guard(this);
+
     // Map::Update for active object in proccess
     if (m_activeNonPlayersIter != m_activeNonPlayers.end())
     {
@@ -1957,6 +2621,8 @@ bool Map::ScriptsStart(DBScriptType type, uint32 id, Object* source, Object* tar
         }
     }
 
+    RegionGuard guard(this);
+
     ///- Schedule script execution for all scripts in the script map
     ScriptChain const* s2 = &(s->second);
     for (ScriptChain::const_iterator iter = s2->begin(); iter != s2->end(); ++iter)
@@ -1982,6 +2648,7 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
 
     ScriptAction sa(DBS_INTERNAL, this, sourceGuid, targetGuid, ownerGuid, &script);
 
+    RegionGuard guard(this);
     m_scriptSchedule.insert(ScriptScheduleMap::value_type(time_t(sWorld.GetGameTime() + delay), sa));
 
     sScriptMgr.IncreaseScheduledScriptsCount();
@@ -2053,6 +2720,7 @@ Player* Map::GetPlayer(ObjectGuid guid)
  */
 Creature* Map::GetCreature(ObjectGuid guid)
 {
+    RegionGuard guard(this);
     return m_objectsStore.find<Creature>(guid, (Creature*)NULL);
 }
 
@@ -2063,6 +2731,7 @@ Creature* Map::GetCreature(ObjectGuid guid)
  */
 Pet* Map::GetPet(ObjectGuid guid)
 {
+    RegionGuard guard(this);
     return m_objectsStore.find<Pet>(guid, (Pet*)NULL);
 }
 
@@ -2103,6 +2772,7 @@ Creature* Map::GetAnyTypeCreature(ObjectGuid guid)
  */
 GameObject* Map::GetGameObject(ObjectGuid guid)
 {
+    RegionGuard guard(this);
     return m_objectsStore.find<GameObject>(guid, (GameObject*)NULL);
 }
 
@@ -2113,6 +2783,7 @@ GameObject* Map::GetGameObject(ObjectGuid guid)
  */
 DynamicObject* Map::GetDynamicObject(ObjectGuid guid)
 {
+    RegionGuard guard(this);
     return m_objectsStore.find<DynamicObject>(guid, (DynamicObject*)NULL);
 }
 
@@ -2160,10 +2831,74 @@ WorldObject* Map::GetWorldObject(ObjectGuid guid)
     return NULL;
 }
 
+/// Number of players whose object updates are sent by one sub-task
+#define SEND_OBJECT_UPDATES_CHUNK 32
+
+/**
+ * Builds and sends the object update packets of a range of players.
+ */
+class SendObjectUpdatesRequest : public ACE_Method_Request
+{
+    public:
+        SendObjectUpdatesRequest(UpdateDataMapType::iterator begin, UpdateDataMapType::iterator end)
+            : m_begin(begin), m_end(end)
+        {
+        }
+
+        virtual int call()
+        {
+            WorldPacket packet;                             // here we allocate a std::vector with a size of 0x10000
+            for (UpdateDataMapType::iterator iter = m_begin; iter != m_end; ++iter)
+            {
+                WorldSession* session = iter->first->GetSession();
+
+                // the player's own values don't wait behind the creates and updates of other objects
+                UpdateData self;
+                if (iter->second.ExtractSelfBlock(self))
+                {
+                    self.BuildPacket(&packet);
+                    session->SendPacket(&packet, OUTBOUND_PRIORITY_SELF);
+                    packet.clear();
+                }
+
+                if (!iter->second.HasData())
+                {
+                    continue;
+                }
+
+                // value updates only, they don't need the collected moves flushed first
+                iter->second.BuildPacket(&packet);
+                session->SendPacket(&packet);
+                packet.clear();                             // clean the string
+            }
+
+            return 0;
+        }
+
+    private:
+        UpdateDataMapType::iterator m_begin;
+        UpdateDataMapType::iterator m_end;
+};
+
 void Map::SendObjectUpdates()
 {
     UpdateDataMapType update_players;
 
+    // objects with changes held back for far viewers are updated again on their far tick
+    ++m_objectUpdateTick;
+    for (std::set<Object*>::iterator itr = i_objectsToClientUpdateFar.begin(); itr != i_objectsToClientUpdateFar.end();)
+    {
+        if (IsFarUpdateTick(*itr))
+        {
+            i_objectsToClientUpdate.insert(*itr);
+            i_objectsToClientUpdateFar.erase(itr++);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+
     while (!i_objectsToClientUpdate.empty())
     {
         Object* obj = *i_objectsToClientUpdate.begin();
@@ -2171,13 +2906,42 @@ void Map::SendObjectUpdates()
         obj->BuildUpdateData(update_players);
     }
 
-    WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
-    for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
+    if (update_players.size() <= SEND_OBJECT_UPDATES_CHUNK)
     {
-        iter->second.BuildPacket(&packet);
-        iter->first->GetSession()->SendPacket(&packet);
-        packet.clear();                                     // clean the string
+        SendObjectUpdatesRequest(update_players.begin(), update_players.end()).call();
+        return;
+    }
+
+    // building and compressing the packets is independent per player, let idle update threads help
+    std::vector<ACE_Method_Request*> requests;
+    UpdateDataMapType::iterator begin = update_players.begin();
+    while (begin != update_players.end())
+    {
+        UpdateDataMapType::iterator end = begin;
+        for (uint32 i = 0; i < SEND_OBJECT_UPDATES_CHUNK && end != update_players.end(); ++i)
+        {
+            ++end;
+        }
+
+        requests.push_back(new SendObjectUpdatesRequest(begin, end));
+        begin = end;
     }
+
+    MapUpdater::execute_subtasks(requests);
+}
+
+bool Map::IsFarUpdateTick(Object const* obj) const
+{
+    return (m_objectUpdateTick + obj->GetGUIDLow()) % sWorld.getConfig(CONFIG_UINT32_VISIBILITY_LOD_INTERVAL) == 0;
+}
+
+void Map::CommitUpdateCost()
+{
+    long tickCost = m_tickUpdateCost.value();
+    m_tickUpdateCost = 0;
+
+    // smooth over a few ticks so a single spike doesn't reorder the schedule
+    m_updateCost = uint32((uint64(m_updateCost) * 3 + uint64(tickCost)) / 4);
 }
 
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
@@ -2277,6 +3041,7 @@ void Map::MonsterYellToMap(CreatureInfo const* cinfo, int32 textId, Language lan
     StaticMonsterChatBuilder say_build(cinfo, CHAT_MSG_MONSTER_YELL, textId, language, target, senderLowGuid);
     MaNGOS::LocalizedPacketDo<StaticMonsterChatBuilder> say_do(say_build);
 
+    RegionGuard guard(this);
     Map::PlayerList const& pList = GetPlayers();
     for (PlayerList::const_iterator itr = pList.begin(); itr != pList.end(); ++itr)
     {
@@ -2295,6 +3060,7 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
     WorldPacket data(SMSG_PLAY_SOUND, 4);
     data << uint32(soundId);
 
+    RegionGuard guard(this);
     Map::PlayerList const& pList = GetPlayers();
     for (PlayerList::const_iterator itr = pList.begin(); itr != pList.end(); ++itr)
         if (!zoneId || itr->getSource()->GetZoneId() == zoneId)
@@ -2308,8 +3074,13 @@ void Map::PlayDirectSoundToMap(uint32 soundId, uint32 zoneId /*=0*/) const
  */
 bool Map::IsInLineOfSight(float srcX, float srcY, float srcZ, float destX, float destY, float destZ) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ)
-           && m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
+    if (!VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), srcX, srcY, srcZ, destX, destY, destZ))
+    {
+        return false;
+    }
+
+    DynamicTreeGuard guard(this, false);
+    return m_dyn_tree.isInLineOfSight(srcX, srcY, srcZ, destX, destY, destZ);
 }
 
 /**
@@ -2329,6 +3100,7 @@ bool Map::GetHitPosition(float srcX, float srcY, float srcZ, float& destX, float
         destZ = tempZ;
     }
     // at second all dynamic objects, if static check has an hit, then we can calculate only to this closer point
+    DynamicTreeGuard guard(this, false);
     bool result1 = m_dyn_tree.getObjectHitPos(srcX, srcY, srcZ, destX, destY, destZ, tempX, tempY, tempZ, modifyDist);
     if (result1)
     {
@@ -2402,6 +3174,7 @@ bool Map::GetHeightInRange(float x, float y, float& z, float maxSearchDist /*= 4
         }
     }
 
+    DynamicTreeGuard guard(this, false);
     z = std::max<float>(height, m_dyn_tree.getHeight(x, y, height + 1.0f, maxSearchDist));
     return true;
 }
@@ -2412,21 +3185,25 @@ float Map::GetHeight(float x, float y, float z) const
 
     // Get Dynamic Height around static Height (if valid)
     float dynSearchHeight = 2.0f + (z < staticHeight ? staticHeight : z);
+    DynamicTreeGuard guard(this, false);
     return std::max<float>(staticHeight, m_dyn_tree.getHeight(x, y, dynSearchHeight, dynSearchHeight - staticHeight));
 }
 
 void Map::InsertGameObjectModel(const GameObjectModel& mdl)
 {
+    DynamicTreeGuard guard(this, true);
     m_dyn_tree.insert(mdl);
 }
 
 void Map::RemoveGameObjectModel(const GameObjectModel& mdl)
 {
+    DynamicTreeGuard guard(this, true);
     m_dyn_tree.remove(mdl);
 }
 
 bool Map::ContainsGameObjectModel(const GameObjectModel& mdl) const
 {
+    DynamicTreeGuard guard(this, false);
     return m_dyn_tree.contains(mdl);
 }
 
@@ -30,9 +30,12 @@
 #include "Policies/ThreadingModel.h"
 #include <ace/RW_Thread_Mutex.h>
 #include <ace/Thread_Mutex.h>
+#include <ace/Recursive_Thread_Mutex.h>
+#include <ace/Atomic_Op.h>
 
 #include "DBCStructure.h"
 #include "GridDefines.h"
+#include "TickProfiler.h"
 #include "Cell.h"
 #include "Object.h"
 #include "SharedDefines.h"
@@ -47,6 +50,7 @@
 #endif /* ENABLE_ELUNA */
 
 #include <bitset>
+#include <deque>
 
 struct CreatureInfo;
 class Creature;
@@ -100,6 +104,47 @@ struct InstanceTemplate
 
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
 
+class Map;
+
+typedef std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP* TOTAL_NUMBER_OF_CELLS_PER_MAP> MarkedCells;
+
+/**
+ * @brief An island of grids of one map whose cells can be updated independently of the rest of the map.
+ *
+ * Regions are separated from each other by at least one visibility distance, so the creatures
+ * and objects updated inside one region can't see or reach into another one during the same tick.
+ * Sessions and players are not part of it, Map::Update runs them for the whole map first.
+ * Interactions that still cross the region footprint are queued here and applied by
+ * Map::FinishUpdateRegions() once all regions of the map are done.
+ */
+struct MapUpdateRegion
+{
+    struct Relocation
+    {
+        ObjectGuid guid;
+        float fromX, fromY, fromZ;                          // position when queued, the move is dropped if it changed
+        float x, y, z, orientation;
+    };
+
+    MapUpdateRegion() : owner(NULL), lowX(0), lowY(0), highX(0), highY(0) {}
+
+    bool Contains(uint32 gx, uint32 gy) const
+    {
+        return gx >= lowX && gx <= highX && gy >= lowY && gy <= highY;
+    }
+
+    Map const* owner;
+    uint32 lowX, lowY, highX, highY;                        // grid footprint, inclusive
+
+    std::vector<Player*> players;
+    std::vector<ObjectGuid> activeObjects;                  // non-player active objects, resolved at update
+
+    std::vector<Relocation> relocations;                    // moves leaving the footprint
+    std::vector<std::pair<ObjectGuid, ObjectGuid> > hostileCleanup; // (player, creature) references out of range
+
+    MarkedCells markedCells;
+};
+
 class Map : public GridRefManager<NGridType>
 {
         friend class MapReference;
@@ -136,6 +181,17 @@ class Map : public GridRefManager<NGridType>
 
         virtual void Update(const uint32&);
 
+        /// Accounts a map update tick; false while the map may skip it, otherwise t_diff receives the time since its last update
+        bool IsUpdateDue(uint32& t_diff);
+
+        // Cell update of one region of a continent, run on the map update threads by Map::Update
+        void UpdateRegion(uint32 index, uint32 t_diff);
+
+        // Time spent updating this map, used by MapUpdater to start expensive maps first
+        uint32 GetUpdateCost() const { return m_updateCost; }
+        void AddUpdateCost(uint32 usec) { m_tickUpdateCost += usec; }
+        void CommitUpdateCost();
+
         void MessageBroadcast(Player const*, WorldPacket*, bool to_self);
         void MessageBroadcast(WorldObject const*, WorldPacket*);
         void MessageDistBroadcast(Player const*, WorldPacket*, float dist, bool to_self, bool own_team_only = false);
@@ -162,6 +218,28 @@ class Map : public GridRefManager<NGridType>
             return loaded(p);
         }
 
+        // the objects of one cell, NULL while the grid of the cell isn't loaded
+        GridType* GetLoadedCell(const Cell& cell) const
+        {
+            NGridType* grid = getNGrid(cell.GridX(), cell.GridY());
+            return grid && grid->isGridObjectDataLoaded() ? &(*grid)(cell.CellX(), cell.CellY()) : NULL;
+        }
+
+        /**
+         * @brief Collects the objects of the loaded cells around a point that are within the radius.
+         *
+         * Tests the contiguous position data of the cell indexes instead of the objects, so callers
+         * only touch the objects that can pass their own checks. The bounding radius of the found
+         * objects counts towards the distance, the size of the searcher has to be added to the radius.
+         *
+         * @param x, y, z Center of the search.
+         * @param radius Search radius, limited to the same maximum as the cell visitors use.
+         * @param typeMask TYPEMASK_* flags of the wanted objects.
+         * @param result Receives the found objects.
+         * @param is3D Whether the height is checked as well.
+         */
+        void FindObjectsInRange(float x, float y, float z, float radius, uint16 typeMask, std::vector<WorldObject*>& result, bool is3D = false) const;
+
         bool GetUnloadLock(const GridPair& p) const { return getNGrid(p.x_coord, p.y_coord)->getUnloadLock(); }
         void SetUnloadLock(const GridPair& p, bool on) { getNGrid(p.x_coord, p.y_coord)->setUnloadExplicitLock(on); }
         void ForceLoadGrid(float x, float y);
@@ -216,7 +294,10 @@ class Map : public GridRefManager<NGridType>
         bool SendToPlayersInZone(WorldPacket const* data, uint32 zoneId) const;
 
         typedef MapRefManager PlayerList;
+        /// Not safe to iterate while regions of the map update, use GetPlayersSnapshot() from code that may run in a region
         PlayerList const& GetPlayers() const { return m_mapRefManager; }
+        /// Copies the players of the map, players can be added and removed by other regions meanwhile
+        void GetPlayersSnapshot(std::vector<Player*>& players) const;
 
         // per-map script storage
         enum ScriptExecutionParam
@@ -249,14 +330,38 @@ class Map : public GridRefManager<NGridType>
 
         void AddUpdateObject(Object* obj)
         {
+            RegionGuard guard(this);
             i_objectsToClientUpdate.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            RegionGuard guard(this);
             i_objectsToClientUpdate.erase(obj);
+            i_objectsToClientUpdateFar.erase(obj);
         }
 
+        /**
+         * @brief Keeps an object whose changes were held back from far viewers until its next far update tick.
+         *
+         * @param obj object with changes in its far changed mask
+         */
+        void DeferUpdateObject(Object* obj)
+        {
+            RegionGuard guard(this);
+            i_objectsToClientUpdateFar.insert(obj);
+        }
+
+        /**
+         * @brief Tells whether viewers beyond Visibility.LodDistance get the object's changes this tick.
+         *
+         * The ticks are spread over the objects by their guid so not all far updates happen at once.
+         *
+         * @param obj object being updated
+         * @return bool
+         */
+        bool IsFarUpdateTick(Object const* obj) const;
+
         // DynObjects currently
         uint32 GenerateLocalLowGuid(HighGuid guidhigh);
 
@@ -313,6 +418,65 @@ class Map : public GridRefManager<NGridType>
 #endif /* ENABLE_ELUNA */
 
     private:
+        /// Serializes shared map state while regions of this map update concurrently, no-op otherwise
+        class RegionGuard
+        {
+            public:
+                explicit RegionGuard(Map const* map) : m_lock(map->m_regionUpdate ? &map->m_regionLock : NULL)
+                {
+                    if (m_lock)
+                    {
+                        m_lock->acquire();
+                    }
+                }
+                ~RegionGuard()
+                {
+                    if (m_lock)
+                    {
+                        m_lock->release();
+                    }
+                }
+
+            private:
+                RegionGuard(RegionGuard const&);
+                RegionGuard& operator=(RegionGuard const&);
+
+                ACE_Recursive_Thread_Mutex* m_lock;
+        };
+
+        /// Guards m_dyn_tree while regions of this map update concurrently, no-op otherwise
+        class DynamicTreeGuard
+        {
+            public:
+                DynamicTreeGuard(Map const* map, bool write) : m_lock(map->m_regionUpdate ? &map->m_dynTreeLock : NULL)
+                {
+                    if (m_lock)
+                    {
+                        if (write)
+                        {
+                            m_lock->acquire_write();
+                        }
+                        else
+                        {
+                            m_lock->acquire_read();
+                        }
+                    }
+                }
+                ~DynamicTreeGuard()
+                {
+                    if (m_lock)
+                    {
+                        m_lock->release();
+                    }
+                }
+
+            private:
+                DynamicTreeGuard(DynamicTreeGuard const&);
+                DynamicTreeGuard& operator=(DynamicTreeGuard const&);
+
+                ACE_RW_Thread_Mutex* m_lock;
+        };
+
         void LoadMapAndVMap(int gx, int gy);
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
@@ -338,10 +502,22 @@ class Map : public GridRefManager<NGridType>
             return i_grids[x][y];
         }
 
-        void VisitNearbyCellsOf(WorldObject* obj,
+        void VisitNearbyCellsOf(WorldObject* obj, MarkedCells& marked,
                                 TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer> &gridVisitor,
                                 TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
 
+        // tail of the update shared by the serial and the region-partitioned path
+        void FinishUpdate(uint32 t_diff, PerfPhaseTimer& perf);
+
+        bool PrepareUpdateRegions();
+        void FinishUpdateRegions(uint32 t_diff);
+        bool DeferRegionRelocation(WorldObject* obj, float x, float y, float z, float orientation);
+
+        // grids ahead of moving players, terrain read by the grid preloader and objects loaded before arrival
+        void UpdateGridPreload(uint32 t_diff);
+        void PredictGridPreload(Player* player);
+        void QueueGridPreload(float x, float y, uint32 lifetime);
+
         bool isGridObjectDataLoaded(uint32 x, uint32 y) const { return getNGrid(x, y)->isGridObjectDataLoaded(); }
         void setGridObjectDataLoaded(bool pLoaded, uint32 x, uint32 y) { getNGrid(x, y)->setGridObjectDataLoaded(pLoaded); }
 
@@ -350,6 +526,8 @@ class Map : public GridRefManager<NGridType>
 
         void SendObjectUpdates();
         std::set<Object*> i_objectsToClientUpdate;
+        std::set<Object*> i_objectsToClientUpdateFar;      // held back for far viewers, see DeferUpdateObject()
+        uint32 m_objectUpdateTick;
 
     protected:
         MapEntry const* i_mapEntry;
@@ -376,7 +554,25 @@ class Map : public GridRefManager<NGridType>
         TerrainInfo* const m_TerrainData;
         bool m_bLoadedGrids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP* TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        MarkedCells marked_cells;
+
+        // region-partitioned update state
+        std::vector<MapUpdateRegion> m_updateRegions;
+        uint32 m_updateRegionCount;
+        bool m_regionUpdate;
+        mutable ACE_Recursive_Thread_Mutex m_regionLock;
+        mutable ACE_RW_Thread_Mutex m_dynTreeLock;          // gameobject models change while other regions test line of sight
+
+        // predicted grids waiting for their object data load, with the time they stay queued
+        std::deque<std::pair<GridPair, uint32> > m_gridPreloadQueue;
+        std::bitset<MAX_NUMBER_OF_GRIDS* MAX_NUMBER_OF_GRIDS> m_gridPreloadQueued;
+        uint32 m_gridPreloadTimer;
+
+        uint32 m_skippedUpdateDiff;                         // time of the ticks skipped while idle
+        uint32 m_updateCost;                                // smoothed update time per tick, in microseconds
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_tickUpdateCost;
+
+        PerfProfile m_perfProfile;
 
         std::set<WorldObject*> i_objectsToRemove;
         std::set<Transport*> i_transports;
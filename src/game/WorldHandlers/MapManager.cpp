@@ -32,6 +32,7 @@
 #include "World.h"
 #include "CellImpl.h"
 #include "ObjectMgr.h"
+#include "GridPreloader.h"
 
 #ifdef ENABLE_ELUNA
 #include "ElunaConfig.h"
@@ -82,6 +83,13 @@ MapManager::Initialize()
         abort();
     }
 
+    // threads reading the terrain of grids ahead of moving players
+    int preload_threads(sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS));
+    if (preload_threads > 0 && sGridPreloader.activate(preload_threads) == -1)
+    {
+        abort();
+    }
+
     InitStateMachine();
     InitMaxInstanceId();
 }
@@ -218,13 +226,20 @@ void MapManager::Update(uint32 diff)
 
     for (MapMapType::iterator iter=i_maps.begin(); iter != i_maps.end(); ++iter)
     {
+        // idle maps skip ticks and get the skipped time with their next update
+        uint32 mapDiff = (uint32)i_timer.GetCurrent();
+        if (!iter->second->IsUpdateDue(mapDiff))
+        {
+            continue;
+        }
+
         if (m_updater.activated())
         {
-            m_updater.schedule_update(*iter->second, (uint32)i_timer.GetCurrent());
+            m_updater.schedule_update(*iter->second, mapDiff);
         }
         else
         {
-            iter->second->Update((uint32)i_timer.GetCurrent());
+            iter->second->Update(mapDiff);
         }
     }
 
@@ -233,6 +248,13 @@ void MapManager::Update(uint32 diff)
         m_updater.wait();
     }
 
+    for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
+    {
+        iter->second->CommitUpdateCost();
+    }
+
+    sGridPreloader.Update();
+
     for (TransportSet::iterator iter = m_Transports.begin(); iter != m_Transports.end(); ++iter)
     {
         WorldObject::UpdateHelper helper((*iter));
@@ -299,6 +321,11 @@ void MapManager::UnloadAll()
         i_maps.erase(i_maps.begin());
     }
 
+    if (sGridPreloader.activated())
+    {
+        sGridPreloader.deactivate();
+    }
+
     TerrainManager::Instance().UnloadAll();
 
     if (m_updater.activated())
@@ -34,6 +34,9 @@
 #include "WaypointMovementGenerator.h"
 #include "MapPersistentStateMgr.h"
 #include "ObjectMgr.h"
+#include "World.h"
+#include "GridNotifiers.h"
+#include "CellImpl.h"
 
 #define MOVEMENT_PACKET_TIME_DELAY 300
 
@@ -313,6 +316,17 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
     WorldPacket data(opcode, uint16(recv_data.size() + 2));
     data << mover->GetPackGUID();             // write guid
     movementInfo.Write(data);                               // write data
+
+    // far viewers only need every few heartbeats to keep the position in sync, starts and stops always reach them
+    float farDist = sWorld.getConfig(CONFIG_FLOAT_VISIBILITY_LOD_DISTANCE);
+    if (opcode == MSG_MOVE_HEARTBEAT && farDist > 0.0f && mover->IsInWorld())
+    {
+        bool sendFar = ++m_moveHeartbeatCount % sWorld.getConfig(CONFIG_UINT32_VISIBILITY_LOD_INTERVAL) == 0;
+        MaNGOS::MovementMessageDeliverer notifier(&data, _player, mover, farDist, sendFar);
+        Cell::VisitWorldObjects(mover, notifier, mover->GetMap()->GetVisibilityDistance());
+        return;
+    }
+
     mover->SendMessageToSetExcept(&data, _player);
 }
 
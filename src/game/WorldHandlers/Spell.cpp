@@ -7917,7 +7917,15 @@ SpellCastResult Spell::CanOpenLock(SpellEffectIndex effIndex, uint32 lockId, Ski
 void Spell::FillAreaTargets(UnitList& targetUnitMap, float radius, SpellNotifyPushType pushType, SpellTargets spellTargets, WorldObject* originalCaster /*=NULL*/)
 {
     MaNGOS::SpellNotifierCreatureAndPlayer notifier(*this, targetUnitMap, radius, pushType, spellTargets, originalCaster);
-    Cell::VisitAllObjects(notifier.GetCenterX(), notifier.GetCenterY(), m_caster->GetMap(), notifier, radius);
+
+    // range prefilter over the cell indexes, the notifier only checks the units that can be in reach
+    std::vector<WorldObject*> candidates;
+    m_caster->GetMap()->FindObjectsInRange(notifier.GetCenterX(), notifier.GetCenterY(), 0.0f, radius + notifier.GetCenterSize(), TYPEMASK_UNIT, candidates);
+
+    for (std::vector<WorldObject*>::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
+    {
+        notifier.Notify((Unit*)(*itr));
+    }
 }
 
 void Spell::FillRaidOrPartyTargets(UnitList& targetUnitMap, Unit* member, float radius, bool raid, bool withPets, bool withcaster)
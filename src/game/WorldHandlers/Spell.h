@@ -725,6 +725,28 @@ namespace MaNGOS
         }
 
         template<class T> inline void Visit(GridRefManager<T>&  m)
+        {
+            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+            {
+                Notify(itr->getSource());
+            }
+        }
+
+        // size of the object at the center, the reach of the search beyond the spell radius
+        float GetCenterSize() const
+        {
+            switch (i_push_type)
+            {
+                case PUSH_DEST_CENTER:
+                    return 0.0f;
+                case PUSH_TARGET_CENTER:
+                    return i_spell.m_targets.getUnitTarget() ? i_spell.m_targets.getUnitTarget()->GetObjectBoundingRadius() : 0.0f;
+                default:
+                    return i_castingObject ? i_castingObject->GetObjectBoundingRadius() : 0.0f;
+            }
+        }
+
+        void Notify(Unit* target)
         {
             MANGOS_ASSERT(i_data);
 
@@ -733,124 +755,121 @@ namespace MaNGOS
                 return;
             }
 
-            for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
-            {
-                // GM OFF Spell must pass the checks.
-                bool gmSpell = (i_spell.m_spellInfo->Id == 1509);
-                // there are still more spells which can be casted on dead, but
-                // they are no AOE and don't have such a nice SPELL_ATTR flag
-
-                if (!gmSpell)
-                {
-                    if ((i_TargetType != SPELL_TARGETS_ALL && !itr->getSource()->IsTargetableForAttack(i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
-                        // mostly phase check
-                        || !itr->getSource()->IsInMap(i_originalCaster))
-                        {
-                            continue;
-                        }
+            // GM OFF Spell must pass the checks.
+            bool gmSpell = (i_spell.m_spellInfo->Id == 1509);
+            // there are still more spells which can be casted on dead, but
+            // they are no AOE and don't have such a nice SPELL_ATTR flag
 
-                    switch (i_TargetType)
+            if (!gmSpell)
+            {
+                if ((i_TargetType != SPELL_TARGETS_ALL && !target->IsTargetableForAttack(i_spell.m_spellInfo->HasAttribute(SPELL_ATTR_EX3_CAST_ON_DEAD)))
+                    // mostly phase check
+                    || !target->IsInMap(i_originalCaster))
                     {
-                        case SPELL_TARGETS_HOSTILE:
-                            if (!i_originalCaster->IsHostileTo(itr->getSource()))
-                            {
-                                continue;
-                            }
-                            break;
-                        case SPELL_TARGETS_NOT_FRIENDLY:
-                            if (i_originalCaster->IsFriendlyTo(itr->getSource()))
-                            {
-                                continue;
-                            }
-                            break;
-                        case SPELL_TARGETS_NOT_HOSTILE:
-                            if (i_originalCaster->IsHostileTo(itr->getSource()))
-                            {
-                                continue;
-                            }
-                            break;
-                        case SPELL_TARGETS_FRIENDLY:
-                            if (!i_originalCaster->IsFriendlyTo(itr->getSource()))
-                            {
-                                continue;
-                            }
-                            break;
-                        case SPELL_TARGETS_AOE_DAMAGE:
-                        {
-                            if (itr->getSource()->GetTypeId() == TYPEID_UNIT && ((Creature*)itr->getSource())->IsTotem())
-                            {
-                                continue;
-                            }
-
-                            if (i_playerControlled)
-                            {
-                                if (i_originalCaster->IsFriendlyTo(itr->getSource()))
-                                {
-                                    continue;
-                                }
-                            }
-                            else
-                            {
-                                if (!i_originalCaster->IsHostileTo(itr->getSource()))
-                                {
-                                    continue;
-                                }
-                            }
-                        }
-                        break;
-                        case SPELL_TARGETS_ALL:
-                            break;
-                        default: continue;
+                        return;
                     }
-                }
 
-                // we don't need to check InMap here, it's already done some lines above
-                switch (i_push_type)
+                switch (i_TargetType)
                 {
-                    case PUSH_IN_FRONT:
-                        if (i_castingObject->IsInFront((Unit*)(itr->getSource()), i_radius, 2 * M_PI_F / 3))
+                    case SPELL_TARGETS_HOSTILE:
+                        if (!i_originalCaster->IsHostileTo(target))
                         {
-                            i_data->push_back(itr->getSource());
+                            return;
                         }
                         break;
-                    case PUSH_IN_FRONT_90:
-                        if (i_castingObject->IsInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 2))
+                    case SPELL_TARGETS_NOT_FRIENDLY:
+                        if (i_originalCaster->IsFriendlyTo(target))
                         {
-                            i_data->push_back(itr->getSource());
+                            return;
                         }
                         break;
-                    case PUSH_IN_FRONT_15:
-                        if (i_castingObject->IsInFront((Unit*)(itr->getSource()), i_radius, M_PI_F / 12))
+                    case SPELL_TARGETS_NOT_HOSTILE:
+                        if (i_originalCaster->IsHostileTo(target))
                         {
-                            i_data->push_back(itr->getSource());
+                            return;
                         }
                         break;
-                    case PUSH_IN_BACK:
-                        if (i_castingObject->IsInBack((Unit*)(itr->getSource()), i_radius, 2 * M_PI_F / 3))
+                    case SPELL_TARGETS_FRIENDLY:
+                        if (!i_originalCaster->IsFriendlyTo(target))
                         {
-                            i_data->push_back(itr->getSource());
+                            return;
                         }
                         break;
-                    case PUSH_SELF_CENTER:
-                        if (i_castingObject->IsWithinDist((Unit*)(itr->getSource()), i_radius))
+                    case SPELL_TARGETS_AOE_DAMAGE:
+                    {
+                        if (target->GetTypeId() == TYPEID_UNIT && ((Creature*)target)->IsTotem())
                         {
-                            i_data->push_back(itr->getSource());
+                            return;
                         }
-                        break;
-                    case PUSH_DEST_CENTER:
-                        if (itr->getSource()->IsWithinDist3d(i_centerX, i_centerY, i_centerZ, i_radius))
+
+                        if (i_playerControlled)
                         {
-                            i_data->push_back(itr->getSource());
+                            if (i_originalCaster->IsFriendlyTo(target))
+                            {
+                                return;
+                            }
                         }
-                        break;
-                    case PUSH_TARGET_CENTER:
-                        if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
+                        else
                         {
-                            i_data->push_back(itr->getSource());
+                            if (!i_originalCaster->IsHostileTo(target))
+                            {
+                                return;
+                            }
                         }
+                    }
+                    break;
+                    case SPELL_TARGETS_ALL:
                         break;
+                    default: return;
                 }
             }
+
+            // we don't need to check InMap here, it's already done some lines above
+            switch (i_push_type)
+            {
+                case PUSH_IN_FRONT:
+                    if (i_castingObject->IsInFront(target, i_radius, 2 * M_PI_F / 3))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_IN_FRONT_90:
+                    if (i_castingObject->IsInFront(target, i_radius, M_PI_F / 2))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_IN_FRONT_15:
+                    if (i_castingObject->IsInFront(target, i_radius, M_PI_F / 12))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_IN_BACK:
+                    if (i_castingObject->IsInBack(target, i_radius, 2 * M_PI_F / 3))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_SELF_CENTER:
+                    if (i_castingObject->IsWithinDist(target, i_radius))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_DEST_CENTER:
+                    if (target->IsWithinDist3d(i_centerX, i_centerY, i_centerZ, i_radius))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+                case PUSH_TARGET_CENTER:
+                    if (i_spell.m_targets.getUnitTarget() && i_spell.m_targets.getUnitTarget()->IsWithinDist(target, i_radius))
+                    {
+                        i_data->push_back(target);
+                    }
+                    break;
+            }
         }
 
 #ifdef WIN32
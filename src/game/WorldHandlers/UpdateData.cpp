@@ -32,7 +32,7 @@
 #include "World.h"
 #include "ObjectGuid.h"
 
-UpdateData::UpdateData() : m_blockCount(0)
+UpdateData::UpdateData() : m_blockCount(0), m_selfBlockPos(0), m_selfBlockSize(0)
 {
 }
 
@@ -46,21 +46,79 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
     m_outOfRangeGUIDs.insert(guid);
 }
 
+void UpdateData::AddOutOfRangeGUID(GuidVector const& guids)
+{
+    // sorted input goes to the end of the set without a lookup
+    for (GuidVector::const_iterator itr = guids.begin(); itr != guids.end(); ++itr)
+    {
+        m_outOfRangeGUIDs.insert(m_outOfRangeGUIDs.end(), *itr);
+    }
+}
+
+// deflate state kept per thread, reset between packets instead of set up for every one
+struct UpdateDeflateContext
+{
+    UpdateDeflateContext() : initialized(false), level(0) {}
+    ~UpdateDeflateContext()
+    {
+        if (initialized)
+        {
+            deflateEnd(&stream);
+        }
+    }
+
+    z_stream stream;
+    bool initialized;
+    int level;
+};
+
+static thread_local UpdateDeflateContext t_deflateContext;
+
 void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
 {
-    z_stream c_stream;
+    UpdateDeflateContext& ctx = t_deflateContext;
+    z_stream& c_stream = ctx.stream;
 
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
+    // large packets (creates of whole areas) can have their own level, default Z_BEST_SPEED (1) for both
+    int level = int(uint32(src_size) >= sWorld.getConfig(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE)
+                    ? sWorld.getConfig(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_LEVEL)
+                    : sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
 
-    // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    int z_res;
+    if (!ctx.initialized)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        c_stream.zalloc = (alloc_func)0;
+        c_stream.zfree = (free_func)0;
+        c_stream.opaque = (voidpf)0;
+
+        z_res = deflateInit(&c_stream, level);
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+            *dst_size = 0;
+            return;
+        }
+
+        ctx.initialized = true;
+        ctx.level = level;
+    }
+    else
+    {
+        z_res = deflateReset(&c_stream);
+        if (z_res == Z_OK && ctx.level != level)
+        {
+            z_res = deflateParams(&c_stream, level, Z_DEFAULT_STRATEGY);
+            ctx.level = level;
+        }
+
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+            deflateEnd(&c_stream);
+            ctx.initialized = false;
+            *dst_size = 0;
+            return;
+        }
     }
 
     c_stream.next_out = (Bytef*)dst;
@@ -91,18 +149,34 @@ void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
+    *dst_size = c_stream.total_out;
+}
+
+bool UpdateData::CompressPacket(WorldPacket* packet)
+{
+    size_t pSize = packet->wpos();
+    if (pSize <= 100)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        return true;
     }
 
-    *dst_size = c_stream.total_out;
+    uint32 destsize = compressBound(pSize);
+    WorldPacket compressed(SMSG_COMPRESSED_UPDATE_OBJECT, destsize + sizeof(uint32));
+    compressed.resize(destsize + sizeof(uint32));
+
+    compressed.put<uint32>(0, pSize);
+    Compress(const_cast<uint8*>(compressed.contents()) + sizeof(uint32), &destsize, (void*)packet->contents(), pSize);
+    if (destsize == 0)
+    {
+        return false;
+    }
+
+    compressed.resize(destsize + sizeof(uint32));
+    *packet = compressed;
+    return true;
 }
 
-bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
+bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport, bool compress)
 {
     MANGOS_ASSERT(packet->empty());                         // shouldn't happen
 
@@ -126,7 +200,7 @@ bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
 
     size_t pSize = buf.wpos();                              // use real used data size
 
-    if (pSize > 100)                                        // compress large packets
+    if (compress && pSize > 100)                            // compress large packets
     {
         uint32 destsize = compressBound(pSize);
         packet->resize(destsize + sizeof(uint32));
@@ -154,5 +228,29 @@ void UpdateData::Clear()
 {
     m_data.clear();
     m_outOfRangeGUIDs.clear();
+    m_createdGUIDs.clear();
     m_blockCount = 0;
+    m_selfBlockPos = 0;
+    m_selfBlockSize = 0;
+}
+
+bool UpdateData::ExtractSelfBlock(UpdateData& self)
+{
+    if (!m_selfBlockSize)
+    {
+        return false;
+    }
+
+    self.m_data.append(m_data.contents() + m_selfBlockPos, m_selfBlockSize);
+    self.AddUpdateBlock();
+
+    ByteBuffer rest(m_data.wpos() - m_selfBlockSize);
+    rest.append(m_data.contents(), m_selfBlockPos);
+    rest.append(m_data.contents() + m_selfBlockPos + m_selfBlockSize, m_data.wpos() - m_selfBlockPos - m_selfBlockSize);
+    m_data = rest;
+    --m_blockCount;
+
+    m_selfBlockPos = 0;
+    m_selfBlockSize = 0;
+    return true;
 }
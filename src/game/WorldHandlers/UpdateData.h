@@ -60,19 +60,34 @@ class UpdateData
 
         void AddOutOfRangeGUID(GuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
+        void AddOutOfRangeGUID(GuidVector const& guids);
         void AddUpdateBlock() { ++m_blockCount; }
+        void AddCreatedGUID(ObjectGuid const& guid) { m_createdGUIDs.push_back(guid); }
         ByteBuffer& GetBuffer() { return m_data; }
-        bool BuildPacket(WorldPacket* packet, bool hasTransport = false);
+        bool BuildPacket(WorldPacket* packet, bool hasTransport = false, bool compress = true);
         bool HasData() { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
         GuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
+        GuidVector const& GetCreatedGUIDs() const { return m_createdGUIDs; }
+
+        // the block appended since pos is the values update of the receiving player itself
+        void MarkSelfBlock(size_t pos) { m_selfBlockPos = pos; m_selfBlockSize = m_data.wpos() - pos; }
+        // moves the marked block of the receiving player into self, false if there is none
+        bool ExtractSelfBlock(UpdateData& self);
+
+        // compresses a SMSG_UPDATE_OBJECT built with compress = false, small packets are left as they are
+        static bool CompressPacket(WorldPacket* packet);
+
+        // deflates src into dst with the deflate stream of the calling thread, dst_size is 0 on failure
+        static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
 
     protected:
         uint32 m_blockCount;
         GuidSet m_outOfRangeGUIDs;
+        GuidVector m_createdGUIDs;                          // objects created by the blocks, the packet must reach the client before anything about them
         ByteBuffer m_data;
-
-        void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+        size_t m_selfBlockPos;
+        size_t m_selfBlockSize;                             // 0 without a block of the receiving player
 };
 #endif
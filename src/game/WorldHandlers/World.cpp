@@ -75,6 +75,9 @@
 #include "CommandMgr.h"
 #include "GitRevision.h"
 #include "UpdateTime.h"
+#include "TickProfiler.h"
+#include "OpcodeProfiler.h"
+#include "PacketCapture.h"
 #include "GameTime.h"
 
 #ifdef ENABLE_ELUNA
@@ -194,6 +197,7 @@ void World::CleanupsBeforeStop()
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
+    sPacketCapture.Stop();
 }
 
 /// Find a session by its id
@@ -519,6 +523,10 @@ void World::LoadConfigSettings(bool reload)
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    setConfig(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE, "Compression.LargePacketSize", 16384);
+    setConfigMinMax(CONFIG_UINT32_COMPRESSION_LARGE_PACKET_LEVEL, "Compression.LargePacketLevel", getConfig(CONFIG_UINT32_COMPRESSION), 1, 9);
+    setConfig(CONFIG_BOOL_COMPRESSION_ASYNC, "Compression.Async", false);
+    setConfig(CONFIG_UINT32_COMPRESSION_ASYNC_MIN_SIZE, "Compression.AsyncMinSize", 4096);
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
@@ -561,6 +569,18 @@ void World::LoadConfigSettings(bool reload)
     }
 
     setConfig(CONFIG_UINT32_NUMTHREADS, "MapUpdateThreads", 2);
+    setConfig(CONFIG_BOOL_MAP_UPDATE_REGIONS, "MapUpdateRegions", false);
+    setConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_CONTINENT, "MapUpdate.IdleInterval.Continent", 0);
+    setConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_DUNGEON, "MapUpdate.IdleInterval.Dungeon", 1000);
+    setConfig(CONFIG_UINT32_MAP_IDLE_INTERVAL_BATTLEGROUND, "MapUpdate.IdleInterval.BattleGround", 1000);
+    setConfig(CONFIG_UINT32_MAP_CROWDED_PLAYERS, "MapUpdate.CrowdedPlayers", 10);
+    setConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS, "GridPreload.Threads", 1);
+    setConfig(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD, "GridPreload.Lookahead", 15);
+    setConfig(CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED, "GridMap.MemoryMapped", false);
+
+    sTickProfiler.LoadFromConfig();
+    sOpcodeProfiler.LoadFromConfig();
+    sPacketCapture.LoadFromConfig();
 
     setConfigMin(CONFIG_UINT32_INTERVAL_MAPUPDATE, "MapUpdateInterval", 100, MIN_MAP_UPDATE_DELAY);
     if (reload)
@@ -775,6 +795,9 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,                       "OutdoorPvp.EPEnabled", true);
 
     setConfig(CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET, "Network.KickOnBadPacket", false);
+    setConfig(CONFIG_BOOL_OPCODE_THROTTLE, "Network.OpcodeThrottle", true);
+    setConfigMinMax(CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW, "Network.MovementCoalesceWindow", 0, 0, 1000);
+    setConfig(CONFIG_UINT32_SESSION_BANDWIDTH, "Network.SessionBandwidth", 0);
 
     setConfig(CONFIG_BOOL_PLAYER_COMMANDS, "PlayerCommands", false);
 
@@ -836,6 +859,9 @@ void World::LoadConfigSettings(bool reload)
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq  = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
 
+    setConfigMin(CONFIG_FLOAT_VISIBILITY_LOD_DISTANCE, "Visibility.LodDistance", 0.0f, 0.0f);
+    setConfigMinMax(CONFIG_UINT32_VISIBILITY_LOD_INTERVAL, "Visibility.LodInterval", 4, 1, 50);
+
     m_VisibleUnitGreyDistance = sConfig.GetFloatDefault("Visibility.Distance.Grey.Unit", 1);
     if (m_VisibleUnitGreyDistance >  MAX_VISIBILITY_DISTANCE)
     {
@@ -1679,6 +1705,8 @@ void World::DetectDBCLang()
 /// Update the World !
 void World::Update(uint32 diff)
 {
+    PerfPhaseTimer perf(sTickProfiler.GetWorldProfile());
+
     ///- Update the different timers
     for (int i = 0; i < WUPDATE_COUNT; ++i)
     {
@@ -1742,6 +1770,8 @@ void World::Update(uint32 diff)
         m_timers[WUPDATE_AHBOT].Reset();
     }
 
+    perf.Lap(WORLD_PERF_AUCTIONS);
+
 #ifdef ENABLE_PLAYERBOTS
     sRandomPlayerbotMgr.UpdateAI(diff);
     sRandomPlayerbotMgr.UpdateSessions(diff);
@@ -1750,6 +1780,8 @@ void World::Update(uint32 diff)
     /// <li> Handle session updates
     UpdateSessions(diff);
 
+    perf.Lap(WORLD_PERF_SESSIONS);
+
     /// <li> Update uptime table
     if (m_timers[WUPDATE_UPTIME].Passed())
     {
@@ -1763,9 +1795,13 @@ void World::Update(uint32 diff)
     /// <li> Handle all other objects
     ///- Update objects (maps, transport, creatures,...)
     sMapMgr.Update(diff);
+    perf.Lap(WORLD_PERF_MAPS);
     sBattleGroundMgr.Update(diff);
+    perf.Lap(WORLD_PERF_BATTLEGROUNDS);
     sLFGMgr.Update(diff);
+    perf.Lap(WORLD_PERF_LFG);
     sOutdoorPvPMgr.Update(diff);
+    perf.Lap(WORLD_PERF_OUTDOORPVP);
 
     ///- Used by Eluna
 #ifdef ENABLE_ELUNA
@@ -1786,6 +1822,8 @@ void World::Update(uint32 diff)
     // execute callbacks from sql queries that were queued recently
     UpdateResultQueue();
 
+    perf.Lap(WORLD_PERF_RESULT_QUEUE);
+
     ///- Erase corpses once every 20 minutes
     if (m_timers[WUPDATE_CORPSES].Passed())
     {
@@ -1803,10 +1841,14 @@ void World::Update(uint32 diff)
         m_timers[WUPDATE_EVENTS].Reset();
     }
 
+    perf.Lap(WORLD_PERF_GAME_EVENTS);
+
     /// </ul>
     ///- Move all creatures with "delayed move" and remove and delete all objects with "delayed remove"
     sMapMgr.RemoveAllObjectsInRemoveList();
 
+    perf.Lap(WORLD_PERF_REMOVE_LIST);
+
     // update the instance reset times
     sMapPersistentStateMgr.Update();
 
@@ -1827,8 +1869,18 @@ void World::Update(uint32 diff)
     // And last, but not least handle the issued cli commands
     ProcessCliCommands();
 
+    perf.Lap(WORLD_PERF_CLI_COMMANDS);
+
     // cleanup unused GridMap objects as well as VMaps
     sTerrainMgr.Update(diff);
+
+    perf.Lap(WORLD_PERF_TERRAIN);
+    perf.Total(WORLD_PERF_TOTAL);
+
+    sTickProfiler.Update(diff);
+    sOpcodeProfiler.Update(diff);
+    sPacketCapture.Update();
+    ByteBufferPool::CountTick();
 }
 
 namespace MaNGOS
@@ -89,6 +89,9 @@ enum WorldTimers
 enum eConfigUInt32Values
 {
     CONFIG_UINT32_COMPRESSION = 0,
+    CONFIG_UINT32_COMPRESSION_LARGE_PACKET_SIZE,
+    CONFIG_UINT32_COMPRESSION_LARGE_PACKET_LEVEL,
+    CONFIG_UINT32_COMPRESSION_ASYNC_MIN_SIZE,
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
@@ -190,6 +193,12 @@ enum eConfigUInt32Values
     CONFIG_UINT32_CHARDELETE_METHOD,
     CONFIG_UINT32_CHARDELETE_MIN_LEVEL,
     CONFIG_UINT32_NUMTHREADS,
+    CONFIG_UINT32_MAP_IDLE_INTERVAL_CONTINENT,
+    CONFIG_UINT32_MAP_IDLE_INTERVAL_DUNGEON,
+    CONFIG_UINT32_MAP_IDLE_INTERVAL_BATTLEGROUND,
+    CONFIG_UINT32_MAP_CROWDED_PLAYERS,
+    CONFIG_UINT32_GRID_PRELOAD_THREADS,
+    CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD,
     CONFIG_UINT32_GUID_RESERVE_SIZE_CREATURE,
     CONFIG_UINT32_GUID_RESERVE_SIZE_GAMEOBJECT,
     CONFIG_UINT32_CREATURE_RESPAWN_AGGRO_DELAY,
@@ -209,6 +218,9 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PLAYERBOT_MINBOTLEVEL,
 #endif
     CONFIG_UINT32_AUTOBROADCAST_INTERVAL,
+    CONFIG_UINT32_MOVEMENT_COALESCE_WINDOW,
+    CONFIG_UINT32_VISIBILITY_LOD_INTERVAL,
+    CONFIG_UINT32_SESSION_BANDWIDTH,
     CONFIG_UINT32_VALUE_COUNT
 };
 
@@ -293,6 +305,7 @@ enum eConfigFloatValues
     CONFIG_FLOAT_THREAT_RADIUS,
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
     CONFIG_FLOAT_GHOST_RUN_SPEED_BG,
+    CONFIG_FLOAT_VISIBILITY_LOD_DISTANCE,
 #ifdef ENABLE_PLAYERBOTS
     CONFIG_FLOAT_PLAYERBOT_MINDISTANCE,
     CONFIG_FLOAT_PLAYERBOT_MAXDISTANCE,
@@ -347,6 +360,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_OUTDOORPVP_SI_ENABLED,
     CONFIG_BOOL_OUTDOORPVP_EP_ENABLED,
     CONFIG_BOOL_KICK_PLAYER_ON_BAD_PACKET,
+    CONFIG_BOOL_OPCODE_THROTTLE,
     CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT,
     CONFIG_BOOL_CLEAN_CHARACTER_DB,
     CONFIG_BOOL_VMAP_INDOOR_CHECK,
@@ -376,6 +390,10 @@ enum eConfigBoolValues
     // Recommended Or New Flag
     CONFIG_BOOL_REALM_RECOMMENDED_OR_NEW_ENABLED,
     CONFIG_BOOL_REALM_RECOMMENDED_OR_NEW,
+
+    CONFIG_BOOL_MAP_UPDATE_REGIONS,
+    CONFIG_BOOL_GRID_MAP_MEMORY_MAPPED,
+    CONFIG_BOOL_COMPRESSION_ASYNC,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -29,6 +29,7 @@
 #include "Common.h"
 #include "WorldSocket.h"
 #include "WorldSocketMgr.h"
+#include "PacketCompressor.h"
 #include "World.h"
 #include "WorldThread.h"
 #include "Timer.h"
@@ -64,6 +65,11 @@ int WorldThread::open(void* unused)
         return -1;
     }
 
+    if (sWorld.getConfig(CONFIG_BOOL_COMPRESSION_ASYNC))
+    {
+        sPacketCompressor.activate();
+    }
+
     activate();
     return 0;
 }
@@ -105,6 +111,7 @@ int WorldThread::svc()
     }
     sWorld.KickAll();                                       // save and kick all players
     sWorld.UpdateSessions(1);                               // real players unload required UpdateSessions call
+    sPacketCompressor.deactivate();
     sWorldSocketMgr->StopNetwork();
 
     sMapMgr.UnloadAll();                                    // unload all grids (including locked in memory)
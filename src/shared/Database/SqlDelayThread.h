@@ -26,7 +26,7 @@
 #define MANGOS_H_SQLDELAYTHREAD
 
 #include <ace/Thread_Mutex.h>
-#include "LockedQueue/LockedQueue.h"
+#include "LockedQueue/MPSCQueue.h"
 #include "Threading/Threading.h"
 
 class Database;
@@ -43,7 +43,7 @@ class SqlDelayThread : public ACE_Based::Runnable
          * @brief
          *
          */
-        typedef ACE_Based::LockedQueue<SqlOperation*, ACE_Thread_Mutex> SqlQueue;
+        typedef ACE_Based::MPSCQueue<SqlOperation*> SqlQueue;
 
     private:
         SqlQueue m_sqlQueue;                                /**< Queue of SQL statements */
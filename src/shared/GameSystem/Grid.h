@@ -33,6 +33,18 @@
 // forward declaration
 template<class A, class T, class O> class GridLoader;
 
+/**
+ * @brief Per-cell index kept next to the containers, the default one keeps nothing.
+ *
+ * An index gets Insert() and Remove() calls for every object added to or removed
+ * from the cell and is available to visitors by GetIndex().
+ */
+struct GridNullIndex
+{
+    template<class T> void Insert(T*) {}
+    template<class T> void Remove(T*) {}
+};
+
 /**
  * @brief Grid is a logical segment of the game world represented inside MaNGOS.
  *
@@ -44,7 +56,7 @@ template<class A, class T, class O> class GridLoader;
  * Grid's perspective, the loader meets its API requirement is suffice.
  */
 
-template <typename ACTIVE_OBJECT, typename WORLD_CONTAINER, typename GRID_CONTAINER>
+template <typename ACTIVE_OBJECT, typename WORLD_CONTAINER, typename GRID_CONTAINER, typename CELL_INDEX = GridNullIndex>
 class Grid
 {
         // allows the GridLoader to access its internals
@@ -61,7 +73,13 @@ class Grid
          */
         bool AddWorldObject(SPECIFIC_OBJECT* obj)
         {
-            return i_worldContainer.template insert<SPECIFIC_OBJECT>(obj);
+            if (!i_worldContainer.template insert<SPECIFIC_OBJECT>(obj))
+            {
+                return false;
+            }
+
+            i_index.Insert(obj);
+            return true;
         }
 
         template<class SPECIFIC_OBJECT>
@@ -73,6 +91,7 @@ class Grid
          */
         bool RemoveWorldObject(SPECIFIC_OBJECT* obj)
         {
+            i_index.Remove(obj);
             return i_worldContainer.template remove<SPECIFIC_OBJECT>(obj);
         }
 
@@ -90,7 +109,13 @@ class Grid
                 m_activeGridObjects.insert(obj);
             }
 
-            return i_gridContainer.template insert<SPECIFIC_OBJECT>(obj);
+            if (!i_gridContainer.template insert<SPECIFIC_OBJECT>(obj))
+            {
+                return false;
+            }
+
+            i_index.Insert(obj);
+            return true;
         }
 
         template<class SPECIFIC_OBJECT>
@@ -107,6 +132,7 @@ class Grid
                 m_activeGridObjects.erase(obj);
             }
 
+            i_index.Remove(obj);
             return i_gridContainer.template remove<SPECIFIC_OBJECT>(obj);
         }
 
@@ -122,6 +148,13 @@ class Grid
             visitor.Visit(i_worldContainer);
         }
 
+        /**
+         * @brief The index of the objects in this cell
+         *
+         * @return const CELL_INDEX
+         */
+        const CELL_INDEX& GetIndex() const { return i_index; }
+
         size_t ActiveObjectsInGrid() const
         {
             return m_activeGridObjects.size() + i_worldContainer.template count<ACTIVE_OBJECT>(nullptr);
@@ -130,6 +163,7 @@ class Grid
     private:
         GRID_CONTAINER  i_gridContainer;
         WORLD_CONTAINER i_worldContainer;
+        CELL_INDEX i_index;
         std::set<void*> m_activeGridObjects;
 };
 
@@ -137,7 +137,8 @@ template
 uint32 N,
        class ACTIVE_OBJECT,
        class WORLD_OBJECT_TYPES,
-       class GRID_OBJECT_TYPES
+       class GRID_OBJECT_TYPES,
+       class CELL_INDEX = GridNullIndex
        >
 /**
  * @brief
@@ -151,7 +152,7 @@ class NGrid
          * @brief
          *
          */
-        using GridType = Grid<ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES>;
+        using GridType = Grid<ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES, CELL_INDEX>;
 
         /**
          * @brief
@@ -241,7 +242,7 @@ class NGrid
          * @param WORLD_OBJECT_TYPES
          * @param pTo
          */
-        void link(GridRefManager<NGrid<N, ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES> >* pTo)
+        void link(GridRefManager<NGrid<N, ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES, CELL_INDEX> >* pTo)
         {
             i_Reference.link(pTo, this);
         }
@@ -425,7 +426,7 @@ class NGrid
 
         uint32 i_gridId; /**< TODO */
         GridInfo i_GridInfo; /**< TODO */
-        GridReference<NGrid<N, ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES> > i_Reference; /**< TODO */
+        GridReference<NGrid<N, ACTIVE_OBJECT, WORLD_OBJECT_TYPES, GRID_OBJECT_TYPES, CELL_INDEX> > i_Reference; /**< TODO */
         uint32 i_x; /**< TODO */
         uint32 i_y; /**< TODO */
         grid_state_t i_cellstate; /**< TODO */
@@ -0,0 +1,173 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace ACE_Based
+{
+    template <class T>
+    /**
+     * @brief Unbounded lock-free queue for many producers and a single consumer.
+     *
+     * Drop-in replacement for LockedQueue where only one thread at a time takes items out:
+     * add() may be called from any thread, next() and empty() only by the consumer.
+     * Producers link their node with one atomic exchange and never wait for each other
+     * or for the consumer. An item is visible to the consumer once its producer linked it,
+     * so during an add() the queue may briefly look shorter than it is.
+     */
+    class MPSCQueue
+    {
+            /**
+             * @brief
+             *
+             */
+            struct Node
+            {
+                Node() : data(), next(NULL) {}
+                explicit Node(const T& item) : data(item), next(NULL) {}
+
+                T data; /**< The item, unused in the stub node. */
+                std::atomic<Node*> next; /**< Node added after this one. */
+            };
+
+            std::atomic<Node*> _head; /**< Node added last, swapped by the producers. */
+            Node* _tail; /**< Stub node in front of the next item, owned by the consumer. */
+
+            MPSCQueue(const MPSCQueue&);
+            MPSCQueue& operator=(const MPSCQueue&);
+
+        public:
+
+            /**
+             * @brief Create an empty MPSCQueue.
+             *
+             */
+            MPSCQueue() : _head(new Node()), _tail(_head.load(std::memory_order_relaxed))
+            {
+            }
+
+            /**
+             * @brief Destroy a MPSCQueue, the items left in it are dropped.
+             *
+             */
+            virtual ~MPSCQueue()
+            {
+                while (Node* node = _tail->next.load(std::memory_order_relaxed))
+                {
+                    delete _tail;
+                    _tail = node;
+                }
+
+                delete _tail;
+            }
+
+            /**
+             * @brief Adds an item to the queue, safe from any thread.
+             *
+             * @param item
+             */
+            void add(const T& item)
+            {
+                Node* node = new Node(item);
+                Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+                prev->next.store(node, std::memory_order_release);
+            }
+
+            /**
+             * @brief Gets the next item in the queue, if any. Consumer only.
+             *
+             * @param result
+             * @return bool
+             */
+            bool next(T& result)
+            {
+                Node* node = _tail->next.load(std::memory_order_acquire);
+                if (!node)
+                {
+                    return false;
+                }
+
+                result = node->data;
+                pop(node);
+                return true;
+            }
+
+            template<class Checker>
+            /**
+             * @brief Gets the next item if the checker accepts it. Consumer only.
+             *
+             * A rejected item stays at the front of the queue.
+             *
+             * @param result
+             * @param check
+             * @return bool
+             */
+            bool next(T& result, Checker& check)
+            {
+                Node* node = _tail->next.load(std::memory_order_acquire);
+                if (!node)
+                {
+                    return false;
+                }
+
+                result = node->data;
+                if (!check.Process(result))
+                {
+                    return false;
+                }
+
+                pop(node);
+                return true;
+            }
+
+            /**
+             * @brief Checks if we're empty or not. Consumer only.
+             *
+             * @return bool
+             */
+            bool empty() const
+            {
+                return _tail->next.load(std::memory_order_acquire) == NULL;
+            }
+
+        private:
+
+            /**
+             * @brief Make the node of the taken item the new stub.
+             *
+             * @param node
+             */
+            void pop(Node* node)
+            {
+                node->data = T();
+                delete _tail;
+                _tail = node;
+            }
+    };
+}
+#endif
@@ -416,6 +416,12 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, ACE_Th
          * @return bool
          */
         bool IsIncludeTime() const { return m_includeTime; }
+        /**
+         * @brief Directory of the log files from LogsDir, empty or ending with a path separator
+         *
+         * @return const std::string
+         */
+        std::string const& GetLogsDir() const { return m_logsDir; }
 
         /**
          * @brief
@@ -24,6 +24,187 @@
 
 #include "ByteBuffer.h"
 #include "Log/Log.h"
+#include "Utilities/Timer.h"
+
+#include <new>
+
+/// Number of pooled size classes, BYTEBUFFER_POOL_MIN_SIZE to BYTEBUFFER_POOL_MAX_SIZE.
+#define BYTEBUFFER_POOL_CLASSES     9
+/// Local counter changes a thread collects before adding them to the global ones.
+#define BYTEBUFFER_POOL_STATS_BATCH 256
+
+namespace
+{
+    /// Pooled block, the link is stored in the block itself.
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    /// Free lists and counters of one thread, trivially destructible so it can be
+    /// used for the buffers destroyed after ByteBufferCacheCleanup ran.
+    struct ByteBufferCache
+    {
+        FreeBlock* blocks[BYTEBUFFER_POOL_CLASSES];
+        uint32 count[BYTEBUFFER_POOL_CLASSES];
+        uint64 allocations;
+        uint64 mallocs;
+        uint64 frees;
+        uint32 pending;
+        bool attached;
+        bool closed;
+    };
+
+    static thread_local ByteBufferCache t_cache;
+
+    std::atomic<uint64> s_allocations(0);
+    std::atomic<uint64> s_mallocs(0);
+    std::atomic<uint64> s_frees(0);
+    std::atomic<uint64> s_ticks(0);
+    std::atomic<uint32> s_since(0);
+
+    void FlushStats(ByteBufferCache& cache)
+    {
+        s_allocations.fetch_add(cache.allocations, std::memory_order_relaxed);
+        s_mallocs.fetch_add(cache.mallocs, std::memory_order_relaxed);
+        s_frees.fetch_add(cache.frees, std::memory_order_relaxed);
+        cache.allocations = cache.mallocs = cache.frees = 0;
+        cache.pending = 0;
+    }
+
+    void CountOperation(ByteBufferCache& cache)
+    {
+        if (++cache.pending >= BYTEBUFFER_POOL_STATS_BATCH)
+        {
+            FlushStats(cache);
+        }
+    }
+
+    /// Gives the free lists of an exiting thread back to the global allocator.
+    struct ByteBufferCacheCleanup
+    {
+        ~ByteBufferCacheCleanup()
+        {
+            for (int i = 0; i < BYTEBUFFER_POOL_CLASSES; ++i)
+            {
+                while (FreeBlock* block = t_cache.blocks[i])
+                {
+                    t_cache.blocks[i] = block->next;
+                    ::operator delete(block);
+                    ++t_cache.frees;
+                }
+
+                t_cache.count[i] = 0;
+            }
+
+            FlushStats(t_cache);
+            t_cache.closed = true;
+        }
+    };
+
+    static thread_local ByteBufferCacheCleanup t_cacheCleanup;
+
+    /// Size class of a request, BYTEBUFFER_POOL_CLASSES if it is not pooled.
+    int SizeClass(size_t size)
+    {
+        if (size > BYTEBUFFER_POOL_MAX_SIZE)
+        {
+            return BYTEBUFFER_POOL_CLASSES;
+        }
+
+        int sizeClass = 0;
+        for (size_t classSize = BYTEBUFFER_POOL_MIN_SIZE; classSize < size; classSize <<= 1)
+        {
+            ++sizeClass;
+        }
+
+        return sizeClass;
+    }
+}
+
+void* ByteBufferPool::Allocate(size_t size)
+{
+    ByteBufferCache& cache = t_cache;
+    ++cache.allocations;
+
+    int sizeClass = SizeClass(size);
+    if (sizeClass < BYTEBUFFER_POOL_CLASSES)
+    {
+        if (FreeBlock* block = cache.blocks[sizeClass])
+        {
+            cache.blocks[sizeClass] = block->next;
+            --cache.count[sizeClass];
+            CountOperation(cache);
+            return block;
+        }
+
+        size = size_t(BYTEBUFFER_POOL_MIN_SIZE) << sizeClass;
+    }
+
+    ++cache.mallocs;
+    CountOperation(cache);
+    return ::operator new(size);
+}
+
+void ByteBufferPool::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    ByteBufferCache& cache = t_cache;
+
+    int sizeClass = SizeClass(size);
+    if (sizeClass < BYTEBUFFER_POOL_CLASSES && !cache.closed &&
+        cache.count[sizeClass] < BYTEBUFFER_POOL_CACHE_BYTES / (size_t(BYTEBUFFER_POOL_MIN_SIZE) << sizeClass))
+    {
+        if (!cache.attached)
+        {
+            // the cleanup of the thread only runs once it was used
+            (void)&t_cacheCleanup;
+            cache.attached = true;
+        }
+
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = cache.blocks[sizeClass];
+        cache.blocks[sizeClass] = block;
+        ++cache.count[sizeClass];
+        return;
+    }
+
+    ::operator delete(ptr);
+    ++cache.frees;
+    CountOperation(cache);
+}
+
+void ByteBufferPool::CountTick()
+{
+    s_ticks.fetch_add(1, std::memory_order_relaxed);
+}
+
+ByteBufferPool::Stats ByteBufferPool::GetStats()
+{
+    // include what the calling thread did not flush yet
+    FlushStats(t_cache);
+
+    Stats stats;
+    stats.allocations = s_allocations.load(std::memory_order_relaxed);
+    stats.mallocs = s_mallocs.load(std::memory_order_relaxed);
+    stats.frees = s_frees.load(std::memory_order_relaxed);
+    stats.ticks = s_ticks.load(std::memory_order_relaxed);
+    stats.since = s_since.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ByteBufferPool::ResetStats()
+{
+    s_allocations.store(0, std::memory_order_relaxed);
+    s_mallocs.store(0, std::memory_order_relaxed);
+    s_frees.store(0, std::memory_order_relaxed);
+    s_ticks.store(0, std::memory_order_relaxed);
+    s_since.store(getMSTime(), std::memory_order_relaxed);
+}
 
 void ByteBufferException::PrintPosError() const
 {
@@ -76,6 +76,89 @@ struct Unused
     Unused() {}
 };
 
+/// Smallest pooled block, requests are rounded up to a power of two from here.
+#define BYTEBUFFER_POOL_MIN_SIZE    64
+/// Largest pooled block, larger storage is always taken from the global allocator.
+#define BYTEBUFFER_POOL_MAX_SIZE    16384
+/// Bytes one thread keeps in the free list of each size class at most.
+#define BYTEBUFFER_POOL_CACHE_BYTES (256 * 1024)
+
+/**
+ * @brief Size classed storage pool for ByteBuffer and WorldPacket.
+ *
+ * Requests up to BYTEBUFFER_POOL_MAX_SIZE bytes are served from a free list of the
+ * calling thread, larger ones go to the global allocator. Blocks freed by another thread than the one
+ * that allocated them simply join the free list of the freeing thread.
+ */
+class ByteBufferPool
+{
+    public:
+        /**
+         * @brief Allocation counters over all threads, lagging a little behind the threads.
+         *
+         */
+        struct Stats
+        {
+            uint64 allocations;                             /**< storage requests */
+            uint64 mallocs;                                 /**< requests that reached the global allocator */
+            uint64 frees;                                   /**< blocks given back to the global allocator */
+            uint64 ticks;                                   /**< world ticks counted by CountTick() */
+            uint32 since;                                   /**< getMSTime() of the last reset */
+        };
+
+        /**
+         * @brief
+         *
+         * @param size
+         * @return void
+         */
+        static void* Allocate(size_t size);
+        /**
+         * @brief
+         *
+         * @param ptr
+         * @param size the size passed to Allocate()
+         */
+        static void Deallocate(void* ptr, size_t size);
+
+        /**
+         * @brief Called once per world tick, for the per tick rates of the counters.
+         *
+         */
+        static void CountTick();
+        /**
+         * @brief
+         *
+         * @return Stats
+         */
+        static Stats GetStats();
+        /**
+         * @brief
+         *
+         */
+        static void ResetStats();
+};
+
+template<class T>
+/**
+ * @brief Allocator handing the ByteBuffer storage to ByteBufferPool.
+ *
+ */
+class ByteBufferAllocator
+{
+    public:
+        typedef T value_type;
+
+        ByteBufferAllocator() {}
+        template<class U> ByteBufferAllocator(const ByteBufferAllocator<U>&) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(ByteBufferPool::Allocate(n * sizeof(T))); }
+        void deallocate(T* p, size_t n) { ByteBufferPool::Deallocate(p, n * sizeof(T)); }
+
+        template<class U> bool operator==(const ByteBufferAllocator<U>&) const { return true; }
+        template<class U> bool operator!=(const ByteBufferAllocator<U>&) const { return false; }
+};
+
 /**
  * @brief
  *
@@ -797,7 +880,7 @@ class ByteBuffer
 
     protected:
         size_t _rpos, _wpos; /**< TODO */
-        std::vector<uint8> _storage; /**< TODO */
+        std::vector<uint8, ByteBufferAllocator<uint8> > _storage; /**< TODO */
 };
 
 template <typename T>
@@ -0,0 +1,54 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_PACKETCAPTUREFILE
+#define MANGOS_H_PACKETCAPTUREFILE
+
+/**
+ * Layout of the packet capture files written by mangosd (PacketCapture) and read by the
+ * load test tools. All numbers are little-endian.
+ *
+ * The file starts with a header:
+ *   uint32 magic, uint16 version, uint16 reserved, uint64 capture start (unix time)
+ * followed by the records, each one:
+ *   uint8 type, uint32 ms since the capture start, uint32 session, uint16 opcode, uint16 size, size bytes
+ *
+ * Sessions are numbered by the server per connection, not by account, and the numbers
+ * are not reused while the server runs.
+ */
+
+/// "MPCF"
+#define PACKET_CAPTURE_MAGIC        0x4643504D
+#define PACKET_CAPTURE_VERSION      1
+#define PACKET_CAPTURE_HEADER_SIZE  16
+#define PACKET_CAPTURE_RECORD_SIZE  13
+
+enum PacketCaptureRecordType
+{
+    PACKET_CAPTURE_SESSION_OPEN     = 0,                    ///< client authenticated, payload: uint32 client build
+    PACKET_CAPTURE_PACKET           = 1,                    ///< decrypted packet received from the client
+    PACKET_CAPTURE_SESSION_CLOSE    = 2                     ///< connection closed, no payload
+};
+
+#endif
@@ -29,6 +29,8 @@
 #include "ByteBuffer.h"
 #include "Opcodes.h"
 
+#include <memory>
+
 // Note: m_opcode and size stored in platfom dependent format
 // ignore endianess until send, and converted at receive
 /**
@@ -96,4 +98,18 @@ class WorldPacket : public ByteBuffer
     protected:
         uint16 m_opcode; /**< TODO */
 };
+
+/**
+ * @brief Immutable packet shared by the send queues of several sockets.
+ *
+ * Only the header of a packet is encrypted, so one payload can be written to every receiver
+ * of a broadcast without being copied for each of them.
+ */
+typedef std::shared_ptr<WorldPacket const> SharedWorldPacket;
+
+/**
+ * @brief Payloads smaller than this are copied into the socket buffers instead of being shared.
+ */
+#define SHARED_PACKET_MIN_SIZE 32
+
 #endif
@@ -0,0 +1,95 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "CaptureReader.h"
+#include "ByteBuffer.h"
+
+CaptureReader::CaptureReader() : m_file(NULL), m_startTime(0)
+{
+}
+
+CaptureReader::~CaptureReader()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+    }
+}
+
+bool CaptureReader::Open(std::string const& fileName)
+{
+    m_file = fopen(fileName.c_str(), "rb");
+    if (!m_file)
+    {
+        printf("Can't open %s.\n", fileName.c_str());
+        return false;
+    }
+
+    uint8 data[PACKET_CAPTURE_HEADER_SIZE];
+    if (fread(data, 1, PACKET_CAPTURE_HEADER_SIZE, m_file) != PACKET_CAPTURE_HEADER_SIZE)
+    {
+        printf("%s is not a packet capture.\n", fileName.c_str());
+        return false;
+    }
+
+    ByteBuffer header(PACKET_CAPTURE_HEADER_SIZE);
+    header.append(data, PACKET_CAPTURE_HEADER_SIZE);
+
+    uint32 magic;
+    uint16 version, reserved;
+    header >> magic >> version >> reserved >> m_startTime;
+
+    if (magic != PACKET_CAPTURE_MAGIC)
+    {
+        printf("%s is not a packet capture.\n", fileName.c_str());
+        return false;
+    }
+
+    if (version != PACKET_CAPTURE_VERSION)
+    {
+        printf("%s is a capture of version %u, version %u is supported.\n", fileName.c_str(), uint32(version),
+               uint32(PACKET_CAPTURE_VERSION));
+        return false;
+    }
+
+    return true;
+}
+
+bool CaptureReader::Next(CaptureRecord& record)
+{
+    uint8 data[PACKET_CAPTURE_RECORD_SIZE];
+    if (fread(data, 1, PACKET_CAPTURE_RECORD_SIZE, m_file) != PACKET_CAPTURE_RECORD_SIZE)
+    {
+        return false;
+    }
+
+    ByteBuffer header(PACKET_CAPTURE_RECORD_SIZE);
+    header.append(data, PACKET_CAPTURE_RECORD_SIZE);
+
+    uint16 size;
+    header >> record.type >> record.time >> record.session >> record.opcode >> size;
+
+    record.payload.resize(size);
+    return !size || fread(&record.payload[0], 1, size, m_file) == size;
+}
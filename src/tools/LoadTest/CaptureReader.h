@@ -0,0 +1,68 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_CAPTUREREADER
+#define MANGOS_H_CAPTUREREADER
+
+#include "Common.h"
+#include "PacketCaptureFile.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// One record of a packet capture
+struct CaptureRecord
+{
+    uint8 type;                                             ///< PacketCaptureRecordType
+    uint32 time;                                            ///< ms since the capture start
+    uint32 session;
+    uint16 opcode;
+    std::vector<uint8> payload;
+};
+
+/**
+ * @brief Reads a capture written by mangosd (Network.CaptureFile, .server capture) record by record.
+ */
+class CaptureReader
+{
+    public:
+        CaptureReader();
+        ~CaptureReader();
+
+        /// Opens the file and checks its header
+        bool Open(std::string const& fileName);
+
+        /// @return false at the end of the file, or when the last record is cut off
+        bool Next(CaptureRecord& record);
+
+        /// Unix time the capture started at
+        uint64 GetStartTime() const { return m_startTime; }
+
+    private:
+        FILE* m_file;
+        uint64 m_startTime;
+};
+
+#endif
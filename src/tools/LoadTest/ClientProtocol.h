@@ -0,0 +1,111 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_CLIENTPROTOCOL
+#define MANGOS_H_CLIENTPROTOCOL
+
+#include "Common.h"
+#include "ByteBuffer.h"
+
+/**
+ * The parts of the 1.12 client protocol the load test clients use. The values are those of
+ * Opcodes.h and SharedDefines.h in the game library, which the tools don't link.
+ */
+
+/// Client build sent by default, the one mangosd accepts out of the box
+#define LOAD_CLIENT_BUILD 5875
+
+enum RealmCommand
+{
+    REALM_CMD_LOGON_CHALLENGE       = 0x00,
+    REALM_CMD_LOGON_PROOF           = 0x01
+};
+
+enum ClientOpcode
+{
+    CMSG_CHAR_CREATE                = 0x036,
+    CMSG_CHAR_ENUM                  = 0x037,
+    CMSG_CHAR_DELETE                = 0x038,
+    SMSG_CHAR_ENUM                  = 0x03B,
+    CMSG_PLAYER_LOGIN               = 0x03D,
+    SMSG_CHARACTER_LOGIN_FAILED     = 0x041,
+    SMSG_LOGOUT_COMPLETE            = 0x04D,
+    CMSG_MESSAGECHAT                = 0x095,
+    SMSG_MESSAGECHAT                = 0x096,
+    MSG_MOVE_START_FORWARD          = 0x0B5,
+    MSG_MOVE_STOP                   = 0x0B7,
+    MSG_MOVE_SET_FACING             = 0x0DA,
+    MSG_MOVE_HEARTBEAT              = 0x0EE,
+    CMSG_CAST_SPELL                 = 0x12E,
+    SMSG_CAST_FAILED                = 0x130,
+    SMSG_SPELL_START                = 0x131,
+    SMSG_SPELL_GO                   = 0x132,
+    CMSG_QUERY_TIME                 = 0x1CE,
+    SMSG_QUERY_TIME_RESPONSE        = 0x1CF,
+    CMSG_PING                       = 0x1DC,
+    SMSG_PONG                       = 0x1DD,
+    SMSG_AUTH_CHALLENGE             = 0x1EC,
+    CMSG_AUTH_SESSION               = 0x1ED,
+    SMSG_AUTH_RESPONSE              = 0x1EE,
+    SMSG_LOGIN_VERIFY_WORLD         = 0x236,
+    CMSG_CHAR_RENAME                = 0x2C7
+};
+
+/// Subset of MovementFlags
+enum ClientMovementFlags
+{
+    CLIENT_MOVEFLAG_NONE            = 0x00000000,
+    CLIENT_MOVEFLAG_FORWARD         = 0x00000001
+};
+
+/// Subset of ChatMsg and Language
+enum ClientChat
+{
+    CLIENT_CHAT_MSG_SAY             = 0x00,
+    CLIENT_LANG_ORCISH              = 1,
+    CLIENT_LANG_COMMON              = 7
+};
+
+enum ClientAuthResponse
+{
+    CLIENT_AUTH_OK                  = 0x0C,
+    CLIENT_AUTH_WAIT_QUEUE          = 0x1B
+};
+
+/**
+ * @brief Packet of the world protocol as the load test clients build and receive it.
+ */
+class ClientPacket : public ByteBuffer
+{
+    public:
+        explicit ClientPacket(uint16 opcode = 0, size_t reserve = 64) : ByteBuffer(reserve), m_opcode(opcode) {}
+
+        uint16 GetOpcode() const { return m_opcode; }
+        void SetOpcode(uint16 opcode) { m_opcode = opcode; }
+
+    private:
+        uint16 m_opcode;
+};
+
+#endif
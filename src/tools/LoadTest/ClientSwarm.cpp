@@ -0,0 +1,711 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/**
+ * client-swarm: runs many simulated clients against a realm over loopback and reports how
+ * the server keeps up with them.
+ *
+ * The clients log in with the accounts ACCOUNT1 .. ACCOUNTn sharing one password, each with
+ * at least one character, at a fixed rate. In the world every client runs back and forth,
+ * says something now and then and casts a spell if asked to. Round trips are measured for
+ * CMSG_PING (answered by the network thread), CMSG_QUERY_TIME (answered in the map update),
+ * the own say coming back and the cast being answered with the spell start or a failure.
+ */
+
+#include "LoadTest.h"
+#include "LoadClient.h"
+#include "TickReport.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Reactor.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <map>
+
+/// Length of the run of the clients in one direction, in yards
+#define SWARM_LEG_LENGTH 10.0f
+/// Run speed of a character without auras, in yards per second
+#define SWARM_RUN_SPEED 7.0f
+/// Interval of CMSG_PING like the game client, the server kicks clients pinging much faster
+#define SWARM_PING_INTERVAL 30
+/// Requests not answered within this many seconds are counted as lost
+#define SWARM_REQUEST_TIMEOUT 10
+
+/// What the clients do in the world, intervals in ms, 0 leaves the behaviour out
+struct SwarmBehaviour
+{
+    SwarmBehaviour() : moveInterval(500), chatInterval(10000), castInterval(5000), spellId(0), queryInterval(1000) {}
+
+    uint32 moveInterval;                                    ///< of MSG_MOVE_HEARTBEAT
+    uint32 chatInterval;
+    uint32 castInterval;
+    uint32 spellId;                                         ///< cast on the caster itself, 0 for none
+    uint32 queryInterval;                                   ///< of CMSG_QUERY_TIME
+};
+
+/// Round trips of one kind of request
+struct SwarmLatency
+{
+    SwarmLatency() : lost(0) {}
+
+    std::vector<uint32> samples;                            ///< usec
+    uint32 lost;
+};
+
+/// Results of all clients of the swarm
+struct SwarmStats
+{
+    SwarmStats() : packetsSent(0), packetsReceived(0), bytesReceived(0) {}
+
+    SwarmLatency ping;
+    SwarmLatency query;
+    SwarmLatency chat;
+    SwarmLatency cast;
+    uint64 packetsSent;
+    uint64 packetsReceived;
+    uint64 bytesReceived;
+};
+
+/// Client running the scripted behaviour
+class SwarmClient : public LoadClient
+{
+    public:
+        SwarmClient(ACE_Reactor* reactor, LoadClientConfig const& config, std::string const& account,
+                    SwarmBehaviour const& behaviour, SwarmStats& stats) :
+            LoadClient(reactor, config, account), m_behaviour(behaviour), m_stats(stats), m_x(0.0f), m_y(0.0f),
+            m_z(0.0f), m_o(0.0f), m_legDone(0.0f), m_chatCount(0), m_pingCount(0), m_lastPing(0)
+        {
+        }
+
+        void Update(ACE_Time_Value const& now) override
+        {
+            if (GetState() != STATE_IN_WORLD)
+            {
+                return;
+            }
+
+            if (m_behaviour.moveInterval && now >= m_nextMove)
+            {
+                Move(now);
+                m_nextMove = now + Interval(m_behaviour.moveInterval);
+            }
+
+            if (m_behaviour.chatInterval && now >= m_nextChat)
+            {
+                Say(now);
+                m_nextChat = now + Interval(m_behaviour.chatInterval);
+            }
+
+            if (m_behaviour.spellId && m_behaviour.castInterval && now >= m_nextCast)
+            {
+                Cast(now);
+                m_nextCast = now + Interval(m_behaviour.castInterval);
+            }
+
+            if (m_behaviour.queryInterval && now >= m_nextQuery)
+            {
+                ClientPacket packet(CMSG_QUERY_TIME, 0);
+                Send(packet);
+                m_queries.push_back(now);
+                m_nextQuery = now + Interval(m_behaviour.queryInterval);
+            }
+
+            if (now >= m_nextPing)
+            {
+                Ping(now);
+                m_nextPing = now + ACE_Time_Value(SWARM_PING_INTERVAL);
+            }
+
+            ExpireRequests(now);
+        }
+
+        /// Counts the requests still unanswered as lost, at the end of the test
+        void Finish()
+        {
+            m_stats.query.lost += uint32(m_queries.size());
+            m_stats.chat.lost += uint32(m_chats.size());
+            m_stats.cast.lost += m_castSent != ACE_Time_Value::zero ? 1 : 0;
+            m_stats.ping.lost += m_pingSent != ACE_Time_Value::zero ? 1 : 0;
+
+            m_queries.clear();
+            m_chats.clear();
+            m_castSent = ACE_Time_Value::zero;
+            m_pingSent = ACE_Time_Value::zero;
+        }
+
+    protected:
+        void OnEnterWorld(uint32 /*mapId*/, float x, float y, float z, float o) override
+        {
+            m_x = x;
+            m_y = y;
+            m_z = z;
+            m_o = o;
+            m_legDone = 0.0f;
+
+            // spread the first requests over an interval, so the clients logged in together do not act together
+            ACE_Time_Value now = ACE_OS::gettimeofday();
+            m_lastMove = now;
+            m_nextMove = now + Interval(m_behaviour.moveInterval);
+            m_nextChat = now + RandomInterval(m_behaviour.chatInterval);
+            m_nextCast = now + RandomInterval(m_behaviour.castInterval);
+            m_nextQuery = now + RandomInterval(m_behaviour.queryInterval);
+            m_nextPing = now + RandomInterval(SWARM_PING_INTERVAL * IN_MILLISECONDS);
+
+            if (m_behaviour.moveInterval)
+            {
+                SendMovement(MSG_MOVE_START_FORWARD, CLIENT_MOVEFLAG_FORWARD, now);
+            }
+        }
+
+        void OnWorldPacket(ClientPacket& packet) override
+        {
+            ++m_stats.packetsReceived;
+            m_stats.bytesReceived += packet.size();
+
+            ACE_Time_Value now = ACE_OS::gettimeofday();
+
+            switch (packet.GetOpcode())
+            {
+                case SMSG_PONG:
+                {
+                    if (m_pingSent == ACE_Time_Value::zero)
+                    {
+                        break;
+                    }
+
+                    uint32 sequence;
+                    packet >> sequence;
+                    if (sequence == m_pingCount)
+                    {
+                        m_lastPing = uint32((now - m_pingSent).msec());
+                        AddSample(m_stats.ping, m_pingSent, now);
+                        m_pingSent = ACE_Time_Value::zero;
+                    }
+                    break;
+                }
+                case SMSG_QUERY_TIME_RESPONSE:
+                    if (!m_queries.empty())
+                    {
+                        AddSample(m_stats.query, m_queries.front(), now);
+                        m_queries.pop_front();
+                    }
+                    break;
+                case SMSG_MESSAGECHAT:
+                    // the says of the other clients nearby arrive here too
+                    if (!m_chats.empty() && packet.size() && Contains(packet, m_chats.front().first))
+                    {
+                        AddSample(m_stats.chat, m_chats.front().second, now);
+                        m_chats.pop_front();
+                    }
+                    break;
+                case SMSG_CAST_FAILED:
+                {
+                    uint32 spellId;
+                    packet >> spellId;
+                    if (spellId == m_behaviour.spellId)
+                    {
+                        CastAnswered(now);
+                    }
+                    break;
+                }
+                case SMSG_SPELL_START:
+                case SMSG_SPELL_GO:
+                {
+                    packet.readPackGUID();                  // item or caster
+                    uint64 caster = packet.readPackGUID();
+                    uint32 spellId;
+                    packet >> spellId;
+                    if (caster == GetCharacterGuid() && spellId == m_behaviour.spellId)
+                    {
+                        CastAnswered(now);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+    private:
+        typedef std::deque<std::pair<std::string, ACE_Time_Value> > ChatQueue;
+
+        static ACE_Time_Value Interval(uint32 ms) { return ACE_Time_Value(ms / IN_MILLISECONDS, (ms % IN_MILLISECONDS) * 1000); }
+        static ACE_Time_Value RandomInterval(uint32 ms) { return Interval(ms ? uint32(rand()) % ms : 0); }
+
+        static void AddSample(SwarmLatency& latency, ACE_Time_Value const& sent, ACE_Time_Value const& now)
+        {
+            ACE_Time_Value elapsed = now - sent;
+            latency.samples.push_back(uint32(elapsed.sec() * 1000000 + elapsed.usec()));
+        }
+
+        static bool Contains(ClientPacket const& packet, std::string const& text)
+        {
+            uint8 const* begin = packet.contents();
+            uint8 const* end = begin + packet.size();
+            return std::search(begin, end, text.begin(), text.end()) != end;
+        }
+
+        void Send(ClientPacket const& packet)
+        {
+            SendPacket(packet);
+            ++m_stats.packetsSent;
+        }
+
+        /// Time of the client in ms, as sent in the movement packets
+        uint32 ClientTime(ACE_Time_Value const& now) const { return uint32(now.msec()); }
+
+        void SendMovement(uint16 opcode, uint32 flags, ACE_Time_Value const& now)
+        {
+            ClientPacket packet(opcode, 28);
+            packet << uint32(flags);
+            packet << uint32(ClientTime(now));
+            packet << m_x << m_y << m_z << m_o;
+            packet << uint32(0);                            // fall time
+            Send(packet);
+        }
+
+        /// Runs on along the leg and turns around at its end
+        void Move(ACE_Time_Value const& now)
+        {
+            float elapsed = float((now - m_lastMove).msec()) / IN_MILLISECONDS;
+            float distance = std::min(SWARM_RUN_SPEED * elapsed, SWARM_LEG_LENGTH - m_legDone);
+            m_lastMove = now;
+
+            m_x += cos(m_o) * distance;
+            m_y += sin(m_o) * distance;
+            m_legDone += distance;
+
+            if (m_legDone < SWARM_LEG_LENGTH)
+            {
+                SendMovement(MSG_MOVE_HEARTBEAT, CLIENT_MOVEFLAG_FORWARD, now);
+                return;
+            }
+
+            SendMovement(MSG_MOVE_STOP, CLIENT_MOVEFLAG_NONE, now);
+
+            m_o += M_PI_F;
+            if (m_o >= 2.0f * M_PI_F)
+            {
+                m_o -= 2.0f * M_PI_F;
+            }
+            m_legDone = 0.0f;
+
+            SendMovement(MSG_MOVE_SET_FACING, CLIENT_MOVEFLAG_NONE, now);
+            SendMovement(MSG_MOVE_START_FORWARD, CLIENT_MOVEFLAG_FORWARD, now);
+        }
+
+        void Say(ACE_Time_Value const& now)
+        {
+            // races 1, 3, 4 and 7 are of the alliance
+            uint8 race = GetCharacterRace();
+            uint32 language = race == 1 || race == 3 || race == 4 || race == 7 ? CLIENT_LANG_COMMON : CLIENT_LANG_ORCISH;
+
+            char message[64];
+            snprintf(message, sizeof(message), "swarm %s %u", GetAccount().c_str(), ++m_chatCount);
+
+            ClientPacket packet(CMSG_MESSAGECHAT, 64);
+            packet << uint32(CLIENT_CHAT_MSG_SAY);
+            packet << uint32(language);
+            packet << message;
+            Send(packet);
+
+            m_chats.push_back(ChatQueue::value_type(message, now));
+        }
+
+        void Cast(ACE_Time_Value const& now)
+        {
+            // one cast at a time, the answer of the previous one tells when the next can start
+            if (m_castSent != ACE_Time_Value::zero)
+            {
+                return;
+            }
+
+            ClientPacket packet(CMSG_CAST_SPELL, 6);
+            packet << uint32(m_behaviour.spellId);
+            packet << uint16(0);                            // TARGET_FLAG_SELF
+            Send(packet);
+
+            m_castSent = now;
+        }
+
+        void CastAnswered(ACE_Time_Value const& now)
+        {
+            if (m_castSent != ACE_Time_Value::zero)
+            {
+                AddSample(m_stats.cast, m_castSent, now);
+                m_castSent = ACE_Time_Value::zero;
+            }
+        }
+
+        void Ping(ACE_Time_Value const& now)
+        {
+            if (m_pingSent != ACE_Time_Value::zero)
+            {
+                ++m_stats.ping.lost;
+            }
+
+            ClientPacket packet(CMSG_PING, 8);
+            packet << uint32(++m_pingCount);
+            packet << uint32(m_lastPing);
+            Send(packet);
+
+            m_pingSent = now;
+        }
+
+        /// Gives up on the requests the server did not answer in time
+        void ExpireRequests(ACE_Time_Value const& now)
+        {
+            ACE_Time_Value oldest = now - ACE_Time_Value(SWARM_REQUEST_TIMEOUT);
+
+            while (!m_queries.empty() && m_queries.front() < oldest)
+            {
+                m_queries.pop_front();
+                ++m_stats.query.lost;
+            }
+
+            // says can be dropped by the chat rate limit of the server
+            while (!m_chats.empty() && m_chats.front().second < oldest)
+            {
+                m_chats.pop_front();
+                ++m_stats.chat.lost;
+            }
+
+            if (m_castSent != ACE_Time_Value::zero && m_castSent < oldest)
+            {
+                m_castSent = ACE_Time_Value::zero;
+                ++m_stats.cast.lost;
+            }
+        }
+
+        SwarmBehaviour const& m_behaviour;
+        SwarmStats& m_stats;
+
+        float m_x, m_y, m_z, m_o;
+        float m_legDone;                                    ///< yards run since the last turn
+        ACE_Time_Value m_lastMove;
+
+        ACE_Time_Value m_nextMove;
+        ACE_Time_Value m_nextChat;
+        ACE_Time_Value m_nextCast;
+        ACE_Time_Value m_nextQuery;
+        ACE_Time_Value m_nextPing;
+
+        std::deque<ACE_Time_Value> m_queries;               ///< CMSG_QUERY_TIME sent, answered in order
+        ChatQueue m_chats;                                  ///< says sent, with the text to recognise them by
+        uint32 m_chatCount;
+        ACE_Time_Value m_castSent;                          ///< zero when no cast waits for its answer
+        ACE_Time_Value m_pingSent;                          ///< zero when no ping waits for its pong
+        uint32 m_pingCount;
+        uint32 m_lastPing;                                  ///< ms, reported to the server with the next ping
+};
+
+/// Logs the clients in, keeps them busy for a while and collects the results
+class ClientSwarm
+{
+    public:
+        ClientSwarm(LoadClientConfig const& config, SwarmBehaviour const& behaviour, std::string const& accountPrefix,
+                    uint32 clientCount, uint32 rampRate) :
+            m_config(config), m_behaviour(behaviour), m_accountPrefix(accountPrefix), m_clientCount(clientCount),
+            m_rampRate(rampRate), m_reactor(CreateLoadTestReactor()), m_inWorld(0), m_peakInWorld(0)
+        {
+        }
+
+        ~ClientSwarm()
+        {
+            for (std::vector<SwarmClient*>::const_iterator itr = m_clients.begin(); itr != m_clients.end(); ++itr)
+            {
+                delete *itr;
+            }
+
+            delete m_reactor;
+        }
+
+        /// Starts rampRate clients per second, then runs for duration seconds after the last one entered the world or failed
+        void Run(uint32 duration)
+        {
+            ACE_Time_Value start = ACE_OS::gettimeofday();
+            ACE_Time_Value end = ACE_Time_Value::zero;
+            m_clients.reserve(m_clientCount);
+
+            while (end == ACE_Time_Value::zero || ACE_OS::gettimeofday() < end)
+            {
+                ACE_Time_Value now = ACE_OS::gettimeofday();
+
+                uint64 due = std::min(uint64(m_clientCount), uint64((now - start).msec()) * m_rampRate / IN_MILLISECONDS + 1);
+                while (m_clients.size() < due)
+                {
+                    char account[64];
+                    snprintf(account, sizeof(account), "%s%u", m_accountPrefix.c_str(), uint32(m_clients.size() + 1));
+
+                    SwarmClient* client = new SwarmClient(m_reactor, m_config, account, m_behaviour, m_stats);
+                    m_clients.push_back(client);
+                    client->Start();
+                }
+
+                ACE_Time_Value wait(0, 1000);
+                m_reactor->handle_events(wait);
+
+                now = ACE_OS::gettimeofday();
+                uint32 inWorld = 0;
+                uint32 done = 0;
+                for (std::vector<SwarmClient*>::const_iterator itr = m_clients.begin(); itr != m_clients.end(); ++itr)
+                {
+                    SwarmClient* client = *itr;
+                    client->Update(now);
+
+                    if (client->GetState() == LoadClient::STATE_IN_WORLD)
+                    {
+                        ++inWorld;
+                    }
+                    if (client->IsDone() || client->GetLoginTime() != ACE_Time_Value::zero)
+                    {
+                        ++done;
+                    }
+                }
+
+                m_inWorld = inWorld;
+                m_peakInWorld = std::max(m_peakInWorld, inWorld);
+
+                if (end == ACE_Time_Value::zero && done == m_clientCount)
+                {
+                    m_rampTime = now - start;
+                    end = now + ACE_Time_Value(duration);
+                    printf("%u of %u clients in the world after %.1f s, running for %u s\n", inWorld, m_clientCount,
+                           m_rampTime.msec() / 1000.0, duration);
+                }
+            }
+
+            m_duration = ACE_OS::gettimeofday() - start;
+
+            for (std::vector<SwarmClient*>::const_iterator itr = m_clients.begin(); itr != m_clients.end(); ++itr)
+            {
+                (*itr)->Finish();
+                (*itr)->Close();
+            }
+        }
+
+        void Print()
+        {
+            std::vector<uint32> loginTimes;
+            std::map<std::string, uint32> failures;
+            uint32 failed = 0;
+
+            for (std::vector<SwarmClient*>::const_iterator itr = m_clients.begin(); itr != m_clients.end(); ++itr)
+            {
+                SwarmClient const* client = *itr;
+                if (client->GetLoginTime() != ACE_Time_Value::zero)
+                {
+                    loginTimes.push_back(uint32(client->GetLoginTime().msec()));
+                }
+
+                if (client->GetState() == LoadClient::STATE_FAILED)
+                {
+                    ++failures[client->GetError()];
+                    ++failed;
+                }
+            }
+
+            double rampSeconds = std::max(m_rampTime.msec() / 1000.0, 0.001);
+            double seconds = std::max(m_duration.msec() / 1000.0, 0.001);
+
+            printf("Ran %u clients for %.1f s:\n", m_clientCount, seconds);
+            printf("  entered the world %u, failed %u, in the world at the end %u, at most %u\n", uint32(loginTimes.size()),
+                   failed, m_inWorld, m_peakInWorld);
+            printf("  connect rate %.1f clients/s over the ramp of %.1f s\n", loginTimes.size() / rampSeconds, rampSeconds);
+            printf("  login time p50 %u ms, p95 %u ms, p99 %u ms, max %u ms\n", LoadTestPercentile(loginTimes, 50),
+                   LoadTestPercentile(loginTimes, 95), LoadTestPercentile(loginTimes, 99), LoadTestPercentile(loginTimes, 100));
+
+            for (std::map<std::string, uint32>::const_iterator itr = failures.begin(); itr != failures.end(); ++itr)
+            {
+                printf("  %u failed: %s\n", itr->second, itr->first.c_str());
+            }
+
+            printf("Round trips:\n");
+            PrintLatency("ping (network)", m_stats.ping);
+            PrintLatency("query time (map)", m_stats.query);
+            PrintLatency("say", m_stats.chat);
+            PrintLatency("spell cast", m_stats.cast);
+
+            printf("Packets sent %llu (%.0f/s), received %llu (%.0f/s, %.2f MB/s)\n",
+                   (unsigned long long)m_stats.packetsSent, m_stats.packetsSent / seconds,
+                   (unsigned long long)m_stats.packetsReceived, m_stats.packetsReceived / seconds,
+                   m_stats.bytesReceived / seconds / (1024 * 1024));
+        }
+
+    private:
+        static void PrintLatency(char const* name, SwarmLatency& latency)
+        {
+            if (latency.samples.empty() && !latency.lost)
+            {
+                return;
+            }
+
+            uint32 count = uint32(latency.samples.size());
+            printf("  %-18s %8u answered %6u lost   p50 %8.2f ms  p95 %8.2f ms  p99 %8.2f ms  max %8.2f ms\n", name, count,
+                   latency.lost, LoadTestPercentile(latency.samples, 50) / 1000.0, LoadTestPercentile(latency.samples, 95) / 1000.0,
+                   LoadTestPercentile(latency.samples, 99) / 1000.0, LoadTestPercentile(latency.samples, 100) / 1000.0);
+        }
+
+        LoadClientConfig const& m_config;
+        SwarmBehaviour const& m_behaviour;
+        std::string m_accountPrefix;
+        uint32 m_clientCount;
+        uint32 m_rampRate;                                  // clients started per second
+        ACE_Reactor* m_reactor;
+
+        std::vector<SwarmClient*> m_clients;
+        SwarmStats m_stats;
+        uint32 m_inWorld;
+        uint32 m_peakInWorld;
+        ACE_Time_Value m_rampTime;
+        ACE_Time_Value m_duration;
+};
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    printf("Usage: \n %s [<options>]\n"
+           "    -r <host[:port]>  realmd address, default 127.0.0.1:3724\n"
+           "    -w <host[:port]>  mangosd address, default 127.0.0.1:8085\n"
+           "    -a <prefix>       accounts are <prefix>1 .. <prefix>n, default SWARM\n"
+           "    -n <count>        number of clients, default 100\n"
+           "    -p <password>     password of the accounts, default LOADTEST\n"
+           "    -b <build>        client build, default %u\n"
+           "    -R <rate>         clients started per second, default 50\n"
+           "    -d <seconds>      time to run once all clients are in the world, default 60\n"
+           "    -m <ms>           movement heartbeat interval, 0 to stand still, default 500\n"
+           "    -c <ms>           say interval, 0 to keep quiet, default 10000\n"
+           "    -S <spell>        spell the characters know and cast on themselves, default none\n"
+           "    -C <ms>           spell cast interval, default 5000\n"
+           "    -q <ms>           CMSG_QUERY_TIME interval, default 1000\n"
+           "    -t <file>         PerfProfiler.CsvFile of the server, for the tick time report\n",
+           prog, uint32(LOAD_CLIENT_BUILD));
+}
+
+int main(int argc, char** argv)
+{
+    LoadClientConfig config;
+    ParseLoadTestAddress("127.0.0.1", 3724, config.realmAddress);
+    ParseLoadTestAddress("127.0.0.1", 8085, config.worldAddress);
+
+    SwarmBehaviour behaviour;
+    std::string accountPrefix = "SWARM";
+    uint32 clientCount = 100;
+    uint32 rampRate = 50;
+    uint32 duration = 60;
+    std::string tickFile;
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":r:w:a:n:p:b:R:d:m:c:S:C:q:t:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'r':
+                if (!ParseLoadTestAddress(cmd_opts.opt_arg(), 3724, config.realmAddress))
+                {
+                    printf("Invalid realmd address %s\n", cmd_opts.opt_arg());
+                    return 1;
+                }
+                break;
+            case 'w':
+                if (!ParseLoadTestAddress(cmd_opts.opt_arg(), 8085, config.worldAddress))
+                {
+                    printf("Invalid mangosd address %s\n", cmd_opts.opt_arg());
+                    return 1;
+                }
+                break;
+            case 'a':
+                accountPrefix = cmd_opts.opt_arg();
+                break;
+            case 'n':
+                clientCount = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'p':
+                config.password = cmd_opts.opt_arg();
+                break;
+            case 'b':
+                config.build = uint16(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'R':
+                rampRate = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'd':
+                duration = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'm':
+                behaviour.moveInterval = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'c':
+                behaviour.chatInterval = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'S':
+                behaviour.spellId = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'C':
+                behaviour.castInterval = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'q':
+                behaviour.queryInterval = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 't':
+                tickFile = cmd_opts.opt_arg();
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (cmd_opts.opt_ind() != argc || !clientCount || !rampRate)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(uint32(time(NULL)));
+    uint64 startTime = uint64(time(NULL));
+
+    ClientSwarm swarm(config, behaviour, accountPrefix, clientCount, rampRate);
+    swarm.Run(duration);
+    swarm.Print();
+
+    if (!tickFile.empty())
+    {
+        TickReport ticks;
+        if (ticks.Load(tickFile, startTime, uint64(time(NULL))))
+        {
+            ticks.Print();
+        }
+    }
+
+    return 0;
+}
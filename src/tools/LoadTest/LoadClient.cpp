@@ -0,0 +1,699 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "LoadClient.h"
+#include "Auth/Sha1.h"
+#include "Util.h"
+
+#include <ace/Reactor.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/os_include/netinet/os_tcp.h>
+
+#include <algorithm>
+#include <cstdio>
+
+/// Size of the complete answers of realmd to a 1.12 client
+#define REALM_CHALLENGE_SIZE 119
+#define REALM_PROOF_SIZE 26
+
+/// Bytes read from the socket per recv() call
+#define LOAD_CLIENT_RECV_SIZE 16384
+/// Seconds a connect to realmd or mangosd may take
+#define LOAD_CLIENT_CONNECT_TIMEOUT 10
+
+LoadClient::LoadClient(ACE_Reactor* reactor, LoadClientConfig const& config, std::string const& account) :
+    ACE_Event_Handler(reactor), m_config(config), m_account(account), m_state(STATE_IDLE), m_connecting(false), m_connectTimer(-1),
+    m_inputPos(0), m_outputPos(0), m_writing(false), m_sendI(0), m_sendJ(0), m_recvI(0), m_recvJ(0), m_headerReady(false), m_guid(0), m_race(0)
+{
+    std::transform(m_account.begin(), m_account.end(), m_account.begin(), ::toupper);
+}
+
+LoadClient::~LoadClient()
+{
+    Disconnect();
+}
+
+bool LoadClient::Start()
+{
+    m_startTime = ACE_OS::gettimeofday();
+    m_state = STATE_REALM_CHALLENGE;
+
+    if (!Connect(m_config.realmAddress))
+    {
+        Fail("can't connect to realmd");
+        return false;
+    }
+
+    ByteBuffer challenge(64);
+    challenge << uint8(REALM_CMD_LOGON_CHALLENGE);
+    challenge << uint8(0);
+    challenge << uint16(30 + m_account.length());           // size of the rest
+    challenge.append("WoW", 4);
+    challenge << uint8(1) << uint8(12) << uint8(1);         // version 1.12.1
+    challenge << uint16(m_config.build);
+    challenge.append("68x", 4);                             // platform, os and locale are reversed
+    challenge.append("niW", 4);
+    challenge.append("SUne", 4);
+    challenge << uint32(0);                                 // timezone bias
+    challenge << uint32(0);                                 // address, realmd uses the one of the socket
+    challenge << uint8(m_account.length());
+    challenge.append(m_account.c_str(), m_account.length());
+
+    // queued until the connect completes
+    SendRaw(challenge.contents(), challenge.size());
+    return !IsDone();
+}
+
+void LoadClient::Close()
+{
+    Disconnect();
+
+    if (!IsDone())
+    {
+        m_state = STATE_CLOSED;
+    }
+}
+
+void LoadClient::LoginCharacter()
+{
+    if (m_state != STATE_CHAR_SCREEN)
+    {
+        return;
+    }
+
+    ClientPacket login(CMSG_PLAYER_LOGIN, 8);
+    login << m_guid;
+
+    m_state = STATE_LOGIN;
+    SendPacket(login);
+}
+
+void LoadClient::SendPacket(ClientPacket const& packet)
+{
+    if (IsDone())
+    {
+        return;
+    }
+
+    // size is big-endian and counts the opcode, the opcode is a little-endian uint32
+    uint8 header[6];
+    uint16 size = uint16(packet.size() + 4);
+    uint32 opcode = packet.GetOpcode();
+    header[0] = uint8(size >> 8);
+    header[1] = uint8(size);
+    header[2] = uint8(opcode);
+    header[3] = uint8(opcode >> 8);
+    header[4] = uint8(opcode >> 16);
+    header[5] = uint8(opcode >> 24);
+
+    if (!m_key.empty())
+    {
+        EncryptHeader(header);
+    }
+
+    m_output.insert(m_output.end(), header, header + sizeof(header));
+    if (!packet.empty())
+    {
+        m_output.insert(m_output.end(), packet.contents(), packet.contents() + packet.size());
+    }
+
+    Flush();
+}
+
+void LoadClient::Fail(std::string const& error)
+{
+    Disconnect();
+
+    if (!IsDone())
+    {
+        m_error = error;
+        m_state = STATE_FAILED;
+    }
+}
+
+int LoadClient::handle_input(ACE_HANDLE)
+{
+    // a failed connect is reported as readable by some reactors
+    if (m_connecting && !CompleteConnect())
+    {
+        return 0;
+    }
+
+    bool realm = m_state == STATE_REALM_CHALLENGE || m_state == STATE_REALM_PROOF;
+
+    while (!IsDone())
+    {
+        size_t filled = m_input.size();
+        m_input.resize(filled + LOAD_CLIENT_RECV_SIZE);
+
+        ssize_t n = m_stream.recv(&m_input[filled], LOAD_CLIENT_RECV_SIZE);
+        if (n <= 0)
+        {
+            m_input.resize(filled);
+            if (n == -1 && (errno == EWOULDBLOCK || errno == EAGAIN))
+            {
+                break;
+            }
+
+            Fail(realm ? "connection closed by realmd" : "connection closed by mangosd");
+            break;
+        }
+
+        m_input.resize(filled + n);
+
+        if (!(realm ? ProcessRealm() : ProcessWorld()))
+        {
+            break;
+        }
+
+        // the realm login finished, the connection to mangosd has its own handler registration
+        if (realm && m_state != STATE_REALM_CHALLENGE && m_state != STATE_REALM_PROOF)
+        {
+            break;
+        }
+
+        m_input.erase(m_input.begin(), m_input.begin() + m_inputPos);
+        m_inputPos = 0;
+
+        if (size_t(n) < LOAD_CLIENT_RECV_SIZE)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+int LoadClient::handle_output(ACE_HANDLE)
+{
+    if (m_connecting && !CompleteConnect())
+    {
+        return 0;
+    }
+
+    Flush();
+    return 0;
+}
+
+int LoadClient::handle_timeout(ACE_Time_Value const& /*current_time*/, void const* /*act*/)
+{
+    m_connectTimer = -1;
+
+    if (m_connecting)
+    {
+        Fail(m_state == STATE_WORLD_CHALLENGE ? "connect to mangosd timed out" : "connect to realmd timed out");
+    }
+
+    return 0;
+}
+
+bool LoadClient::Connect(ACE_INET_Addr const& address)
+{
+    m_input.clear();
+    m_inputPos = 0;
+    m_output.clear();
+    m_outputPos = 0;
+    m_writing = false;
+    m_headerReady = false;
+
+    // a blocking connect would stall every other client of the reactor thread
+    ACE_SOCK_Connector connector;
+    if (connector.connect(m_stream, address, &ACE_Time_Value::zero) == -1)
+    {
+        if (errno != EWOULDBLOCK)
+        {
+            m_stream.close();
+            return false;
+        }
+
+        m_connecting = true;
+    }
+
+    // the socket gets writable once connected, the output waits until then
+    ACE_Reactor_Mask mask = ACE_Event_Handler::READ_MASK;
+    if (m_connecting)
+    {
+        mask |= ACE_Event_Handler::WRITE_MASK;
+        m_writing = true;
+    }
+
+    if (reactor()->register_handler(this, mask) == -1)
+    {
+        m_connecting = false;
+        m_writing = false;
+        m_stream.close();
+        return false;
+    }
+
+    if (m_connecting)
+    {
+        m_connectTimer = reactor()->schedule_timer(this, NULL, ACE_Time_Value(LOAD_CLIENT_CONNECT_TIMEOUT));
+        return true;
+    }
+
+    return CompleteConnect();
+}
+
+bool LoadClient::CompleteConnect()
+{
+    if (m_connecting)
+    {
+        m_connecting = false;
+
+        if (m_connectTimer != -1)
+        {
+            reactor()->cancel_timer(m_connectTimer);
+            m_connectTimer = -1;
+        }
+
+        // the result of the connect, the socket is left open for Fail() to unregister it
+        int error = 0;
+        int length = sizeof(error);
+        if (m_stream.get_option(SOL_SOCKET, SO_ERROR, &error, &length) == -1 || error != 0)
+        {
+            Fail(m_state == STATE_WORLD_CHALLENGE ? "can't connect to mangosd" : "can't connect to realmd");
+            return false;
+        }
+    }
+
+    m_stream.enable(ACE_NONBLOCK);
+
+    int nodelay = 1;
+    m_stream.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    // send what was queued meanwhile, this also drops the WRITE_MASK once all is written
+    return Flush();
+}
+
+void LoadClient::Disconnect()
+{
+    if (m_connectTimer != -1)
+    {
+        reactor()->cancel_timer(m_connectTimer);
+        m_connectTimer = -1;
+    }
+
+    m_connecting = false;
+
+    if (m_stream.get_handle() == ACE_INVALID_HANDLE)
+    {
+        return;
+    }
+
+    reactor()->remove_handler(this, ACE_Event_Handler::ALL_EVENTS_MASK | ACE_Event_Handler::DONT_CALL);
+    m_stream.close();
+}
+
+void LoadClient::SendRaw(uint8 const* data, size_t size)
+{
+    m_output.insert(m_output.end(), data, data + size);
+    Flush();
+}
+
+bool LoadClient::Flush()
+{
+    if (m_connecting)
+    {
+        return true;
+    }
+
+    while (m_outputPos < m_output.size())
+    {
+        ssize_t n = m_stream.send(&m_output[m_outputPos], m_output.size() - m_outputPos);
+        if (n <= 0)
+        {
+            if (n == -1 && (errno == EWOULDBLOCK || errno == EAGAIN))
+            {
+                if (!m_writing && reactor()->schedule_wakeup(this, ACE_Event_Handler::WRITE_MASK) != -1)
+                {
+                    m_writing = true;
+                }
+
+                return true;
+            }
+
+            Fail("connection lost while sending");
+            return false;
+        }
+
+        m_outputPos += n;
+    }
+
+    m_output.clear();
+    m_outputPos = 0;
+
+    if (m_writing)
+    {
+        reactor()->cancel_wakeup(this, ACE_Event_Handler::WRITE_MASK);
+        m_writing = false;
+    }
+
+    return true;
+}
+
+bool LoadClient::ProcessRealm()
+{
+    size_t available = m_input.size() - m_inputPos;
+    uint8 const* data = &m_input[m_inputPos];
+    char error[64];
+
+    if (m_state == STATE_REALM_CHALLENGE)
+    {
+        if (available < 3)
+        {
+            return true;
+        }
+
+        if (data[0] != REALM_CMD_LOGON_CHALLENGE || data[2] != 0)
+        {
+            snprintf(error, sizeof(error), "logon challenge refused by realmd, error %u", uint32(data[2]));
+            Fail(error);
+            return false;
+        }
+
+        return available < REALM_CHALLENGE_SIZE || HandleLogonChallenge();
+    }
+
+    if (available < 2)
+    {
+        return true;
+    }
+
+    if (data[0] != REALM_CMD_LOGON_PROOF || data[1] != 0)
+    {
+        snprintf(error, sizeof(error), "logon proof refused by realmd, error %u", uint32(data[1]));
+        Fail(error);
+        return false;
+    }
+
+    return available < REALM_PROOF_SIZE || HandleLogonProof();
+}
+
+bool LoadClient::HandleLogonChallenge()
+{
+    // cmd, unk, error, B[32], g length, g, N length, N[32], s[32], unk3[16], security flags
+    uint8 const* data = &m_input[m_inputPos];
+    uint8 const* B = data + 3;
+    uint8 gLength = data[35];
+    uint8 const* g = data + 36;
+    uint8 NLength = data[37];
+    uint8 const* N = data + 38;
+    uint8 const* salt = data + 70;
+    uint8 securityFlags = data[118];
+
+    if (gLength != 1 || NLength != 32)
+    {
+        Fail("unexpected logon challenge layout");
+        return false;
+    }
+
+    if (securityFlags)
+    {
+        Fail("account needs a PIN or matrix card");
+        return false;
+    }
+
+    if (!m_srp.Compute(m_account, m_config.password, B, g, gLength, N, NLength, salt))
+    {
+        Fail("invalid logon challenge");
+        return false;
+    }
+
+    m_inputPos += REALM_CHALLENGE_SIZE;
+
+    uint8 crcHash[20];
+    memset(crcHash, 0, sizeof(crcHash));
+
+    ByteBuffer proof(80);
+    proof << uint8(REALM_CMD_LOGON_PROOF);
+    proof.append(m_srp.GetA(), 32);
+    proof.append(m_srp.GetM1(), 20);
+    proof.append(crcHash, sizeof(crcHash));
+    proof << uint8(0);                                      // number of keys
+    proof << uint8(0);                                      // security flags
+
+    m_state = STATE_REALM_PROOF;
+    SendRaw(proof.contents(), proof.size());
+    return !IsDone();
+}
+
+bool LoadClient::HandleLogonProof()
+{
+    // cmd, error, M2[20], unk
+    if (!m_srp.CheckM2(&m_input[m_inputPos] + 2))
+    {
+        Fail("logon proof of realmd doesn't match");
+        return false;
+    }
+
+    m_inputPos += REALM_PROOF_SIZE;
+
+    // realmd stored the session key, the realm list isn't needed
+    Disconnect();
+
+    m_state = STATE_WORLD_CHALLENGE;
+
+    if (!Connect(m_config.worldAddress))
+    {
+        Fail("can't connect to mangosd");
+        return false;
+    }
+
+    return !IsDone();
+}
+
+bool LoadClient::ProcessWorld()
+{
+    while (!IsDone())
+    {
+        size_t available = m_input.size() - m_inputPos;
+        if (available < 4)
+        {
+            return true;
+        }
+
+        uint8* header = &m_input[m_inputPos];
+        if (!m_headerReady)
+        {
+            if (!m_key.empty())
+            {
+                DecryptHeader(header);
+            }
+
+            m_headerReady = true;
+        }
+
+        // size is big-endian and counts the opcode, the opcode is a little-endian uint16
+        uint16 size = uint16((header[0] << 8) | header[1]);
+        uint16 opcode = uint16(header[2] | (header[3] << 8));
+        if (size < 2)
+        {
+            Fail("invalid packet header from mangosd");
+            return false;
+        }
+
+        if (available < size_t(2 + size))
+        {
+            return true;
+        }
+
+        ClientPacket packet(opcode, size - 2);
+        if (size > 2)
+        {
+            packet.append(header + 4, size - 2);
+        }
+
+        m_inputPos += 2 + size;
+        m_headerReady = false;
+
+        try
+        {
+            if (!HandleWorldPacket(packet))
+            {
+                return false;
+            }
+        }
+        catch (ByteBufferException&)
+        {
+            char error[64];
+            snprintf(error, sizeof(error), "malformed packet 0x%.4X from mangosd", uint32(opcode));
+            Fail(error);
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool LoadClient::HandleWorldPacket(ClientPacket& packet)
+{
+    char error[64];
+
+    switch (packet.GetOpcode())
+    {
+        case SMSG_AUTH_CHALLENGE:
+        {
+            if (m_state != STATE_WORLD_CHALLENGE)
+            {
+                break;
+            }
+
+            uint32 serverSeed;
+            packet >> serverSeed;
+
+            uint32 clientSeed = rand32();
+            uint8 t[4] = { 0 };
+
+            Sha1Hash sha;
+            sha.UpdateData(m_account);
+            sha.UpdateData(t, 4);
+            sha.UpdateData((uint8*)&clientSeed, 4);
+            sha.UpdateData((uint8*)&serverSeed, 4);
+            sha.UpdateBigNumbers(&m_srp.GetSessionKey(), NULL);
+            sha.Finalize();
+
+            ClientPacket auth(CMSG_AUTH_SESSION, 64);
+            auth << uint32(m_config.build);
+            auth << uint32(0);
+            auth << m_account;
+            auth << clientSeed;
+            auth.append(sha.GetDigest(), SHA_DIGEST_LENGTH);
+            auth << uint32(0);                              // no addon data
+
+            m_state = STATE_WORLD_AUTH;
+            SendPacket(auth);
+
+            // mangosd encrypts the headers from its answer on and expects them encrypted
+            uint8 const* key = m_srp.GetSessionKey().AsByteArray(40);
+            m_key.assign(key, key + 40);
+            m_sendI = m_sendJ = m_recvI = m_recvJ = 0;
+            break;
+        }
+        case SMSG_AUTH_RESPONSE:
+        {
+            uint8 code;
+            packet >> code;
+
+            if (code == CLIENT_AUTH_WAIT_QUEUE)
+            {
+                break;
+            }
+
+            if (code != CLIENT_AUTH_OK)
+            {
+                snprintf(error, sizeof(error), "authentication refused by mangosd, code 0x%.2X", uint32(code));
+                Fail(error);
+                return false;
+            }
+
+            m_state = STATE_CHAR_ENUM;
+            SendPacket(ClientPacket(CMSG_CHAR_ENUM, 0));
+            break;
+        }
+        case SMSG_CHAR_ENUM:
+        {
+            if (m_state != STATE_CHAR_ENUM)
+            {
+                break;
+            }
+
+            uint8 count;
+            packet >> count;
+            if (!count)
+            {
+                Fail("account has no character");
+                return false;
+            }
+
+            std::string name;
+            packet >> m_guid >> name >> m_race;
+
+            m_state = STATE_CHAR_SCREEN;
+            OnCharacterScreen();
+            break;
+        }
+        case SMSG_CHARACTER_LOGIN_FAILED:
+        {
+            uint8 reason;
+            packet >> reason;
+
+            snprintf(error, sizeof(error), "character login failed, reason 0x%.2X", uint32(reason));
+            Fail(error);
+            return false;
+        }
+        case SMSG_LOGIN_VERIFY_WORLD:
+        {
+            uint32 mapId;
+            float x, y, z, o;
+            packet >> mapId >> x >> y >> z >> o;
+
+            if (m_loginTime == ACE_Time_Value::zero)
+            {
+                m_loginTime = ACE_OS::gettimeofday() - m_startTime;
+            }
+
+            m_state = STATE_IN_WORLD;
+            OnEnterWorld(mapId, x, y, z, o);
+            break;
+        }
+        case SMSG_LOGOUT_COMPLETE:
+            if (m_state == STATE_IN_WORLD)
+            {
+                m_state = STATE_CHAR_SCREEN;
+            }
+            break;
+        default:
+            break;
+    }
+
+    packet.rpos(0);
+    OnWorldPacket(packet);
+    return !IsDone();
+}
+
+/// Mirror of AuthCrypt::DecryptRecv, the client encrypts the 6 bytes of its headers
+void LoadClient::EncryptHeader(uint8* header)
+{
+    for (size_t t = 0; t < 6; ++t)
+    {
+        m_sendI %= m_key.size();
+        uint8 x = (header[t] ^ m_key[m_sendI]) + m_sendJ;
+        ++m_sendI;
+        header[t] = m_sendJ = x;
+    }
+}
+
+/// Mirror of AuthCrypt::EncryptSend, the server encrypts the 4 bytes of its headers
+void LoadClient::DecryptHeader(uint8* header)
+{
+    for (size_t t = 0; t < 4; ++t)
+    {
+        m_recvI %= m_key.size();
+        uint8 x = (header[t] - m_recvJ) ^ m_key[m_recvI];
+        ++m_recvI;
+        m_recvJ = header[t];
+        header[t] = x;
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_LOADCLIENT
+#define MANGOS_H_LOADCLIENT
+
+#include "Common.h"
+#include "ClientProtocol.h"
+#include "SRP6Client.h"
+
+#include <ace/Event_Handler.h>
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/Time_Value.h>
+
+#include <string>
+#include <vector>
+
+/// Settings shared by all clients of a load test
+struct LoadClientConfig
+{
+    LoadClientConfig() : password("LOADTEST"), build(LOAD_CLIENT_BUILD) {}
+
+    ACE_INET_Addr realmAddress;
+    ACE_INET_Addr worldAddress;
+    std::string password;                                   ///< of every account
+    uint16 build;
+};
+
+/**
+ * @brief One simulated game client, driven by the reactor of the load test.
+ *
+ * Logs in at realmd with SRP6 like the game client does, then connects to mangosd with the
+ * session key, authenticates and enters the world with the first character of its account.
+ * Subclasses add the behaviour through the On...() hooks and Update().
+ *
+ * The client is not reference counted, its owner deletes it after Close() or a failure.
+ */
+class LoadClient : public ACE_Event_Handler
+{
+    public:
+        enum State
+        {
+            STATE_IDLE,
+            STATE_REALM_CHALLENGE,                          ///< connecting to realmd, then logon challenge sent
+            STATE_REALM_PROOF,                              ///< logon proof sent to realmd
+            STATE_WORLD_CHALLENGE,                          ///< connecting to mangosd, then waiting for SMSG_AUTH_CHALLENGE
+            STATE_WORLD_AUTH,                               ///< CMSG_AUTH_SESSION sent, maybe in the login queue
+            STATE_CHAR_ENUM,                                ///< CMSG_CHAR_ENUM sent
+            STATE_CHAR_SCREEN,                              ///< character known, not in the world
+            STATE_LOGIN,                                    ///< CMSG_PLAYER_LOGIN sent
+            STATE_IN_WORLD,
+            STATE_CLOSED,
+            STATE_FAILED
+        };
+
+        LoadClient(ACE_Reactor* reactor, LoadClientConfig const& config, std::string const& account);
+        virtual ~LoadClient();
+
+        /// Starts connecting to realmd, the login goes on in the reactor
+        bool Start();
+        /// Closes the connection, the client ends in STATE_CLOSED
+        void Close();
+
+        State GetState() const { return m_state; }
+        bool IsDone() const { return m_state == STATE_CLOSED || m_state == STATE_FAILED; }
+        /// Why the client failed
+        std::string const& GetError() const { return m_error; }
+        std::string const& GetAccount() const { return m_account; }
+
+        /// Time from Start() to SMSG_LOGIN_VERIFY_WORLD, zero before
+        ACE_Time_Value const& GetLoginTime() const { return m_loginTime; }
+
+        uint64 GetCharacterGuid() const { return m_guid; }
+        uint8 GetCharacterRace() const { return m_race; }
+
+        /// Sends CMSG_PLAYER_LOGIN for the character, only in STATE_CHAR_SCREEN
+        void LoginCharacter();
+
+        /// Queues a world packet and writes as much as the socket takes
+        void SendPacket(ClientPacket const& packet);
+
+        /// Called by the owner regularly with the current time
+        virtual void Update(ACE_Time_Value const& /*now*/) {}
+
+    protected:
+        /// The character screen is reached, by default the character enters the world right away
+        virtual void OnCharacterScreen() { LoginCharacter(); }
+        /// SMSG_LOGIN_VERIFY_WORLD received, with the position of the character
+        virtual void OnEnterWorld(uint32 /*mapId*/, float /*x*/, float /*y*/, float /*z*/, float /*o*/) {}
+        /// Every world packet received in STATE_IN_WORLD and after
+        virtual void OnWorldPacket(ClientPacket& /*packet*/) {}
+
+        void Fail(std::string const& error);
+
+        int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE) override;
+        int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE) override;
+        int handle_timeout(ACE_Time_Value const& current_time, void const* act = 0) override;
+        ACE_HANDLE get_handle() const override { return m_stream.get_handle(); }
+
+    private:
+        /// Starts a non-blocking connect, the result is handled in the reactor by CompleteConnect()
+        bool Connect(ACE_INET_Addr const& address);
+        /// Called once the socket of a pending connect is ready, fails the client if the connect did
+        bool CompleteConnect();
+        void Disconnect();
+        void SendRaw(uint8 const* data, size_t size);
+        bool Flush();
+
+        /// Consumes the complete realmd answers at the front of m_input
+        bool ProcessRealm();
+        bool HandleLogonChallenge();
+        bool HandleLogonProof();
+
+        /// Consumes the complete world packets at the front of m_input
+        bool ProcessWorld();
+        bool HandleWorldPacket(ClientPacket& packet);
+
+        void EncryptHeader(uint8* header);
+        void DecryptHeader(uint8* header);
+
+        LoadClientConfig const& m_config;
+        std::string m_account;                              ///< upper case
+        State m_state;
+        std::string m_error;
+
+        ACE_SOCK_Stream m_stream;
+        bool m_connecting;                                  ///< connect in progress, output waits for it
+        long m_connectTimer;                                ///< reactor timer id of the connect timeout, -1 if none
+        std::vector<uint8> m_input;
+        size_t m_inputPos;                                  ///< parsed part of m_input
+        std::vector<uint8> m_output;
+        size_t m_outputPos;                                 ///< written part of m_output
+        bool m_writing;                                     ///< registered for WRITE_MASK
+
+        SRP6Client m_srp;
+
+        std::vector<uint8> m_key;                           ///< header encryption, set after CMSG_AUTH_SESSION
+        uint8 m_sendI, m_sendJ, m_recvI, m_recvJ;
+        bool m_headerReady;                                 ///< the header at m_inputPos is decrypted already
+
+        uint64 m_guid;
+        uint8 m_race;
+        ACE_Time_Value m_startTime;
+        ACE_Time_Value m_loginTime;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "LoadTest.h"
+
+#include <ace/ACE.h>
+#include <ace/Reactor.h>
+#include <ace/Select_Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+#include <ace/OS_NS_signal.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+ACE_Reactor* CreateLoadTestReactor()
+{
+#ifndef WIN32
+    // a server closing a connection must not kill the whole test
+    ACE_OS::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    ACE_Reactor_Impl* imp = 0;
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    imp = new ACE_Dev_Poll_Reactor(ACE::max_handles());
+#else
+    imp = new ACE_Select_Reactor();
+#endif
+    return new ACE_Reactor(imp, 1);
+}
+
+bool ParseLoadTestAddress(char const* text, uint16 defaultPort, ACE_INET_Addr& address)
+{
+    std::string host = text;
+    uint16 port = defaultPort;
+
+    std::string::size_type colon = host.rfind(':');
+    if (colon != std::string::npos)
+    {
+        port = uint16(atoi(host.c_str() + colon + 1));
+        host.resize(colon);
+    }
+
+    return port && address.set(port, host.c_str()) == 0;
+}
+
+uint32 LoadTestPercentile(std::vector<uint32>& values, uint32 percent)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+    size_t index = std::min(values.size() * percent / 100, values.size() - 1);
+    return values[index];
+}
@@ -0,0 +1,45 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_LOADTEST
+#define MANGOS_H_LOADTEST
+
+#include "Common.h"
+
+#include <ace/INET_Addr.h>
+
+#include <vector>
+
+class ACE_Reactor;
+
+/// Reactor for the clients of a load test, epoll based where ACE supports it
+ACE_Reactor* CreateLoadTestReactor();
+
+/// Parses "host:port", the port defaults to defaultPort
+bool ParseLoadTestAddress(char const* text, uint16 defaultPort, ACE_INET_Addr& address);
+
+/// Percentile of the values, which are sorted by the call; 0 when there are none
+uint32 LoadTestPercentile(std::vector<uint32>& values, uint32 percent);
+
+#endif
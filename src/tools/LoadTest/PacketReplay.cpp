@@ -0,0 +1,433 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/**
+ * packet-replay: plays a packet capture of mangosd (Network.CaptureFile, .server capture)
+ * back into a server over loopback, to reproduce production load in a test realm.
+ *
+ * Every captured session is played by a client logged in with a replay account of its own,
+ * ACCOUNT1 .. ACCOUNTn sharing one password, each with at least one character. The client
+ * enters the world with its first character and sends the captured packets at the captured
+ * times, or faster. Packets of the character screen that change characters are left out.
+ */
+
+#include "LoadTest.h"
+#include "LoadClient.h"
+#include "CaptureReader.h"
+#include "TickReport.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Reactor.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <set>
+
+/// Time the sessions still open at the end of the capture are kept open, to let the server catch up
+#define REPLAY_DRAIN_TIME 5
+
+/// Client playing one captured session
+class ReplayClient : public LoadClient
+{
+    public:
+        ReplayClient(ACE_Reactor* reactor, LoadClientConfig const& config, std::string const& account, uint32 accountIndex) :
+            LoadClient(reactor, config, account), m_accountIndex(accountIndex), m_sent(0), m_skipped(0)
+        {
+        }
+
+        uint32 GetAccountIndex() const { return m_accountIndex; }
+        uint32 GetSent() const { return m_sent; }
+        uint32 GetSkipped() const { return m_skipped; }
+        /// Packets never sent, the character was not in the world
+        uint32 GetUnsent() const { return uint32(m_pending.size()); }
+
+        /// Sends a captured packet, or keeps it until the character is in the world
+        void Replay(CaptureRecord const& record)
+        {
+            switch (record.opcode)
+            {
+                // the characters of the replay accounts stay as they are
+                case CMSG_CHAR_ENUM:
+                case CMSG_CHAR_CREATE:
+                case CMSG_CHAR_DELETE:
+                case CMSG_CHAR_RENAME:
+                    ++m_skipped;
+                    return;
+                // the first login is made by the client itself, later ones follow a logout of the capture
+                case CMSG_PLAYER_LOGIN:
+                    if (GetState() == STATE_CHAR_SCREEN && GetLoginTime() != ACE_Time_Value::zero)
+                    {
+                        LoginCharacter();
+                    }
+                    else
+                    {
+                        ++m_skipped;
+                    }
+                    return;
+                default:
+                    break;
+            }
+
+            ClientPacket packet(record.opcode, record.payload.size());
+            if (!record.payload.empty())
+            {
+                packet.append(&record.payload[0], record.payload.size());
+            }
+
+            if (GetState() == STATE_IN_WORLD)
+            {
+                SendPacket(packet);
+                ++m_sent;
+            }
+            else if (!IsDone())
+            {
+                m_pending.push_back(packet);
+            }
+        }
+
+    protected:
+        void OnEnterWorld(uint32 /*mapId*/, float /*x*/, float /*y*/, float /*z*/, float /*o*/) override
+        {
+            while (!m_pending.empty() && GetState() == STATE_IN_WORLD)
+            {
+                SendPacket(m_pending.front());
+                m_pending.pop_front();
+                ++m_sent;
+            }
+        }
+
+    private:
+        uint32 m_accountIndex;
+        uint32 m_sent;
+        uint32 m_skipped;
+        std::deque<ClientPacket> m_pending;
+};
+
+/// Plays a capture back and collects the results
+class PacketReplay
+{
+    public:
+        PacketReplay(LoadClientConfig const& config, std::string const& accountPrefix, uint32 accountCount, double speed) :
+            m_config(config), m_accountPrefix(accountPrefix), m_speed(speed), m_reactor(CreateLoadTestReactor()),
+            m_capturedSessions(0), m_noAccount(0), m_started(0), m_failed(0), m_sent(0), m_skipped(0), m_unsent(0), m_orphans(0),
+            m_maxLag(0)
+        {
+            for (uint32 i = accountCount; i > 0; --i)
+            {
+                m_freeAccounts.push_back(i);
+            }
+        }
+
+        ~PacketReplay()
+        {
+            for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+            {
+                delete itr->second;
+            }
+
+            delete m_reactor;
+        }
+
+        void Run(CaptureReader& reader)
+        {
+            ACE_Time_Value start = ACE_OS::gettimeofday();
+            ACE_Time_Value drainEnd = ACE_Time_Value::zero;
+
+            CaptureRecord record;
+            bool more = reader.Next(record);
+
+            while (more || !m_sessions.empty())
+            {
+                ACE_Time_Value now = ACE_OS::gettimeofday();
+                uint64 captureNow = uint64((now - start).msec() * m_speed);
+
+                while (more && record.time <= captureNow)
+                {
+                    m_maxLag = std::max(m_maxLag, uint32((captureNow - record.time) / m_speed));
+                    Dispatch(record);
+                    more = reader.Next(record);
+                }
+
+                if (!more)
+                {
+                    if (drainEnd == ACE_Time_Value::zero)
+                    {
+                        drainEnd = now + ACE_Time_Value(REPLAY_DRAIN_TIME);
+                    }
+                    else if (now >= drainEnd)
+                    {
+                        for (SessionMap::const_iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+                        {
+                            itr->second->Close();
+                        }
+                    }
+                }
+
+                ACE_Time_Value wait(0, 1000);
+                m_reactor->handle_events(wait);
+
+                Reap();
+            }
+
+            m_duration = ACE_OS::gettimeofday() - start;
+        }
+
+        void Print() const
+        {
+            printf("Replayed %u captured sessions in %.1f s at %.2fx:\n", m_capturedSessions, m_duration.msec() / 1000.0, m_speed);
+            printf("  clients started %u, entered the world %u, failed %u, without a free account %u\n", m_started,
+                   uint32(m_loginTimes.size()), m_failed, m_noAccount);
+
+            std::vector<uint32> loginTimes = m_loginTimes;
+            printf("  login time p50 %u ms, p95 %u ms, max %u ms\n", LoadTestPercentile(loginTimes, 50),
+                   LoadTestPercentile(loginTimes, 95), LoadTestPercentile(loginTimes, 100));
+            printf("  packets sent %u, left out %u, not sent %u, of sessions without a client %u\n", m_sent, m_skipped,
+                   m_unsent, m_orphans);
+            printf("  behind the capture schedule by %u ms at most\n", m_maxLag);
+
+            for (std::map<std::string, uint32>::const_iterator itr = m_failures.begin(); itr != m_failures.end(); ++itr)
+            {
+                printf("  %u failed: %s\n", itr->second, itr->first.c_str());
+            }
+        }
+
+    private:
+        typedef std::map<uint32, ReplayClient*> SessionMap;
+
+        void Dispatch(CaptureRecord const& record)
+        {
+            SessionMap::iterator itr = m_sessions.find(record.session);
+
+            if (record.type == PACKET_CAPTURE_SESSION_CLOSE)
+            {
+                if (itr != m_sessions.end())
+                {
+                    itr->second->Close();
+                }
+                return;
+            }
+
+            // sessions that were open when the capture started have no open record
+            if (itr == m_sessions.end())
+            {
+                if (m_endedSessions.find(record.session) != m_endedSessions.end() || !StartSession(record.session))
+                {
+                    ++m_orphans;
+                    return;
+                }
+
+                itr = m_sessions.find(record.session);
+            }
+
+            if (record.type == PACKET_CAPTURE_PACKET)
+            {
+                itr->second->Replay(record);
+            }
+        }
+
+        bool StartSession(uint32 session)
+        {
+            ++m_capturedSessions;
+            m_endedSessions.insert(session);
+
+            if (m_freeAccounts.empty())
+            {
+                ++m_noAccount;
+                return false;
+            }
+
+            uint32 accountIndex = m_freeAccounts.back();
+            m_freeAccounts.pop_back();
+
+            char account[64];
+            snprintf(account, sizeof(account), "%s%u", m_accountPrefix.c_str(), accountIndex);
+
+            ReplayClient* client = new ReplayClient(m_reactor, m_config, account, accountIndex);
+            m_sessions[session] = client;
+            ++m_started;
+
+            client->Start();
+            return true;
+        }
+
+        /// Collects the results of the finished clients and frees their accounts
+        void Reap()
+        {
+            for (SessionMap::iterator itr = m_sessions.begin(); itr != m_sessions.end();)
+            {
+                ReplayClient* client = itr->second;
+                if (!client->IsDone())
+                {
+                    ++itr;
+                    continue;
+                }
+
+                if (client->GetLoginTime() != ACE_Time_Value::zero)
+                {
+                    m_loginTimes.push_back(uint32(client->GetLoginTime().msec()));
+                }
+
+                if (client->GetState() == LoadClient::STATE_FAILED)
+                {
+                    ++m_failures[client->GetError()];
+                    ++m_failed;
+                }
+
+                m_sent += client->GetSent();
+                m_skipped += client->GetSkipped();
+                m_unsent += client->GetUnsent();
+
+                m_freeAccounts.push_back(client->GetAccountIndex());
+                delete client;
+                m_sessions.erase(itr++);
+            }
+        }
+
+        LoadClientConfig const& m_config;
+        std::string m_accountPrefix;
+        double m_speed;
+        ACE_Reactor* m_reactor;
+
+        SessionMap m_sessions;
+        std::set<uint32> m_endedSessions;                   // sessions seen, later records without a client are not replayed
+        std::vector<uint32> m_freeAccounts;
+
+        uint32 m_capturedSessions;
+        uint32 m_noAccount;
+        uint32 m_started;
+        uint32 m_failed;
+        uint32 m_sent;
+        uint32 m_skipped;
+        uint32 m_unsent;
+        uint32 m_orphans;
+        uint32 m_maxLag;                                    // ms
+        std::vector<uint32> m_loginTimes;                   // ms
+        std::map<std::string, uint32> m_failures;
+        ACE_Time_Value m_duration;
+};
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    printf("Usage: \n %s [<options>] <capture file>\n"
+           "    -r <host[:port]>  realmd address, default 127.0.0.1:3724\n"
+           "    -w <host[:port]>  mangosd address, default 127.0.0.1:8085\n"
+           "    -a <prefix>       replay accounts are <prefix>1 .. <prefix>n, default REPLAY\n"
+           "    -n <count>        number of replay accounts, the sessions played at the same time at most, default 100\n"
+           "    -p <password>     password of the replay accounts, default LOADTEST\n"
+           "    -s <speed>        replay speed, 2 plays the capture in half the time, default 1\n"
+           "    -b <build>        client build, default %u\n"
+           "    -t <file>         PerfProfiler.CsvFile of the server, for the tick time report\n",
+           prog, uint32(LOAD_CLIENT_BUILD));
+}
+
+int main(int argc, char** argv)
+{
+    LoadClientConfig config;
+    ParseLoadTestAddress("127.0.0.1", 3724, config.realmAddress);
+    ParseLoadTestAddress("127.0.0.1", 8085, config.worldAddress);
+
+    std::string accountPrefix = "REPLAY";
+    uint32 accountCount = 100;
+    double speed = 1.0;
+    std::string tickFile;
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":r:w:a:n:p:s:b:t:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'r':
+                if (!ParseLoadTestAddress(cmd_opts.opt_arg(), 3724, config.realmAddress))
+                {
+                    printf("Invalid realmd address %s\n", cmd_opts.opt_arg());
+                    return 1;
+                }
+                break;
+            case 'w':
+                if (!ParseLoadTestAddress(cmd_opts.opt_arg(), 8085, config.worldAddress))
+                {
+                    printf("Invalid mangosd address %s\n", cmd_opts.opt_arg());
+                    return 1;
+                }
+                break;
+            case 'a':
+                accountPrefix = cmd_opts.opt_arg();
+                break;
+            case 'n':
+                accountCount = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'p':
+                config.password = cmd_opts.opt_arg();
+                break;
+            case 's':
+                speed = atof(cmd_opts.opt_arg());
+                break;
+            case 'b':
+                config.build = uint16(atoi(cmd_opts.opt_arg()));
+                break;
+            case 't':
+                tickFile = cmd_opts.opt_arg();
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (cmd_opts.opt_ind() != argc - 1 || speed <= 0.0 || !accountCount)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    CaptureReader reader;
+    if (!reader.Open(argv[cmd_opts.opt_ind()]))
+    {
+        return 1;
+    }
+
+    uint64 startTime = uint64(time(NULL));
+
+    PacketReplay replay(config, accountPrefix, accountCount, speed);
+    replay.Run(reader);
+    replay.Print();
+
+    if (!tickFile.empty())
+    {
+        TickReport ticks;
+        if (ticks.Load(tickFile, startTime, uint64(time(NULL))))
+        {
+            ticks.Print();
+        }
+    }
+
+    return 0;
+}
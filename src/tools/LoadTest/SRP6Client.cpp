@@ -0,0 +1,174 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "SRP6Client.h"
+#include "Auth/Sha1.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool SRP6Client::Compute(std::string const& account, std::string const& password, uint8 const* B, uint8 const* g, uint8 gLength,
+                         uint8 const* N, uint8 NLength, uint8 const* salt)
+{
+    BigNumber bigB, bigG, bigN, s;
+    bigB.SetBinary(B, 32);
+    bigG.SetBinary(g, gLength);
+    bigN.SetBinary(N, NLength);
+    s.SetBinary(salt, 32);
+
+    if (bigN.isZero() || (bigB % bigN).isZero())
+    {
+        return false;
+    }
+
+    // x = H(s, H(ACCOUNT:PASSWORD)), the verifier realmd keeps is g^x
+    std::string upperAccount = account;
+    std::string upperPassword = password;
+    std::transform(upperAccount.begin(), upperAccount.end(), upperAccount.begin(), ::toupper);
+    std::transform(upperPassword.begin(), upperPassword.end(), upperPassword.begin(), ::toupper);
+
+    Sha1Hash sha;
+    sha.UpdateData(upperAccount);
+    sha.UpdateData(":");
+    sha.UpdateData(upperPassword);
+    sha.Finalize();
+
+    uint8 credentials[SHA_DIGEST_LENGTH];
+    memcpy(credentials, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(credentials, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    // A = g^a, u = H(A, B), S = (B - 3 * g^x)^(a + u * x)
+    // BigNumber pads short numbers at the wrong end, so a is drawn again until A and K use all their bytes
+    BigNumber kv = (bigG.ModExp(x, bigN) * 3) % bigN;
+    BigNumber a;
+    do
+    {
+        a.SetRand(19 * 8);
+        m_A = bigG.ModExp(a, bigN);
+        if (m_A.GetNumBytes() < 32)
+        {
+            continue;
+        }
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&m_A, &bigB, NULL);
+        sha.Finalize();
+
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+
+        BigNumber S = ((bigB + bigN) - kv).ModExp(a + u * x, bigN);
+
+        // K interleaves the hashes of the even and the odd bytes of S
+        uint8 t[32];
+        uint8 t1[16];
+        uint8 vK[40];
+        memcpy(t, S.AsByteArray(32), 32);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            t1[i] = t[i * 2];
+        }
+
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            vK[i * 2] = sha.GetDigest()[i];
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            t1[i] = t[i * 2 + 1];
+        }
+
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            vK[i * 2 + 1] = sha.GetDigest()[i];
+        }
+
+        m_K.SetBinary(vK, 40);
+    }
+    while (m_A.GetNumBytes() < 32 || m_K.GetNumBytes() < 40);
+
+    // M1 = H(H(N) xor H(g), H(ACCOUNT), s, A, B, K)
+    uint8 hash[20];
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&bigN, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&bigG, NULL);
+    sha.Finalize();
+
+    for (int i = 0; i < 20; ++i)
+    {
+        hash[i] ^= sha.GetDigest()[i];
+    }
+
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(upperAccount);
+    sha.Finalize();
+
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &m_A, &bigB, &m_K, NULL);
+    sha.Finalize();
+
+    memcpy(m_M1, sha.GetDigest(), 20);
+    m_M.SetBinary(m_M1, 20);
+    return true;
+}
+
+bool SRP6Client::CheckM2(uint8 const* M2)
+{
+    // M2 = H(A, M1, K)
+    Sha1Hash sha;
+    sha.UpdateBigNumbers(&m_A, &m_M, &m_K, NULL);
+    sha.Finalize();
+
+    return memcmp(sha.GetDigest(), M2, 20) == 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_SRP6CLIENT
+#define MANGOS_H_SRP6CLIENT
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+
+#include <string>
+
+/**
+ * @brief Client side of the SRP6 exchange of the realmd logon, the mirror of AuthSocket.
+ *
+ * The numbers are hashed the way realmd hashes them, through BigNumber, so the proofs match
+ * also when a number has leading zero bytes.
+ */
+class SRP6Client
+{
+    public:
+        /// Derives A, M1 and the session key from the logon challenge of realmd.
+        /// @param B, N, salt 32 bytes each, little-endian as sent by realmd
+        /// @return false when the challenge can't be answered
+        bool Compute(std::string const& account, std::string const& password, uint8 const* B, uint8 const* g, uint8 gLength,
+                     uint8 const* N, uint8 NLength, uint8 const* salt);
+
+        /// Ephemeral public key, 32 bytes
+        uint8 const* GetA() { return m_A.AsByteArray(32); }
+        /// Client proof, 20 bytes
+        uint8 const* GetM1() const { return m_M1; }
+        /// Checks the server proof of the logon proof answer, 20 bytes
+        bool CheckM2(uint8 const* M2);
+
+        /// Session key stored by realmd for the world server
+        BigNumber& GetSessionKey() { return m_K; }
+
+    private:
+        BigNumber m_A;
+        BigNumber m_M;
+        BigNumber m_K;
+        uint8 m_M1[20];
+};
+
+#endif
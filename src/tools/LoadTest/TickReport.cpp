@@ -0,0 +1,100 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#include "TickReport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+bool TickReport::Load(std::string const& fileName, uint64 from, uint64 to)
+{
+    m_rows.clear();
+
+    FILE* file = fopen(fileName.c_str(), "r");
+    if (!file)
+    {
+        printf("Can't open the tick profiler file %s.\n", fileName.c_str());
+        return false;
+    }
+
+    // time,map,instance,phase,count,p50,p95,p99,max
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned long long time;
+        char map[64];
+        char phase[64];
+        unsigned int instance;
+        Row row;
+
+        if (sscanf(line, "%llu,%63[^,],%u,%63[^,],%u,%u,%u,%u,%u", &time, map, &instance, phase, &row.count, &row.p50,
+                   &row.p95, &row.p99, &row.max) != 9)
+        {
+            continue;
+        }
+
+        if (time < from || time > to || strcmp(map, "world") != 0 || strcmp(phase, "total") != 0)
+        {
+            continue;
+        }
+
+        row.time = time;
+        m_rows.push_back(row);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/// Median and maximum of one column of the rows
+static void PrintTickColumn(char const* name, std::vector<uint32> values)
+{
+    std::sort(values.begin(), values.end());
+    printf("  %-4s median %7u us, worst %7u us\n", name, values[values.size() / 2], values.back());
+}
+
+void TickReport::Print() const
+{
+    if (m_rows.empty())
+    {
+        printf("No tick times were written by the server during the test, is PerfProfiler.CsvInterval set?\n");
+        return;
+    }
+
+    std::vector<uint32> p50, p95, p99, max;
+    for (std::vector<Row>::const_iterator itr = m_rows.begin(); itr != m_rows.end(); ++itr)
+    {
+        p50.push_back(itr->p50);
+        p95.push_back(itr->p95);
+        p99.push_back(itr->p99);
+        max.push_back(itr->max);
+    }
+
+    printf("World tick times of %u profiler samples:\n", uint32(m_rows.size()));
+    PrintTickColumn("p50", p50);
+    PrintTickColumn("p95", p95);
+    PrintTickColumn("p99", p99);
+    PrintTickColumn("max", max);
+}
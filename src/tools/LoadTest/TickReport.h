@@ -0,0 +1,63 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+#ifndef MANGOS_H_TICKREPORT
+#define MANGOS_H_TICKREPORT
+
+#include "Common.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief World tick times of mangosd during a load test.
+ *
+ * Read from the CSV file the tick profiler of the server writes (PerfProfiler.Enable,
+ * PerfProfiler.CsvFile), the load tests run next to the server over loopback.
+ * Every row holds the percentiles of the rolling profiler window at the time it was written.
+ */
+class TickReport
+{
+    public:
+        /// Reads the rows of World::Update written between from and to, unix times
+        bool Load(std::string const& fileName, uint64 from, uint64 to);
+
+        /// Prints the median and the worst of the rows for every percentile
+        void Print() const;
+
+    private:
+        struct Row
+        {
+            uint64 time;
+            uint32 count;
+            uint32 p50;
+            uint32 p95;
+            uint32 p99;
+            uint32 max;
+        };
+
+        std::vector<Row> m_rows;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * MaNGOS is a full featured server for World of Warcraft, supporting
+ * the following clients: 1.12.x, 2.4.3, 3.3.5a, 4.3.4a and 5.4.8
+ *
+ * Copyright (C) 2005-2025 MaNGOS <https://www.getmangos.eu>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * World of Warcraft, and all World of Warcraft or Warcraft art, images,
+ * and lore are copyrighted by Blizzard Entertainment, Inc.
+ */
+
+/**
+ * queue-bench: compares the lock-free MPSCQueue with the mutex based LockedQueue it replaced
+ * for the incoming packets of a session, with many producer threads and one consumer.
+ *
+ * Every producer adds its share of the items as fast as it can while the consumer takes them
+ * out. Reported are the items per second through the queue until the consumer has taken the
+ * last one, and the average time a producer spent in add(), which is what the network threads
+ * pay for every packet they queue.
+ */
+
+#include "Common.h"
+#include "LockedQueue/LockedQueue.h"
+#include "LockedQueue/MPSCQueue.h"
+
+#include <ace/Get_Opt.h>
+#include <ace/Thread_Mutex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock BenchClock;
+
+/// Result of one run
+struct QueueBenchResult
+{
+    double itemsPerSec;                                     ///< through the queue, add to take
+    double addNanos;                                        ///< average time of one add()
+};
+
+/// Run producers threads adding items items each against one consumer taking them from queue
+template<class Queue>
+static QueueBenchResult RunQueueBench(uint32 producers, uint32 items)
+{
+    Queue queue;
+    std::atomic<bool> start(false);
+    std::atomic<uint64> addNanos(0);
+
+    std::vector<std::thread> threads;
+    for (uint32 i = 0; i < producers; ++i)
+    {
+        threads.push_back(std::thread([&queue, &start, &addNanos, items]()
+        {
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            BenchClock::time_point begin = BenchClock::now();
+            for (uint32 n = 1; n <= items; ++n)
+            {
+                queue.add(n);
+            }
+
+            addNanos += uint64(std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - begin).count());
+        }));
+    }
+
+    uint64 total = uint64(producers) * items;
+    uint64 taken = 0;
+    uint32 item;
+
+    BenchClock::time_point begin = BenchClock::now();
+    start.store(true, std::memory_order_release);
+
+    while (taken < total)
+    {
+        if (queue.next(item))
+        {
+            ++taken;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(BenchClock::now() - begin).count();
+
+    for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+    {
+        itr->join();
+    }
+
+    QueueBenchResult result;
+    result.itemsPerSec = seconds > 0.0 ? total / seconds : 0.0;
+    result.addNanos = double(addNanos.load()) / total;
+    return result;
+}
+
+/// Print out the usage string for this program on the console.
+static void usage(char const* prog)
+{
+    printf("Usage: \n %s [<options>]\n"
+           "    -p <count>        largest number of producer threads, runs go 1, 2, 4 .. up to it, default 8\n"
+           "    -n <count>        items added by every producer, default 1000000\n"
+           "    -r <count>        runs per queue and producer count, the best one is reported, default 3\n",
+           prog);
+}
+
+int main(int argc, char** argv)
+{
+    uint32 maxProducers = 8;
+    uint32 items = 1000000;
+    uint32 runs = 3;
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":p:n:r:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'p':
+                maxProducers = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'n':
+                items = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            case 'r':
+                runs = uint32(atoi(cmd_opts.opt_arg()));
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (cmd_opts.opt_ind() != argc || !maxProducers || !items || !runs)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%9s  %14s %12s  %14s %12s\n", "producers", "Locked items/s", "add ns", "MPSC items/s", "add ns");
+
+    for (uint32 producers = 1;; producers = std::min(producers * 2, maxProducers))
+    {
+        QueueBenchResult locked = { 0.0, 0.0 };
+        QueueBenchResult mpsc = { 0.0, 0.0 };
+
+        // alternate the queues, so neither gets all the warm caches
+        for (uint32 run = 0; run < runs; ++run)
+        {
+            QueueBenchResult result = RunQueueBench<ACE_Based::LockedQueue<uint32, ACE_Thread_Mutex> >(producers, items);
+            if (result.itemsPerSec > locked.itemsPerSec)
+            {
+                locked = result;
+            }
+
+            result = RunQueueBench<ACE_Based::MPSCQueue<uint32> >(producers, items);
+            if (result.itemsPerSec > mpsc.itemsPerSec)
+            {
+                mpsc = result;
+            }
+        }
+
+        printf("%9u  %14.0f %12.1f  %14.0f %12.1f\n", producers, locked.itemsPerSec, locked.addNanos, mpsc.itemsPerSec, mpsc.addNanos);
+
+        if (producers == maxProducers)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}